@@ -0,0 +1,67 @@
+#ifndef FLOAT_CHARS_H
+#define FLOAT_CHARS_H
+
+#include <charconv>     // for std::from_chars_result, std::to_chars_result
+#include <type_traits>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// Round-trip formatting and fast parsing of float/double.
+// * toChars() writes a digit string that reads back to the same bits (Grisu2). It is the shortest
+//   one for ~99.9% of the inputs, otherwise one digit longer.
+// * fromChars() parses a decimal string with the Eisel-Lemire algorithm and only falls back to
+//   std::from_chars for the rare inputs it cannot decide (more than 19 digits, halfway cases,
+//   subnormals). Without floating point std::from_chars in the standard library, the fallback is
+//   std::strtod/std::strtof on an allocated copy of the number.
+// Both follow the std::to_chars/std::from_chars conventions: no locale, no stream state, and no
+// allocation (except in that last fallback).
+namespace FloatChars
+{
+    // A buffer of this size always fits the output of toChars(): "-1.2345678901234567e-308"
+    inline constexpr int maxChars{ 32 };
+
+    // Writes a round-trip representation of value into [first, last) (the shortest one for ~99.9% of values).
+    // On success returns { end of output, std::errc{} }.
+    // If the buffer is too small, returns { last, std::errc::value_too_large }.
+    std::to_chars_result toChars(char* first, char* last, double value);
+    std::to_chars_result toChars(char* first, char* last, float value);
+
+    // Parses [first, last) as a decimal floating point number: [-]digits[.digits][(e|E)[+|-]digits],
+    // "inf", "infinity" or "nan" (case insensitive). A leading '+' or whitespace is not accepted,
+    // just like std::from_chars.
+    // On success returns { end of the number, std::errc{} } and writes value.
+    // Returns std::errc::invalid_argument if no number could be parsed (value is left untouched),
+    // and std::errc::result_out_of_range if the number overflows (value is set to +-inf).
+    std::from_chars_result fromChars(const char* first, const char* last, double& value);
+    std::from_chars_result fromChars(const char* first, const char* last, float& value);
+
+    std::string toString(double value);
+    std::string toString(float value);
+
+    // Stream replacement for std::setprecision(17):
+    //   std::cout << FloatChars::shortest(0.1) << '\n'; // prints 0.1, not 0.10000000000000001
+    template <typename T>
+    struct Shortest
+    {
+        T value{};
+    };
+
+    template <typename T>
+    Shortest<T> shortest(T value)
+    {
+        static_assert(std::is_same_v<T, double> || std::is_same_v<T, float>);
+        return Shortest<T>{ value };
+    }
+
+    template <typename T>
+    std::ostream& operator<<(std::ostream& out, Shortest<T> s)
+    {
+        char buffer[maxChars];
+        auto [end, ec]{ toChars(buffer, buffer + maxChars, s.value) };
+        // bypass the locale and the formatting flags: write the characters directly
+        return out.write(buffer, end - buffer);
+    }
+}
+
+#endif
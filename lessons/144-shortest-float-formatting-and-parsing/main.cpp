@@ -0,0 +1,282 @@
+/* Printing and reading floating point numbers
+
+- lessons/015-floating-point-numbers uses std::setprecision(17) to see "all" the digits of a double:
+    std::cout << std::setprecision(17) << 0.1; // 0.10000000000000001
+  17 significant digits are always enough to read the same double back, but most of them are noise.
+- What we usually want is the *shortest* string that reads back to the same bits:
+    0.1 -> "0.1", 1.0/3 -> "0.3333333333333333", 5e-324 -> "5e-324"
+- Going through iostreams for that is slow: locale lookups, stream state, virtual calls per character.
+  std::to_chars/std::from_chars (C++17) are the fast standard answer, but floating point support came late
+  in some standard libraries, and it is worth seeing how they work.
+
+This lesson implements both directions (see FloatChars.h):
+- toChars(): Grisu2 (Loitsch, 2010). Only 64-bit integer arithmetic and a table of 79 cached powers of ten.
+  Always round-trips; the shortest string for ~99.9% of the values, one digit longer for the rest.
+- fromChars(): Eisel-Lemire (Lemire, 2021). One or two 64x64->128-bit multiplications per number,
+  with std::from_chars (or std::strtod) as a fallback for the <1% of inputs that need more precision.
+*/
+
+#include "FloatChars.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>   // for std::snprintf
+#include <cstdlib>  // for std::strtod
+#include <cstring>  // for std::memcpy
+#include <iomanip>  // for std::setprecision
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+void printExamples()
+{
+    const double values[]{ 0.1, 0.1 + 0.2, 1.0 / 3, 100.0, 1e21, 123456789012345680.0, 5e-324, 1.7976931348623157e308, -0.0 };
+
+    for (double d : values)
+        std::cout << std::setprecision(17) << d << "  vs  " << FloatChars::shortest(d) << '\n';
+
+    std::cout << FloatChars::shortest(3.33333333333333333f) << '\n'; // 3.3333333, not 3.3333332538604736
+}
+
+
+/* Verifying round trips
+
+- Bit-exact: parse(format(x)) must have the same bits as x, not just compare equal (think of -0.0 and 0.0).
+- Random bit patterns cover all exponents uniformly, including subnormals; edge cases cover the
+  boundaries that are easiest to get wrong (powers of two, min/max values, rounding carries).
+- fromChars() is also compared against strtod on random decimal strings, including long and halfway ones.
+*/
+
+template <typename T, typename Bits>
+bool roundTrips(T value)
+{
+    char buffer[FloatChars::maxChars];
+    auto [end, ec]{ FloatChars::toChars(buffer, buffer + FloatChars::maxChars, value) };
+
+    T parsed{};
+    auto [ptr, parseEc]{ FloatChars::fromChars(buffer, end, parsed) };
+
+    Bits expected{};
+    Bits actual{};
+    std::memcpy(&expected, &value, sizeof(T));
+    std::memcpy(&actual, &parsed, sizeof(T));
+
+    if (ec != std::errc{} || parseEc != std::errc{} || ptr != end || expected != actual)
+    {
+        std::cout << "round trip failed: " << std::string(buffer, end) << '\n';
+        return false;
+    }
+    return true;
+}
+
+// Length of the shortest "%.*g" that reads back to value (what a perfect shortest algorithm produces)
+int shortestLength(double value)
+{
+    char buffer[64];
+    for (int precision{ 1 }; precision <= 17; ++precision)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, value);
+        if (std::strtod(buffer, nullptr) == value)
+            return precision;
+    }
+    return 17;
+}
+
+int countDigits(const std::string& s)
+{
+    // significant digits: strip sign, exponent, point and leading/trailing zeros
+    std::string digits{};
+    for (char ch : s)
+    {
+        if (ch == 'e')
+            break;
+        if (ch >= '0' && ch <= '9')
+            digits += ch;
+    }
+    const auto first{ digits.find_first_not_of('0') };
+    const auto last{ digits.find_last_not_of('0') };
+    return (first == std::string::npos) ? 1 : static_cast<int>(last - first + 1);
+}
+
+bool verify(int count)
+{
+    bool ok{ true };
+
+    const double doubleEdges[]{
+        0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 2.0, 1e23, 9007199254740993.0, 1e-300, 1e300,
+        std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::epsilon(),
+        std::nextafter(1.0, 2.0), std::nextafter(1.0, 0.0), 2.2250738585072011e-308, 4.9406564584124654e-324,
+        std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+    };
+    for (double d : doubleEdges)
+        ok = roundTrips<double, std::uint64_t>(d) && ok;
+
+    const float floatEdges[]{
+        0.0f, -0.0f, 1.0f, 0.1f, 3.4028235e38f, 1.17549435e-38f, 1.4e-45f, 16777217.0f, 7.038531e-26f,
+    };
+    for (float f : floatEdges)
+        ok = roundTrips<float, std::uint32_t>(f) && ok;
+
+    std::mt19937_64 rng{ 42 };
+    int notShortest{ 0 };
+    for (int i{ 0 }; i < count; ++i)
+    {
+        std::uint64_t bits{ rng() };
+        double d{};
+        std::memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d))
+            continue;
+        ok = roundTrips<double, std::uint64_t>(d) && ok;
+
+        auto bits32{ static_cast<std::uint32_t>(bits) };
+        float f{};
+        std::memcpy(&f, &bits32, sizeof(f));
+        if (std::isfinite(f))
+            ok = roundTrips<float, std::uint32_t>(f) && ok;
+
+        if (i % 16 == 0 && countDigits(FloatChars::toString(d)) > shortestLength(d))
+            ++notShortest;
+    }
+
+    // Random decimal strings, compared with strtod. Long strings exercise the fallback.
+    std::uniform_int_distribution digitCount{ 1, 25 };
+    std::uniform_int_distribution exponent{ -330, 310 };
+    for (int i{ 0 }; i < count; ++i)
+    {
+        std::string s{};
+        const int n{ digitCount(rng) };
+        for (int j{ 0 }; j < n; ++j)
+            s += static_cast<char>('0' + rng() % 10);
+        s += 'e' + std::to_string(exponent(rng));
+
+        double expected{ std::strtod(s.c_str(), nullptr) };
+        double actual{};
+        FloatChars::fromChars(s.data(), s.data() + s.size(), actual);
+        if (std::memcmp(&expected, &actual, sizeof(double)) != 0)
+        {
+            std::cout << "parse mismatch: " << s << '\n';
+            ok = false;
+        }
+
+        float expectedF{ std::strtof(s.c_str(), nullptr) };
+        float actualF{};
+        FloatChars::fromChars(s.data(), s.data() + s.size(), actualF);
+        if (std::memcmp(&expectedF, &actualF, sizeof(float)) != 0)
+        {
+            std::cout << "parse mismatch (float): " << s << '\n';
+            ok = false;
+        }
+    }
+
+    std::cout << "round trips " << (ok ? "ok" : "FAILED") << ", "
+              << notShortest << " of " << count / 16 << " sampled outputs are longer than the shortest\n";
+    return ok;
+}
+
+
+/* Benchmark
+
+- Formatting: snprintf("%.17g") vs toChars() on the same random doubles.
+- Parsing: strtod vs fromChars() on the strings produced by "%.17g".
+- Compile with -O2 (see scripts/compile-and-run.sh).
+*/
+
+template <typename F>
+double measureSeconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmark(int count)
+{
+    std::mt19937_64 rng{ 7 };
+    std::uniform_real_distribution<double> mantissa{ 1.0, 10.0 };
+    std::uniform_int_distribution exponent{ -300, 300 };
+
+    std::vector<double> values(static_cast<std::size_t>(count));
+    for (double& d : values)
+        d = mantissa(rng) * std::pow(10.0, exponent(rng));
+
+    std::vector<std::string> strings{};
+    strings.reserve(values.size());
+    char buffer[64];
+    std::size_t totalChars{ 0 };
+
+    const double printfSeconds{ measureSeconds([&] {
+        for (double d : values)
+            totalChars += static_cast<std::size_t>(std::snprintf(buffer, sizeof(buffer), "%.17g", d));
+    }) };
+    const double toCharsSeconds{ measureSeconds([&] {
+        for (double d : values)
+            totalChars += static_cast<std::size_t>(FloatChars::toChars(buffer, buffer + sizeof(buffer), d).ptr - buffer);
+    }) };
+
+    for (double d : values)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+        strings.emplace_back(buffer);
+    }
+
+    double sum{ 0.0 };
+    const double strtodSeconds{ measureSeconds([&] {
+        for (const auto& s : strings)
+            sum += std::strtod(s.c_str(), nullptr);
+    }) };
+    const double fromCharsSeconds{ measureSeconds([&] {
+        for (const auto& s : strings)
+        {
+            double d{};
+            FloatChars::fromChars(s.data(), s.data() + s.size(), d);
+            sum += d;
+        }
+    }) };
+
+    auto nsPerValue{ [count](double seconds) { return seconds * 1e9 / count; } };
+    std::cout << std::setprecision(3)
+              << "format: printf(\"%.17g\") " << nsPerValue(printfSeconds) << " ns, toChars " << nsPerValue(toCharsSeconds) << " ns\n"
+              << "parse:  strtod " << nsPerValue(strtodSeconds) << " ns, fromChars " << nsPerValue(fromCharsSeconds) << " ns\n"
+              << "(checksum " << totalChars << ' ' << sum << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+    // optional argument: number of random values to test and benchmark (not a number, e.g. the
+    // "Hello" of scripts/compile-and-run.sh, or 0: the default)
+    const long argument{ (argc > 1) ? std::strtol(argv[1], nullptr, 10) : 0 };
+    const int count{ (argument > 0 && argument <= 100000000) ? static_cast<int>(argument) : 1000000 };
+
+    printExamples();
+
+    if (!verify(count))
+        return 1;
+
+    benchmark(count);
+
+    return 0;
+}
+
+
+/* Notes
+
+- Prefer std::to_chars/std::from_chars when your standard library supports floating point (GCC 11+, MSVC 2019+):
+  they are exactly this kind of code (Ryu and Eisel-Lemire), and they are correctly rounded.
+- Grisu2 always round-trips, but in rare cases prints one digit more than necessary (see the count printed by verify()).
+  Grisu3 detects those cases and falls back, Ryu and Schubfach avoid them with larger tables.
+- Never round-trip through "%.15g" or the default std::cout precision (6): you lose bits silently.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/floating-point-numbers/
+- https://en.cppreference.com/w/cpp/utility/to_chars
+- https://en.cppreference.com/w/cpp/utility/from_chars
+- https://arxiv.org/abs/2101.11408 (Number Parsing at a Gigabyte per Second)
+- https://github.com/nlohmann/json/blob/develop/include/nlohmann/detail/conversions/to_chars.hpp
+*/
@@ -0,0 +1,114 @@
+#include "InputReader.h"
+
+#include <cerrno>
+#include <cstring>  // for std::memmove
+#include <unistd.h> // for read(), POSIX only
+
+InputReader::InputReader(int fd, std::size_t bufferSize)
+    : m_buffer(bufferSize)
+    , m_fd{ fd }
+{
+    m_pos = m_buffer.data();
+    m_end = m_buffer.data();
+}
+
+bool InputReader::refill()
+{
+    if (m_eof)
+        return false;
+
+    const auto kept{ static_cast<std::size_t>(m_end - m_pos) };
+    const auto offset{ static_cast<std::size_t>(m_pos - m_buffer.data()) };
+
+    // A single token fills the whole buffer: grow it (the only allocation after construction).
+    if (kept == m_buffer.size())
+        m_buffer.resize(m_buffer.size() * 2);
+
+    char* base{ m_buffer.data() };
+    std::memmove(base, base + offset, kept);
+
+    ssize_t n{};
+    do
+    {
+        n = ::read(m_fd, base + kept, m_buffer.size() - kept);
+    } while (n < 0 && errno == EINTR);
+
+    m_pos = base;
+    m_end = base + kept + (n > 0 ? n : 0);
+    if (n <= 0) // end of file, or a read error we treat like one
+    {
+        m_eof = true;
+        return false;
+    }
+    return true;
+}
+
+bool InputReader::skipSpace()
+{
+    for (;;)
+    {
+        while (m_pos != m_end && isSpace(*m_pos))
+        {
+            if (*m_pos == '\n')
+                ++m_line;
+            ++m_pos;
+        }
+        if (m_pos != m_end)
+            break;
+        if (!refill())
+            return false;
+    }
+    return true;
+}
+
+bool InputReader::nextToken(std::string_view& token)
+{
+    if (!skipSpace())
+        return false;
+
+    const char* p{ m_pos };
+    for (;;)
+    {
+        while (p != m_end && !isSpace(*p))
+            ++p;
+        if (p != m_end)
+            break;
+
+        // The token may continue in the next chunk of input: refill() moves it to the front of the buffer.
+        const auto length{ p - m_pos };
+        if (!refill())
+        {
+            p = m_end;
+            break;
+        }
+        p = m_pos + length;
+    }
+
+    token = std::string_view{ m_pos, static_cast<std::size_t>(p - m_pos) };
+    m_pos = p;
+    m_lastToken = token;
+    ++m_tokenCount;
+    return true;
+}
+
+InputReader::ReadStatus InputReader::readWord(std::string_view& word)
+{
+    return nextToken(word) ? ReadStatus::ok : ReadStatus::endOfInput;
+}
+
+void InputReader::skipLine()
+{
+    for (;;)
+    {
+        while (m_pos != m_end)
+        {
+            if (*m_pos++ == '\n')
+            {
+                ++m_line;
+                return;
+            }
+        }
+        if (!refill())
+            return;
+    }
+}
@@ -0,0 +1,185 @@
+#ifndef INPUT_READER_H
+#define INPUT_READER_H
+
+#include <charconv>    // for std::from_chars
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// InputReader reads whitespace-separated tokens from a file descriptor through one large buffer.
+// * No stream state: every read returns a ReadStatus for that token, and a failed token
+//   is consumed, so there is nothing to clear() or ignore() afterwards.
+// * A token must be a number as a whole: "12abc" is invalid, not 12 followed by "abc".
+// * Words are returned as std::string_view into the buffer, valid until the next read.
+class InputReader
+{
+public:
+    enum class ReadStatus
+    {
+        ok,
+        endOfInput,  // no more tokens
+        invalid,     // the token is not a number of the requested type
+        outOfRange,  // the token is a number, but does not fit into the requested type
+    };
+
+    struct TokenError
+    {
+        std::size_t line{};   // 1-based
+        std::size_t token{};  // 0-based index of the token in the whole input
+        ReadStatus status{};
+        std::string text{};
+    };
+
+    explicit InputReader(int fd = 0, std::size_t bufferSize = 1 << 16);
+
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+
+    ReadStatus readWord(std::string_view& word);
+
+    // T: any integral or floating point type
+    template <typename T>
+    ReadStatus read(T& value);
+
+    // Reads every remaining token as T. Bad tokens are reported in errors and skipped.
+    // Returns the number of values appended to values.
+    template <typename T>
+    std::size_t readAll(std::vector<T>& values, std::vector<TokenError>& errors);
+
+    // Discards the rest of the current line (the InputReader equivalent of std::cin.ignore(max, '\n'))
+    void skipLine();
+
+    std::size_t line() const { return m_line; }          // line of the last token read
+    std::size_t tokenCount() const { return m_tokenCount; }
+    std::string_view lastToken() const { return m_lastToken; } // valid until the next read
+
+private:
+    std::vector<char> m_buffer{};
+    const char* m_pos{};   // next unread character
+    const char* m_end{};   // end of the valid data in m_buffer
+    int m_fd{};
+    bool m_eof{ false };
+    std::size_t m_line{ 1 };
+    std::size_t m_tokenCount{ 0 };
+    std::string_view m_lastToken{};
+
+    // Every control character counts as a separator, not only " \t\n\v\f\r":
+    // one comparison per character instead of six.
+    static bool isSpace(char ch) { return static_cast<unsigned char>(ch) <= ' '; }
+    static bool isDigit(char ch) { return static_cast<unsigned char>(ch - '0') < 10; }
+
+    bool refill(); // keeps [m_pos, m_end), reads more after it; returns false at end of input
+    bool skipSpace(); // moves m_pos to the start of the next token; returns false at end of input
+    bool nextToken(std::string_view& token);
+
+    template <typename T>
+    bool tryReadIntegral(T& value);
+};
+
+// Fast path for the common case: a plain integer that ends inside the buffer is converted
+// while it is scanned, in a single pass. Anything else (errors, overflow, a token cut by the end
+// of the buffer) returns false without consuming input, and goes through nextToken() + std::from_chars.
+template <typename T>
+bool InputReader::tryReadIntegral(T& value)
+{
+    const char* p{ m_pos };
+    const bool negative{ *p == '-' };
+    if (*p == '-' || *p == '+')
+        ++p;
+
+    const char* digits{ p };
+    std::uint64_t magnitude{ 0 };
+    while (p != m_end && isDigit(*p) && p - digits < 19) // 19 digits always fit into 64 bits
+    {
+        magnitude = magnitude * 10 + static_cast<std::uint64_t>(*p - '0');
+        ++p;
+    }
+    if (p == digits || p == m_end || !isSpace(*p))
+        return false;
+
+    constexpr auto max{ static_cast<std::uint64_t>(std::numeric_limits<T>::max()) };
+    if constexpr (std::is_signed_v<T>)
+    {
+        if (magnitude > (negative ? max + 1 : max))
+            return false;
+    }
+    else
+    {
+        if (magnitude > max || (negative && magnitude != 0))
+            return false;
+    }
+
+    // unsigned negation wraps around, and converting back to T is modular (well-defined since C++20)
+    value = static_cast<T>(negative ? ~magnitude + 1 : magnitude);
+
+    m_lastToken = std::string_view{ m_pos, static_cast<std::size_t>(p - m_pos) };
+    m_pos = p;
+    ++m_tokenCount;
+    return true;
+}
+
+template <typename T>
+InputReader::ReadStatus InputReader::read(T& value)
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "read() supports integral and floating point types");
+
+    if constexpr (std::is_integral_v<T>)
+    {
+        if (!skipSpace())
+            return ReadStatus::endOfInput;
+        if (tryReadIntegral(value))
+            return ReadStatus::ok;
+    }
+
+    std::string_view token{};
+    if (!nextToken(token))
+        return ReadStatus::endOfInput;
+
+    const char* first{ token.data() };
+    const char* last{ first + token.size() };
+    if (first != last && *first == '+') // std::from_chars does not accept a leading '+', std::cin does
+    {
+        ++first;
+        if (first != last && (*first == '+' || *first == '-')) // one sign only: "+-5" is not -5
+            return ReadStatus::invalid;
+    }
+
+    T parsed{};
+    auto [ptr, ec]{ std::from_chars(first, last, parsed) };
+    if (ec == std::errc::result_out_of_range)
+        return ReadStatus::outOfRange;
+    if (ec != std::errc{} || ptr != last)
+        return ReadStatus::invalid;
+
+    value = parsed;
+    return ReadStatus::ok;
+}
+
+template <typename T>
+std::size_t InputReader::readAll(std::vector<T>& values, std::vector<TokenError>& errors)
+{
+    std::size_t count{ 0 };
+    for (;;)
+    {
+        T value{};
+        const ReadStatus status{ read(value) };
+        if (status == ReadStatus::endOfInput)
+            return count;
+
+        if (status == ReadStatus::ok)
+        {
+            values.push_back(value);
+            ++count;
+        }
+        else
+        {
+            errors.push_back({ m_line, m_tokenCount - 1, status, std::string{ m_lastToken } });
+        }
+    }
+}
+
+#endif
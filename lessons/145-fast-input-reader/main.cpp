@@ -0,0 +1,245 @@
+/* Reading lots of input fast, with validation
+
+- lessons/140-stream-state-and-input-validation validates std::cin input value by value:
+    std::cin >> x;
+    if (std::cin.fail()) { std::cin.clear(); std::cin.ignore(max, '\n'); }
+  That's fine for a prompt, but slow for piping millions of numbers into a program:
+  + std::cin is synchronized with C stdio by default, so it may read character by character.
+  + every operator>> constructs a sentry, checks the locale and the stream state.
+  + an error leaves the stream in a failed state that every later read has to know about.
+
+- std::ios::sync_with_stdio(false) removes the first cost (std::cin gets its own buffer).
+- A dedicated reader removes the others:
+  + read() big chunks from the file descriptor into one buffer,
+  + find tokens with a tight loop over the buffer,
+  + convert with std::from_chars (no locale, no allocation),
+  + report the status per token instead of setting flags on the stream.
+*/
+
+#include "InputReader.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h> // for pipe(), write(), close()
+
+// Feeds text into a pipe and returns the read end, so the examples can use a real file descriptor.
+// (The text must fit into the pipe buffer, 64 KiB on Linux.)
+int makePipe(std::string_view text)
+{
+    int fds[2]{};
+    if (pipe(fds) != 0)
+        return -1;
+
+    const auto written{ write(fds[1], text.data(), text.size()) };
+    close(fds[1]);
+    return (written == static_cast<ssize_t>(text.size())) ? fds[0] : -1;
+}
+
+const char* toString(InputReader::ReadStatus status)
+{
+    switch (status)
+    {
+    case InputReader::ReadStatus::ok:         return "ok";
+    case InputReader::ReadStatus::endOfInput: return "end of input";
+    case InputReader::ReadStatus::invalid:    return "invalid";
+    case InputReader::ReadStatus::outOfRange: return "out of range";
+    default:                                  return "???";
+    }
+}
+
+/* Per-token errors
+
+- Compare with func3/func4 in lessons/100-C-style-strings and the loops in lesson 140:
+  no clear(), no ignore(). A bad token is reported and consumed, the next read just continues.
+*/
+
+bool example()
+{
+    const int fd{ makePipe("1 2 three 4\n5 99999999999 6.5 -7\n+8 +-9") };
+    if (fd < 0)
+        return false;
+
+    InputReader reader{ fd, 8 }; // a tiny buffer, to exercise tokens split across reads
+
+    std::vector<int> values{};
+    std::vector<InputReader::TokenError> errors{};
+    reader.readAll(values, errors);
+    close(fd);
+
+    for (int v : values)
+        std::cout << v << ' ';
+    std::cout << '\n';
+
+    for (const auto& error : errors)
+        std::cout << "line " << error.line << ", token " << error.token << ": \"" << error.text << "\" is " << toString(error.status) << '\n';
+
+    const std::vector<int> expectedValues{ 1, 2, 4, 5, -7, 8 };
+    const bool intsOk{ values == expectedValues && errors.size() == 4 && errors[0].line == 1
+                       && errors[1].status == InputReader::ReadStatus::outOfRange && errors[2].text == "6.5"
+                       && errors[3].text == "+-9" && errors[3].status == InputReader::ReadStatus::invalid };
+
+    // doubles too: a leading '+' is accepted, but only one sign
+    const int doublesFd{ makePipe("+2.5 +-2.5") };
+    if (doublesFd < 0)
+        return false;
+    InputReader doublesReader{ doublesFd };
+    double positive{};
+    double doubleSign{};
+    const bool doublesOk{ doublesReader.read(positive) == InputReader::ReadStatus::ok && positive == 2.5
+                          && doublesReader.read(doubleSign) == InputReader::ReadStatus::invalid };
+    close(doublesFd);
+    return intsOk && doublesOk;
+}
+
+bool mixedExample()
+{
+    const int fd{ makePipe("alice 31 1.75\nbob x 1.80\ncarol 27 1.62\n") };
+    if (fd < 0)
+        return false;
+
+    InputReader reader{ fd };
+    int validRecords{ 0 };
+    for (;;)
+    {
+        std::string_view name{};
+        if (reader.readWord(name) != InputReader::ReadStatus::ok)
+            break;
+        const std::string nameCopy{ name }; // name is only valid until the next read
+
+        int age{};
+        double height{};
+        if (reader.read(age) != InputReader::ReadStatus::ok || reader.read(height) != InputReader::ReadStatus::ok)
+        {
+            std::cout << "skipping bad record on line " << reader.line() << '\n';
+            reader.skipLine(); // the rest of the record is on the same line
+            continue;
+        }
+        std::cout << nameCopy << " is " << age << " years old and " << height << "m tall\n";
+        ++validRecords;
+    }
+    close(fd);
+    return validRecords == 2;
+}
+
+
+/* Benchmark
+
+Generate the input once, then pipe it into each reader:
+    ./main.out generate 100000000 > ints.txt
+    ./main.out reader     < ints.txt
+    ./main.out cin-nosync < ints.txt
+    ./main.out cin        < ints.txt
+or directly from the generator:
+    ./main.out generate 100000000 | ./main.out reader
+*/
+
+void generate(long long count)
+{
+    std::mt19937 rng{ 42 };
+    std::uniform_int_distribution<int> dist{ -1000000000, 1000000000 };
+
+    std::vector<char> buffer(1 << 16);
+    std::size_t used{ 0 };
+    for (long long i{ 0 }; i < count; ++i)
+    {
+        if (buffer.size() - used < 16)
+        {
+            std::fwrite(buffer.data(), 1, used, stdout);
+            used = 0;
+        }
+        auto [end, ec]{ std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), dist(rng)) };
+        *end = (i % 10 == 9) ? '\n' : ' ';
+        used = static_cast<std::size_t>(end + 1 - buffer.data());
+    }
+    std::fwrite(buffer.data(), 1, used, stdout);
+}
+
+template <typename F>
+void measure(const char* name, F&& readAll)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    long long count{ 0 };
+    long long sum{ 0 };
+    readAll(count, sum);
+    const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+    std::cerr << name << ": " << count << " integers (sum " << sum << ") in " << seconds << " s, "
+              << static_cast<double>(count) / seconds / 1e6 << " M integers/s\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string_view mode{ (argc > 1) ? argv[1] : "" };
+
+    if (mode == "generate")
+    {
+        generate((argc > 2) ? std::atoll(argv[2]) : 100000000);
+        return 0;
+    }
+
+    if (mode == "reader")
+    {
+        measure("InputReader", [](long long& count, long long& sum) {
+            InputReader reader{ 0, 1 << 20 };
+            int value{};
+            for (InputReader::ReadStatus status{}; (status = reader.read(value)) != InputReader::ReadStatus::endOfInput;)
+            {
+                if (status == InputReader::ReadStatus::ok)
+                {
+                    ++count;
+                    sum += value;
+                }
+            }
+        });
+        return 0;
+    }
+
+    if (mode == "cin" || mode == "cin-nosync")
+    {
+        if (mode == "cin-nosync")
+            std::ios::sync_with_stdio(false);
+
+        measure(argv[1], [](long long& count, long long& sum) {
+            int value{};
+            while (std::cin >> value)
+            {
+                ++count;
+                sum += value;
+            }
+        });
+        return 0;
+    }
+
+    const bool ok{ example() && mixedExample() };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- sync_with_stdio(false) must be called before any input/output, and afterwards you must not mix
+  std::cin with scanf/getchar.
+- std::cin.tie(nullptr) additionally stops std::cout being flushed before each read, which matters
+  for interactive prompts mixed with bulk input.
+- InputReader uses POSIX read(). On Windows, use _read() or ReadFile() instead.
+- Words returned by readWord() point into the buffer. Copy them (std::string) if you need them
+  after the next read, just like you would with any std::string_view (see lessons/025-std-string_view).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/stream-states-and-input-validation/
+- https://en.cppreference.com/w/cpp/io/ios_base/sync_with_stdio
+- https://en.cppreference.com/w/cpp/utility/from_chars
+- https://man7.org/linux/man-pages/man2/read.2.html
+*/
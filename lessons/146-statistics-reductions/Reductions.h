@@ -0,0 +1,251 @@
+#ifndef REDUCTIONS_H
+#define REDUCTIONS_H
+
+#include <algorithm>   // for std::min, std::max
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>        // C++20
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Type safe, accurate and fast reductions over arrays of float/double.
+// * sum(), mean() and variance() use compensated (Neumaier-style) summation: the rounding error of every
+//   addition is captured and added back, so the result is as good as summing in twice the precision.
+// * The work is split into fixed-size blocks and each block into kLanes independent accumulators,
+//   so the compiler can keep the lanes in SIMD registers.
+// * Blocks are always combined in the same order, so the parallel versions return bit-identical
+//   results for any number of threads (and the same result as the sequential versions).
+namespace Reduce
+{
+    namespace detail
+    {
+        inline constexpr std::size_t kLanes{ 8 };
+        inline constexpr std::size_t kBlockSize{ 1 << 14 };
+
+        // Knuth's TwoSum: s + x == t + error exactly. Branch-free, unlike the textbook Neumaier loop,
+        // so that kLanes of them can run side by side in SIMD registers.
+        template <typename T>
+        void twoSumAdd(T& sum, T& compensation, T x)
+        {
+            const T t{ sum + x };
+            const T z{ t - sum };
+            compensation += (sum - (t - z)) + (x - z);
+            sum = t;
+        }
+
+        template <typename T>
+        struct Partial
+        {
+            T sum{};
+            T compensation{};
+        };
+
+        // Compensated sum of transform(values[i]) for one block
+        template <typename T, typename Transform>
+        Partial<T> sumBlock(const T* values, std::size_t count, Transform transform)
+        {
+            std::array<T, kLanes> sums{};
+            std::array<T, kLanes> compensations{};
+
+            std::size_t i{ 0 };
+            for (; i + kLanes <= count; i += kLanes)
+            {
+                for (std::size_t lane{ 0 }; lane < kLanes; ++lane)
+                    twoSumAdd(sums[lane], compensations[lane], transform(values[i + lane]));
+            }
+            for (; i < count; ++i)
+                twoSumAdd(sums[0], compensations[0], transform(values[i]));
+
+            Partial<T> result{};
+            for (std::size_t lane{ 0 }; lane < kLanes; ++lane)
+            {
+                twoSumAdd(result.sum, result.compensation, sums[lane]);
+                result.compensation += compensations[lane];
+            }
+            return result;
+        }
+
+        // Splits values into blocks, lets threadCount threads sum disjoint ranges of blocks,
+        // then combines the per-block partial sums in block order.
+        // The block boundaries do not depend on threadCount, so neither does the result.
+        template <typename T, typename Transform>
+        T blockedSum(std::span<const T> values, int threadCount, Transform transform)
+        {
+            const std::size_t blockCount{ (values.size() + kBlockSize - 1) / kBlockSize };
+            std::vector<Partial<T>> partials(blockCount);
+
+            auto sumBlocks{ [&](std::size_t firstBlock, std::size_t lastBlock) {
+                for (std::size_t block{ firstBlock }; block < lastBlock; ++block)
+                {
+                    const std::size_t first{ block * kBlockSize };
+                    const std::size_t count{ std::min(kBlockSize, values.size() - first) };
+                    partials[block] = sumBlock(values.data() + first, count, transform);
+                }
+            } };
+
+            const auto threads{ static_cast<std::size_t>(std::max(1, threadCount)) };
+            if (threads == 1 || blockCount < 2)
+            {
+                sumBlocks(0, blockCount);
+            }
+            else
+            {
+                std::vector<std::thread> workers{};
+                for (std::size_t t{ 1 }; t < threads; ++t)
+                    workers.emplace_back(sumBlocks, t * blockCount / threads, (t + 1) * blockCount / threads);
+                sumBlocks(0, blockCount / threads); // the calling thread takes the first range
+                for (auto& worker : workers)
+                    worker.join();
+            }
+
+            Partial<T> total{};
+            for (const auto& partial : partials)
+            {
+                twoSumAdd(total.sum, total.compensation, partial.sum);
+                total.compensation += partial.compensation;
+            }
+            return total.sum + total.compensation;
+        }
+
+        inline auto identity{ [](auto x) { return x; } };
+
+        template <typename T>
+        T pairwiseSum(const T* values, std::size_t count)
+        {
+            if (count <= 2 * kLanes)
+            {
+                T sum{};
+                for (std::size_t i{ 0 }; i < count; ++i)
+                    sum += values[i];
+                return sum;
+            }
+            const std::size_t half{ count / 2 };
+            return pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+        }
+
+        template <typename T>
+        T minimum(std::span<const T> values)
+        {
+            std::array<T, kLanes> lanes{};
+            lanes.fill(std::numeric_limits<T>::infinity());
+
+            std::size_t i{ 0 };
+            for (; i + kLanes <= values.size(); i += kLanes)
+            {
+                for (std::size_t lane{ 0 }; lane < kLanes; ++lane)
+                    lanes[lane] = (values[i + lane] < lanes[lane]) ? values[i + lane] : lanes[lane]; // NaN never wins
+            }
+            for (; i < values.size(); ++i)
+                lanes[0] = (values[i] < lanes[0]) ? values[i] : lanes[0];
+
+            T result{ lanes[0] };
+            for (T lane : lanes)
+                result = (lane < result) ? lane : result;
+            return result;
+        }
+
+        template <typename T>
+        T maximum(std::span<const T> values)
+        {
+            std::array<T, kLanes> lanes{};
+            lanes.fill(-std::numeric_limits<T>::infinity());
+
+            std::size_t i{ 0 };
+            for (; i + kLanes <= values.size(); i += kLanes)
+            {
+                for (std::size_t lane{ 0 }; lane < kLanes; ++lane)
+                    lanes[lane] = (values[i + lane] > lanes[lane]) ? values[i + lane] : lanes[lane];
+            }
+            for (; i < values.size(); ++i)
+                lanes[0] = (values[i] > lanes[0]) ? values[i] : lanes[0];
+
+            T result{ lanes[0] };
+            for (T lane : lanes)
+                result = (lane > result) ? lane : result;
+            return result;
+        }
+
+        template <typename T>
+        std::size_t indexOf(std::span<const T> values, T value)
+        {
+            for (std::size_t i{ 0 }; i < values.size(); ++i)
+            {
+                if (values[i] == value)
+                    return i;
+            }
+            return values.size();
+        }
+
+        template <typename T>
+        T variance(std::span<const T> values, int threadCount, std::size_t degreesOfFreedom)
+        {
+            if (values.size() <= degreesOfFreedom)
+                return std::numeric_limits<T>::quiet_NaN();
+
+            // Two passes: the textbook one-pass formula E[x^2] - E[x]^2 cancels catastrophically.
+            const T mean{ blockedSum(values, threadCount, identity) / static_cast<T>(values.size()) };
+            const T squares{ blockedSum(values, threadCount, [mean](T x) { return (x - mean) * (x - mean); }) };
+            return squares / static_cast<T>(values.size() - degreesOfFreedom);
+        }
+    }
+
+    template <typename T>
+    struct MinMax
+    {
+        T min{};
+        T max{};
+    };
+
+    // Sums. An empty span sums to 0.
+    inline double sum(std::span<const double> values) { return detail::blockedSum(values, 1, detail::identity); }
+    inline float sum(std::span<const float> values) { return detail::blockedSum(values, 1, detail::identity); }
+    inline double parallelSum(std::span<const double> values, int threadCount) { return detail::blockedSum(values, threadCount, detail::identity); }
+    inline float parallelSum(std::span<const float> values, int threadCount) { return detail::blockedSum(values, threadCount, detail::identity); }
+
+    // Plain recursive halving: error grows with log(n) instead of n, cheaper than compensation, less accurate.
+    inline double pairwiseSum(std::span<const double> values) { return detail::pairwiseSum(values.data(), values.size()); }
+    inline float pairwiseSum(std::span<const float> values) { return detail::pairwiseSum(values.data(), values.size()); }
+
+    // Means. The mean of an empty span is NaN.
+    inline double mean(std::span<const double> values) { return sum(values) / static_cast<double>(values.size()); }
+    inline float mean(std::span<const float> values) { return sum(values) / static_cast<float>(values.size()); }
+    inline double parallelMean(std::span<const double> values, int threadCount) { return parallelSum(values, threadCount) / static_cast<double>(values.size()); }
+
+    // Population variance (divides by n) and sample variance (divides by n - 1). NaN if there are too few values.
+    inline double variance(std::span<const double> values) { return detail::variance(values, 1, 0); }
+    inline float variance(std::span<const float> values) { return detail::variance(values, 1, 0); }
+    inline double sampleVariance(std::span<const double> values) { return detail::variance(values, 1, 1); }
+    inline float sampleVariance(std::span<const float> values) { return detail::variance(values, 1, 1); }
+    inline double parallelVariance(std::span<const double> values, int threadCount) { return detail::variance(values, threadCount, 0); }
+
+    // NaNs are ignored. The min/max of an empty (or all-NaN) span are +inf/-inf.
+    inline MinMax<double> minMax(std::span<const double> values) { return { detail::minimum(values), detail::maximum(values) }; }
+    inline MinMax<float> minMax(std::span<const float> values) { return { detail::minimum(values), detail::maximum(values) }; }
+
+    // Index of the first smallest/largest element, or values.size() if there is none (like std::min_element returning end).
+    inline std::size_t argMin(std::span<const double> values) { return detail::indexOf(values, detail::minimum(values)); }
+    inline std::size_t argMin(std::span<const float> values) { return detail::indexOf(values, detail::minimum(values)); }
+    inline std::size_t argMax(std::span<const double> values) { return detail::indexOf(values, detail::maximum(values)); }
+    inline std::size_t argMax(std::span<const float> values) { return detail::indexOf(values, detail::maximum(values)); }
+
+    // Variadic versions: the type safe replacement for findAverage(int count, ...).
+    // Every argument is converted to double, whatever arithmetic type it has.
+    template <typename... Args>
+    double sumOf(Args... args)
+    {
+        static_assert((std::is_arithmetic_v<Args> && ...), "sumOf() only takes arithmetic arguments");
+        const std::array<double, sizeof...(Args)> values{ static_cast<double>(args)... };
+        return sum(values);
+    }
+
+    template <typename... Args>
+    double meanOf(Args... args)
+    {
+        static_assert(sizeof...(Args) > 0, "meanOf() needs at least one argument");
+        return sumOf(args...) / static_cast<double>(sizeof...(Args));
+    }
+}
+
+#endif
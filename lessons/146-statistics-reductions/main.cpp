@@ -0,0 +1,178 @@
+/* Replacing findAverage(int count, ...)
+
+- lessons/109-ellipsis computes an average through an ellipsis:
+    findAverage(5, 1.0, 2, 3, 4, 5) // -3.28117e+08: the double is read as an int
+  and it sums one int at a time, which overflows and cannot handle fractional values.
+- A variadic template (parameter pack) knows the type of every argument at compile time:
+    Reduce::meanOf(1.0, 2, 3, 4, 5) // 3
+- For data that lives in an array, pass a std::span (C++20): a view of contiguous elements,
+  so std::vector, std::array and C-style arrays all work without copies.
+*/
+
+/* Accurate sums
+
+- Every floating point addition rounds. Summing n values in a plain loop accumulates up to ~n rounding errors,
+  and adding small values to a large running sum loses their low bits entirely.
+- Pairwise summation (sum the halves recursively) brings the error down to ~log(n) roundings.
+- Compensated summation (Kahan, Neumaier) computes the rounding error of each addition exactly
+  and adds it back at the end: the error no longer depends on n.
+- Variance: E[x^2] - E[x]^2 is a difference of two large, nearly equal numbers. Compute the mean first,
+  then sum (x - mean)^2.
+*/
+
+/* Fast and deterministic
+
+- The compensated loop keeps 8 independent accumulators (lanes). Independent lanes let the compiler use
+  SIMD instructions without reordering any single accumulator's additions (which it must not do without -ffast-math).
+- For threads, the input is cut into blocks of a fixed size. Threads only decide *who* sums a block;
+  the blocks are always combined in the same order. So the result is the same for 1, 2 or 64 threads.
+  (Splitting the input into one chunk per thread would make the result depend on the thread count.)
+*/
+
+#include "Reductions.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+bool examples()
+{
+    std::cout << Reduce::meanOf(1, 2, 3, 4, 5) << '\n';       // 3
+    std::cout << Reduce::meanOf(1, 2, 3, 4, 5, 6) << '\n';    // 3.5
+    std::cout << Reduce::meanOf(1.0, 2, 3, 4, 5) << '\n';     // 3, not garbage
+    // Reduce::meanOf("hello", 1); // compile error instead of undefined behavior
+
+    const std::vector<double> v{ 3.0, -1.0, 4.0, 1.0, -5.0, 9.0 };
+    const auto [min, max]{ Reduce::minMax(v) };
+    std::cout << "sum " << Reduce::sum(v) << ", mean " << Reduce::mean(v) << ", variance " << Reduce::variance(v)
+              << ", min " << min << " at " << Reduce::argMin(v) << ", max " << max << " at " << Reduce::argMax(v) << '\n';
+
+    const std::vector<double> empty{};
+    return Reduce::meanOf(1.0, 2, 3, 4, 5) == 3.0
+        && Reduce::sum(v) == 11.0 && min == -5.0 && max == 9.0 && Reduce::argMin(v) == 4 && Reduce::argMax(v) == 5
+        && Reduce::sum(empty) == 0.0 && Reduce::argMin(empty) == 0 && std::isnan(Reduce::sampleVariance(empty));
+}
+
+double naiveSum(const std::vector<double>& values)
+{
+    double sum{ 0.0 };
+    for (double x : values)
+        sum += x;
+    return sum;
+}
+
+// Reference: compensated summation in long double (64-bit significand on x86)
+long double referenceSum(const std::vector<double>& values)
+{
+    long double sum{ 0.0L };
+    long double compensation{ 0.0L };
+    for (double x : values)
+        Reduce::detail::twoSumAdd(sum, compensation, static_cast<long double>(x));
+    return sum + compensation;
+}
+
+void accuracy(const std::vector<double>& values)
+{
+    const long double exact{ referenceSum(values) };
+    auto relativeError{ [exact](double s) { return static_cast<double>(std::abs((static_cast<long double>(s) - exact) / exact)); } };
+
+    std::cout << std::setprecision(3)
+              << "relative error: plain loop " << relativeError(naiveSum(values))
+              << ", pairwise " << relativeError(Reduce::pairwiseSum(values))
+              << ", compensated " << relativeError(Reduce::sum(values)) << '\n';
+
+    // The textbook one-pass variance on data with a large offset
+    std::vector<double> shifted(values);
+    for (double& x : shifted)
+        x += 1e8;
+    double sumX{ 0.0 };
+    double sumX2{ 0.0 };
+    for (double x : shifted)
+    {
+        sumX += x;
+        sumX2 += x * x;
+    }
+    const auto n{ static_cast<double>(shifted.size()) };
+    std::cout << "variance: one-pass formula " << sumX2 / n - (sumX / n) * (sumX / n)
+              << ", Reduce::variance " << Reduce::variance(shifted) << " (unshifted " << Reduce::variance(values) << ")\n";
+}
+
+bool deterministic(const std::vector<double>& values)
+{
+    const double expected{ Reduce::sum(values) };
+    bool ok{ true };
+    for (int threads : { 1, 2, 3, 4, 7, 16, 64 })
+        ok = ok && Reduce::parallelSum(values, threads) == expected;
+    std::cout << "parallel sums are " << (ok ? "identical" : "DIFFERENT") << " for 1..64 threads\n";
+    return ok;
+}
+
+template <typename F>
+double measureSeconds(int repeat, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    for (int i{ 0 }; i < repeat; ++i)
+        f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeat;
+}
+
+void throughput(const std::vector<double>& values)
+{
+    const double bytes{ static_cast<double>(values.size() * sizeof(double)) };
+    const int threads{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    double sink{ 0.0 };
+
+    auto report{ [&](const char* name, double seconds) {
+        std::cout << std::setw(20) << name << ": " << bytes / seconds / 1e9 << " GB/s\n";
+    } };
+
+    report("plain loop", measureSeconds(10, [&] { sink += naiveSum(values); }));
+    report("pairwise", measureSeconds(10, [&] { sink += Reduce::pairwiseSum(values); }));
+    report("compensated", measureSeconds(10, [&] { sink += Reduce::sum(values); }));
+    report("compensated (mt)", measureSeconds(10, [&] { sink += Reduce::parallelSum(values, threads); }));
+    report("minMax", measureSeconds(10, [&] { sink += Reduce::minMax(values).max; }));
+    report("variance", measureSeconds(10, [&] { sink += Reduce::variance(values); }));
+    std::cout << "(" << threads << " threads, checksum " << sink << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    // values of very different magnitudes and signs: hard for a plain loop
+    std::mt19937_64 rng{ 1 };
+    std::uniform_real_distribution<double> mantissa{ -1.0, 1.0 };
+    std::uniform_int_distribution exponent{ -10, 10 };
+    std::vector<double> values(count);
+    for (double& x : values)
+        x = std::ldexp(mantissa(rng), exponent(rng));
+
+    const bool ok{ examples() && deterministic(values) };
+    accuracy(values);
+    throughput(values);
+
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Never compile compensated summation with -ffast-math: it allows the compiler to simplify
+  (sum - (t - z)) + (x - z) to 0, silently turning it back into a plain loop.
+- Integers don't need any of this: they have no rounding. Use a wide enough type (std::int64_t) instead.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/ellipsis-and-why-to-avoid-them/
+- https://en.wikipedia.org/wiki/Kahan_summation_algorithm
+- https://en.wikipedia.org/wiki/Pairwise_summation
+- https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+- https://en.cppreference.com/w/cpp/container/span
+*/
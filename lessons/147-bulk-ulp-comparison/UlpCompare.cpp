@@ -0,0 +1,399 @@
+#include "UlpCompare.h"
+
+#include <algorithm>
+#include <bit>      // for std::bit_cast, std::bit_width (C++20)
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#define ULP_COMPARE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    template <typename T>
+    using SignedBits = std::conditional_t<sizeof(T) == 8, std::int64_t, std::int32_t>;
+
+    /* Ordered integers
+
+    - IEEE 754 values are stored as sign + magnitude. For positive numbers, the bit patterns
+      of consecutive values are consecutive integers.
+    - Negating the magnitude of negative numbers turns the whole line into one ordered integer range:
+      -0.0 and +0.0 both become 0, and the ULP distance is the difference of two integers.
+    - Everything is done with masks instead of branches: with random signs, a branch would be
+      mispredicted half of the time, and branch-free code can use SIMD instructions.
+    */
+    template <typename T>
+    std::int64_t toOrdered(T x)
+    {
+        const auto bits{ static_cast<std::int64_t>(std::bit_cast<SignedBits<T>>(x)) };
+        const std::int64_t magnitude{ bits & std::numeric_limits<SignedBits<T>>::max() };
+        const std::int64_t mask{ (bits < 0) ? -1 : 0 }; // compiles to an arithmetic shift, not a branch
+        return (magnitude ^ mask) - mask;                // -magnitude for negative numbers
+    }
+
+    template <typename T>
+    std::uint64_t orderedDistance(T a, T b)
+    {
+        const std::int64_t x{ toOrdered(a) };
+        const std::int64_t y{ toOrdered(b) };
+        // |x - y| can exceed INT64_MAX: subtract as unsigned, then negate if x < y
+        const std::uint64_t difference{ static_cast<std::uint64_t>(x) - static_cast<std::uint64_t>(y) };
+        const std::uint64_t mask{ std::uint64_t{ 0 } - static_cast<std::uint64_t>(x < y) };
+        return (difference ^ mask) - mask;
+    }
+
+    template <typename T>
+    std::uint64_t ulpDistanceImpl(T a, T b)
+    {
+        if (a != a || b != b)
+            return std::numeric_limits<std::uint64_t>::max();
+
+        return orderedDistance(a, b);
+    }
+
+    /* Two passes per chunk
+
+    - The first pass computes the ULP distance of every element and the largest absolute error,
+      with no branch and no division: on x86 it works on SSE2 vectors (2 doubles or 4 floats at a
+      time, as in lessons/149-simd-vector-math), elsewhere it is a plain loop.
+      A NaN gets the distance UINT64_MAX by OR-ing in the "unordered" mask.
+    - A scalar histogram costs more than the whole first pass: each increment is a load and a store
+      of a counter that the previous element most likely incremented too. When every distance of a
+      chunk is below 16 (the usual case: a few ULPs of rounding), the buckets 0 to 4 and the largest
+      distance are counted with vector compares instead.
+    - The scalar pass only runs for chunks with a larger distance or a NaN: it fills the histogram,
+      and looks closer at the elements that are not within maxUlps (the absolute/relative tolerance,
+      NaNs, the relative error).
+    */
+    constexpr std::size_t kChunkSize{ 512 }; // a multiple of every vector width
+    constexpr std::uint64_t kSmallDistance{ 16 };
+
+    // Returns the bitwise OR of the distances: below kSmallDistance if they all are
+    template <typename T>
+    std::uint64_t distancesScalar(const T* a, const T* e, std::size_t size, std::uint64_t* ulps, double& maxAbs)
+    {
+        std::uint64_t distanceBits{ 0 };
+        for (std::size_t j{ 0 }; j < size; ++j)
+        {
+            ulps[j] = ulpDistanceImpl(a[j], e[j]);
+            distanceBits |= ulps[j];
+            const double absError{ std::abs(static_cast<double>(a[j]) - static_cast<double>(e[j])) };
+            maxAbs = (absError > maxAbs) ? absError : maxAbs; // NaN never wins (NaNs are handled in the scalar pass)
+        }
+        return distanceBits;
+    }
+
+#ifdef ULP_COMPARE_SSE2
+    // GCC vector types: operators work lane by lane, comparisons give all-ones lanes where true
+    using Bits64 = __v2du;
+    using Bits32 = __v4su;
+    using Int16 = __v8hi;
+
+    constexpr std::uint64_t kDoubleMagnitude{ 0x7FFFFFFFFFFFFFFF };
+
+    // The sign of x as a lane mask. -0.0 gives 0, which is right: its magnitude is 0 too.
+    template <typename Bits, typename Vector>
+    Bits toOrdered(Vector x, Bits magnitudeMask)
+    {
+        const Bits negative{ std::bit_cast<Bits>(x < Vector{}) };
+        const Bits magnitude{ std::bit_cast<Bits>(x) & magnitudeMask };
+        return (magnitude ^ negative) - negative; // unsigned lanes: wraps, no overflow
+    }
+
+    // orderedDistance() for a vector. Ordered values are monotonic, so x < y (as floating point)
+    // tells which one is smaller without a 64-bit integer compare (SSE2 has none).
+    template <typename Bits, typename Vector>
+    Bits vectorDistance(Vector x, Vector y, Bits magnitudeMask)
+    {
+        const Bits less{ std::bit_cast<Bits>(x < y) };
+        const Bits difference{ toOrdered(x, magnitudeMask) - toOrdered(y, magnitudeMask) };
+        const Bits nan{ std::bit_cast<Bits>(x != x) | std::bit_cast<Bits>(y != y) };
+        return ((difference ^ less) - less) | nan;
+    }
+
+    __m128d maxAbsError(__m128d difference, __m128d maxVector)
+    {
+        const __m128d absError{ std::bit_cast<__m128d>(std::bit_cast<Bits64>(difference) & (Bits64{} + kDoubleMagnitude)) };
+        return _mm_max_pd(absError, maxVector); // maxpd returns its second operand when the first is NaN
+    }
+
+    double horizontalMax(__m128d v)
+    {
+        return std::max(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)));
+    }
+
+    std::uint64_t horizontalOr(__m128i v)
+    {
+        const auto lanes{ std::bit_cast<Bits64>(v) };
+        return lanes[0] | lanes[1];
+    }
+
+    std::uint64_t distances(const double* a, const double* e, std::size_t size, std::uint64_t* ulps, double& maxAbs)
+    {
+        const Bits64 magnitudeMask{ Bits64{} + kDoubleMagnitude };
+        __m128d maxVector{ _mm_set1_pd(maxAbs) };
+        __m128i bits{};
+        std::size_t j{ 0 };
+        for (; j + 2 <= size; j += 2)
+        {
+            const __m128d x{ _mm_loadu_pd(a + j) };
+            const __m128d y{ _mm_loadu_pd(e + j) };
+            const __m128i distance{ std::bit_cast<__m128i>(vectorDistance(x, y, magnitudeMask)) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ulps + j), distance);
+            bits = _mm_or_si128(bits, distance);
+            maxVector = maxAbsError(x - y, maxVector);
+        }
+        maxAbs = horizontalMax(maxVector);
+        return horizontalOr(bits) | distancesScalar(a + j, e + j, size - j, ulps + j, maxAbs);
+    }
+
+    std::uint64_t distances(const float* a, const float* e, std::size_t size, std::uint64_t* ulps, double& maxAbs)
+    {
+        const Bits32 magnitudeMask{ Bits32{} + 0x7FFFFFFFu };
+        __m128d maxVector{ _mm_set1_pd(maxAbs) };
+        __m128i bits{};
+        std::size_t j{ 0 };
+        for (; j + 4 <= size; j += 4)
+        {
+            const __m128 x{ _mm_loadu_ps(a + j) };
+            const __m128 y{ _mm_loadu_ps(e + j) };
+            // 32-bit distances, widened to 64 bits: a NaN lane (all ones) is widened with all ones
+            const __m128i distance{ std::bit_cast<__m128i>(vectorDistance(x, y, magnitudeMask)) };
+            const __m128i high{ std::bit_cast<__m128i>(_mm_cmpunord_ps(x, y)) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ulps + j), _mm_unpacklo_epi32(distance, high));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ulps + j + 2), _mm_unpackhi_epi32(distance, high));
+            bits = _mm_or_si128(bits, _mm_or_si128(distance, high));
+
+            // the errors in double, as in the scalar code (a float difference could round)
+            maxVector = maxAbsError(_mm_cvtps_pd(x) - _mm_cvtps_pd(y), maxVector);
+            maxVector = maxAbsError(_mm_cvtps_pd(_mm_movehl_ps(x, x)) - _mm_cvtps_pd(_mm_movehl_ps(y, y)), maxVector);
+        }
+        maxAbs = horizontalMax(maxVector);
+        return horizontalOr(bits) | distancesScalar(a + j, e + j, size - j, ulps + j, maxAbs);
+    }
+
+    // The low 32 bits of the 64-bit lanes of a and b
+    __m128i low32(__m128i a, __m128i b)
+    {
+        return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    // For a chunk whose distances are all below kSmallDistance: adds the buckets 0 to 4 to the
+    // histogram and returns the largest distance. The distances fit in 16 bits: 8 of them are
+    // narrowed into one vector, then counted with one compare per bucket boundary.
+    std::uint64_t histogramSmall(const std::uint64_t* ulps, std::size_t size, UlpCompare::Report& report)
+    {
+        auto load{ [ulps](std::size_t j) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ulps + j)); } };
+
+        Int16 below[4]{}; // -(lanes below 1, 2, 4, 8): a true comparison is -1. At most 64 per lane.
+        Int16 maxVector{};
+        std::size_t j{ 0 };
+        for (; j + 8 <= size; j += 8)
+        {
+            const Int16 lanes{ std::bit_cast<Int16>(_mm_packs_epi32(low32(load(j), load(j + 2)), low32(load(j + 4), load(j + 6)))) };
+            below[0] += lanes < (Int16{} + 1);
+            below[1] += lanes < (Int16{} + 2);
+            below[2] += lanes < (Int16{} + 4);
+            below[3] += lanes < (Int16{} + 8);
+            maxVector = std::bit_cast<Int16>(_mm_max_epi16(std::bit_cast<__m128i>(maxVector), std::bit_cast<__m128i>(lanes)));
+        }
+
+        std::size_t counts[4]{};
+        std::uint64_t maxDistance{ 0 };
+        for (std::size_t lane{ 0 }; lane < 8; ++lane)
+        {
+            for (std::size_t k{ 0 }; k < 4; ++k)
+                counts[k] += static_cast<std::size_t>(-below[k][lane]);
+            maxDistance = std::max(maxDistance, static_cast<std::uint64_t>(maxVector[lane]));
+        }
+        for (; j < size; ++j) // the last chunk's tail
+        {
+            for (std::size_t k{ 0 }; k < 4; ++k)
+                counts[k] += ulps[j] < (std::uint64_t{ 1 } << k);
+            maxDistance = std::max(maxDistance, ulps[j]);
+        }
+
+        report.histogram[0] += counts[0];
+        report.histogram[1] += counts[1] - counts[0];
+        report.histogram[2] += counts[2] - counts[1];
+        report.histogram[3] += counts[3] - counts[2];
+        report.histogram[4] += size - counts[3];
+        return maxDistance;
+    }
+#else
+    template <typename T>
+    std::uint64_t distances(const T* a, const T* e, std::size_t size, std::uint64_t* ulps, double& maxAbs)
+    {
+        return distancesScalar(a, e, size, ulps, maxAbs);
+    }
+#endif
+
+    template <typename T>
+    UlpCompare::Report compareRange(const T* actual, const T* expected, std::size_t first, std::size_t last,
+                                    const UlpCompare::Tolerance& tolerance, std::size_t maxReportedMismatches)
+    {
+        UlpCompare::Report report{};
+        report.count = last - first;
+
+        std::uint64_t ulps[kChunkSize];
+        double maxAbs{ 0.0 };
+        double maxRel{ 0.0 };
+
+        for (std::size_t chunk{ first }; chunk < last; chunk += kChunkSize)
+        {
+            const std::size_t size{ std::min(kChunkSize, last - chunk) };
+            const T* a{ actual + chunk };
+            const T* e{ expected + chunk };
+
+            const std::uint64_t distanceBits{ distances(a, e, size, ulps, maxAbs) };
+
+#ifdef ULP_COMPARE_SSE2
+            if (distanceBits < kSmallDistance)
+            {
+                const std::uint64_t maxDistance{ histogramSmall(ulps, size, report) };
+                if (maxDistance <= tolerance.maxUlps)
+                {
+                    if (maxDistance > report.maxUlps) // rare: the maximum only grows a few times
+                    {
+                        report.maxUlps = maxDistance;
+                        report.maxUlpsIndex = chunk + static_cast<std::size_t>(std::find(ulps, ulps + size, maxDistance) - ulps);
+                    }
+                    continue;
+                }
+                // maxUlps is below 15 and some elements are beyond it: look at them below (the histogram is done)
+            }
+            const bool histogramDone{ distanceBits < kSmallDistance };
+#else
+            const bool histogramDone{ false };
+            (void)distanceBits;
+#endif
+
+            for (std::size_t j{ 0 }; j < size; ++j)
+            {
+                std::uint64_t distance{ ulps[j] };
+                if (distance > tolerance.maxUlps)
+                {
+                    const double x{ static_cast<double>(a[j]) };
+                    const double y{ static_cast<double>(e[j]) };
+                    const bool bothNan{ x != x && y != y };
+                    if (bothNan && tolerance.nanEqualsNan)
+                    {
+                        distance = 0;
+                    }
+                    else
+                    {
+                        // the approximatelyEqualAbsRel() rule (false for NaNs, as every comparison with NaN is)
+                        const double absError{ std::abs(x - y) };
+                        const double magnitude{ std::max(std::abs(x), std::abs(y)) };
+                        const bool matches{ absError <= tolerance.absEpsilon || absError <= magnitude * tolerance.relEpsilon };
+                        if (!matches)
+                        {
+                            ++report.mismatches;
+                            if (report.firstMismatches.size() < maxReportedMismatches)
+                                report.firstMismatches.push_back(chunk + j);
+                        }
+
+                        // A NaN is infinitely far, as for the ULP distance; 0/0 (two zeros) is not an error
+                        const bool nan{ x != x || y != y };
+                        const double relError{ nan ? std::numeric_limits<double>::infinity() : (magnitude > 0.0) ? absError / magnitude : 0.0 };
+                        maxAbs = nan ? std::numeric_limits<double>::infinity() : maxAbs;
+                        maxRel = std::max(maxRel, relError);
+                    }
+                }
+
+                if (!histogramDone)
+                {
+                    // bit_width(0) would need a (badly predicted) branch: compute it for distance | 1 and correct for 0
+                    ++report.histogram[static_cast<std::size_t>(std::bit_width(distance | 1)) - (distance == 0)];
+                }
+                if (distance > report.maxUlps)
+                {
+                    report.maxUlps = distance;
+                    report.maxUlpsIndex = chunk + j;
+                }
+            }
+        }
+
+        report.maxAbsError = maxAbs;
+        report.maxRelError = maxRel;
+        return report;
+    }
+
+    void merge(UlpCompare::Report& into, const UlpCompare::Report& from, std::size_t maxReportedMismatches)
+    {
+        into.count += from.count;
+        into.mismatches += from.mismatches;
+
+        // ranges are merged in index order, so ">" keeps the first index on ties
+        if (from.maxUlps > into.maxUlps)
+        {
+            into.maxUlps = from.maxUlps;
+            into.maxUlpsIndex = from.maxUlpsIndex;
+        }
+        into.maxAbsError = std::max(into.maxAbsError, from.maxAbsError);
+        into.maxRelError = std::max(into.maxRelError, from.maxRelError);
+
+        for (std::size_t i{ 0 }; i < UlpCompare::kHistogramSize; ++i)
+            into.histogram[i] += from.histogram[i];
+
+        for (std::size_t index : from.firstMismatches)
+        {
+            if (into.firstMismatches.size() >= maxReportedMismatches)
+                break;
+            into.firstMismatches.push_back(index);
+        }
+    }
+
+    template <typename T>
+    UlpCompare::Report compareImpl(std::span<const T> actual, std::span<const T> expected,
+                                   const UlpCompare::Tolerance& tolerance, const UlpCompare::Options& options)
+    {
+        if (actual.size() != expected.size())
+            throw std::invalid_argument{ "UlpCompare::compare: actual has " + std::to_string(actual.size()) + " elements, expected "
+                                         + std::to_string(expected.size()) };
+        const std::size_t count{ actual.size() };
+
+        // no point in giving a thread less than a chunk
+        const std::size_t threads{ std::min(static_cast<std::size_t>(std::max(1, options.threadCount)), count / kChunkSize + 1) };
+        std::vector<UlpCompare::Report> reports(threads);
+
+        auto work{ [&](std::size_t t) {
+            reports[t] = compareRange(actual.data(), expected.data(), t * count / threads, (t + 1) * count / threads,
+                                      tolerance, options.maxReportedMismatches);
+        } };
+
+        std::vector<std::thread> workers{};
+        for (std::size_t t{ 1 }; t < threads; ++t)
+            workers.emplace_back(work, t);
+        work(0);
+        for (auto& worker : workers)
+            worker.join();
+
+        UlpCompare::Report total{ std::move(reports[0]) };
+        for (std::size_t t{ 1 }; t < threads; ++t)
+            merge(total, reports[t], options.maxReportedMismatches);
+        return total;
+    }
+}
+
+namespace UlpCompare
+{
+    std::uint64_t ulpDistance(double a, double b) { return ulpDistanceImpl(a, b); }
+    std::uint64_t ulpDistance(float a, float b) { return ulpDistanceImpl(a, b); }
+
+    Report compare(std::span<const double> actual, std::span<const double> expected, const Tolerance& tolerance, const Options& options)
+    {
+        return compareImpl(actual, expected, tolerance, options);
+    }
+
+    Report compare(std::span<const float> actual, std::span<const float> expected, const Tolerance& tolerance, const Options& options)
+    {
+        return compareImpl(actual, expected, tolerance, options);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef ULP_COMPARE_H
+#define ULP_COMPARE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>     // C++20
+#include <vector>
+
+// Bulk comparison of computed results against reference results, for testing numeric kernels.
+// * An element matches if it is within maxUlps units in the last place, OR within absEpsilon,
+//   OR within relEpsilon of the larger magnitude (the approximatelyEqualAbsRel() rule from
+//   lessons/026-floating-point-comparisons, plus ULPs).
+// * compare() does not stop at the first mismatch: it reports the worst errors, a histogram of the
+//   ULP distances and the indices of the first mismatches.
+namespace UlpCompare
+{
+    struct Tolerance
+    {
+        std::uint64_t maxUlps{ 4 };
+        double absEpsilon{ 0.0 };
+        double relEpsilon{ 0.0 };
+        bool nanEqualsNan{ true }; // a NaN in both arrays counts as a match
+    };
+
+    // histogram[0] counts exact matches, histogram[k] counts ULP distances in [2^(k-1), 2^k)
+    inline constexpr std::size_t kHistogramSize{ 65 };
+
+    struct Report
+    {
+        std::size_t count{};
+        std::size_t mismatches{};
+
+        std::uint64_t maxUlps{};
+        std::size_t maxUlpsIndex{};
+        double maxAbsError{}; // infinity if a NaN mismatches (a NaN is infinitely far, as for ulpDistance)
+        double maxRelError{}; // over the elements beyond maxUlps only (the others are within ~maxUlps * epsilon)
+
+        std::array<std::size_t, kHistogramSize> histogram{};
+        std::vector<std::size_t> firstMismatches{}; // sorted, at most Options::maxReportedMismatches
+
+        bool passed() const { return mismatches == 0; }
+    };
+
+    struct Options
+    {
+        std::size_t maxReportedMismatches{ 10 };
+        int threadCount{ 1 };
+    };
+
+    // Distance between a and b in representable values: 0 if equal (0.0 and -0.0 are equal),
+    // 1 for neighbors, and so on across zero. NaN is infinitely far from everything (UINT64_MAX).
+    std::uint64_t ulpDistance(double a, double b);
+    std::uint64_t ulpDistance(float a, float b);
+
+    // Throws std::invalid_argument if actual and expected do not have the same size
+    Report compare(std::span<const double> actual, std::span<const double> expected, const Tolerance& tolerance, const Options& options = {});
+    Report compare(std::span<const float> actual, std::span<const float> expected, const Tolerance& tolerance, const Options& options = {});
+}
+
+#endif
@@ -0,0 +1,189 @@
+/* Comparing whole arrays of floating point results
+
+- lessons/026-floating-point-comparisons compares one pair of doubles with approximatelyEqualAbsRel().
+- When testing an optimized kernel (SIMD, reordered sums, fused multiply-add...) against a reference,
+  we compare millions of values, and "equal or not" is not enough information:
+  + how far off is the worst element, and where is it?
+  + is the error spread evenly (rounding) or concentrated in a few elements (a bug)?
+
+ULPs (units in the last place)
+- The distance between two doubles counted in representable values in between.
+  1 ULP means "neighbors": the smallest possible difference, whatever the magnitude.
+- A relative epsilon is roughly "ULPs scaled by 2^52", but ULPs stay meaningful for subnormals,
+  and tell you directly how many bits were lost: 2^k ULPs = k bits.
+- ULPs are useless near zero (0.0 and 1e-300 are ~2^62 ULPs apart), so an absolute epsilon is still needed there.
+*/
+
+#include "UlpCompare.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+// From lessons/026-floating-point-comparisons
+bool approximatelyEqualRel(double a, double b, double relEpsilon)
+{
+    return (std::abs(a - b) <= (std::max(std::abs(a), std::abs(b)) * relEpsilon));
+}
+
+bool approximatelyEqualAbsRel(double a, double b, double absEpsilon, double relEpsilon)
+{
+    if (std::abs(a - b) <= absEpsilon)
+        return true;
+
+    return approximatelyEqualRel(a, b, relEpsilon);
+}
+
+void printReport(const UlpCompare::Report& report)
+{
+    std::cout << (report.passed() ? "PASSED" : "FAILED") << ": " << report.mismatches << " of " << report.count << " mismatch\n"
+              << "  max " << report.maxUlps << " ulps at index " << report.maxUlpsIndex
+              << ", max abs error " << report.maxAbsError << ", max rel error " << report.maxRelError << '\n';
+
+    std::cout << "  ulp histogram:";
+    for (std::size_t k{ 0 }; k < UlpCompare::kHistogramSize; ++k)
+    {
+        if (report.histogram[k] == 0)
+            continue;
+        if (k == 0)
+            std::cout << " [0]=" << report.histogram[k];
+        else
+            std::cout << " [2^" << k - 1 << ",2^" << k << ")=" << report.histogram[k];
+    }
+    std::cout << '\n';
+
+    if (!report.firstMismatches.empty())
+    {
+        std::cout << "  first mismatches:";
+        for (std::size_t index : report.firstMismatches)
+            std::cout << ' ' << index;
+        std::cout << '\n';
+    }
+}
+
+bool examples()
+{
+    const double one{ 1.0 };
+    bool ok{ UlpCompare::ulpDistance(one, std::nextafter(one, 2.0)) == 1
+             && UlpCompare::ulpDistance(0.0, -0.0) == 0
+             && UlpCompare::ulpDistance(std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min()) == 2
+             && UlpCompare::ulpDistance(one, std::numeric_limits<double>::quiet_NaN()) == std::numeric_limits<std::uint64_t>::max()
+             && UlpCompare::ulpDistance(1.0f, std::nextafter(1.0f, 0.0f)) == 1 };
+
+    // 0.1 summed ten times vs 1.0: too far for approximatelyEqualRel(.., 1e-16), 1 ulp
+    constexpr double a{ 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 + 0.1 };
+    std::cout << "0.1 * 10 vs 1.0: " << UlpCompare::ulpDistance(a, 1.0) << " ulp\n";
+
+    const std::vector<double> expected{ 1.0, 2.0, 0.0, 1e-300, std::numeric_limits<double>::quiet_NaN(), 5.0 };
+    const std::vector<double> actual{ 1.0, std::nextafter(2.0, 3.0), 1e-20, 0.0, std::numeric_limits<double>::quiet_NaN(), 5.5 };
+
+    UlpCompare::Tolerance tolerance{};
+    tolerance.maxUlps = 2;
+    tolerance.absEpsilon = 1e-12; // needed for the values near zero
+    const auto report{ UlpCompare::compare(actual, expected, tolerance) };
+    printReport(report);
+
+    ok = ok && report.mismatches == 1 && report.firstMismatches.size() == 1 && report.firstMismatches[0] == 5
+         && report.histogram[0] == 2 && report.histogram[1] == 1;
+    return ok;
+}
+
+
+/* Benchmark
+
+- A "kernel" result that differs from the reference by 0 to 3 ulps, plus a few real bugs.
+- Baseline: a loop calling approximatelyEqualAbsRel() for each pair, which only gives pass/fail.
+- UlpCompare::compare computes the distances 2 doubles at a time, and counts the histogram of
+  chunks of small distances with vector compares: it is faster than the loop while reporting more.
+*/
+
+template <typename F>
+double measureSeconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937_64 rng{ 3 };
+    std::uniform_real_distribution<double> dist{ -1e6, 1e6 };
+    std::uniform_int_distribution noise{ -3, 3 };
+
+    std::vector<double> expected(count);
+    std::vector<double> actual(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        expected[i] = dist(rng);
+        double x{ expected[i] };
+        for (int n{ noise(rng) }; n != 0; n += (n > 0) ? -1 : 1)
+            x = std::nextafter(x, (n > 0) ? INFINITY : -INFINITY);
+        actual[i] = x;
+    }
+    actual[count / 3] *= 1.001; // the bugs
+    actual[count / 2] = -actual[count / 2];
+
+    std::size_t baselineMismatches{ 0 };
+    const double baselineSeconds{ measureSeconds([&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+            baselineMismatches += !approximatelyEqualAbsRel(actual[i], expected[i], 1e-12, 1e-15);
+    }) };
+
+    UlpCompare::Tolerance tolerance{};
+    tolerance.maxUlps = 4;
+    tolerance.absEpsilon = 1e-12;
+
+    UlpCompare::Report report{};
+    const double seconds{ measureSeconds([&] { report = UlpCompare::compare(actual, expected, tolerance); }) };
+
+    UlpCompare::Options options{};
+    options.threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    UlpCompare::Report parallelReport{};
+    const double parallelSeconds{ measureSeconds([&] { parallelReport = UlpCompare::compare(actual, expected, tolerance, options); }) };
+
+    printReport(report);
+
+    auto rate{ [count](double s) { return static_cast<double>(count) / s / 1e9; } };
+    std::cout << std::setprecision(3)
+              << "approximatelyEqualAbsRel loop: " << rate(baselineSeconds) << " G values/s (" << baselineMismatches << " mismatches, no details)\n"
+              << "UlpCompare::compare: " << rate(seconds) << " G values/s (" << baselineSeconds / seconds << "x the loop), "
+              << rate(parallelSeconds) << " G values/s with " << options.threadCount << " threads\n";
+
+    return report.mismatches == 2 && parallelReport.mismatches == 2 && parallelReport.firstMismatches == report.firstMismatches
+           && parallelReport.histogram == report.histogram;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 20000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Pick the tolerance from the algorithm, not by trial and error: a reordered sum of n terms can be
+  off by ~n ulps, a polynomial approximation by its documented bound.
+- Compare against a reference computed in higher precision (long double, or a trusted library)
+  when possible, otherwise you are measuring the error of the reference too.
+- A growing histogram tail after a change usually means lost precision; a single huge outlier usually means a bug.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/relational-operators-and-floating-point-comparisons/
+- https://randomascii.wordpress.com/2012/02/25/comparing-floating-point-numbers-2012-edition/
+- https://en.wikipedia.org/wiki/Unit_in_the_last_place
+*/
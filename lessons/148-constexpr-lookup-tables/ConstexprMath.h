@@ -0,0 +1,284 @@
+#ifndef CONSTEXPR_MATH_H
+#define CONSTEXPR_MATH_H
+
+#include <array>
+#include <bit>        // for std::bit_cast (constexpr since C++20)
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Requires C++20.
+// * ConstexprMath: <cmath>-like functions that can run at compile time (std::sin & co are not constexpr
+//   until C++26), used to fill lookup tables.
+// * LookupTable: samples of a function on [lo, hi], filled at compile time, read with linear interpolation.
+// * maxTableError(): a consteval check of a table against its reference function, for static_assert.
+namespace ConstexprMath
+{
+    inline constexpr double pi{ 3.14159265358979323846 };
+    inline constexpr double ln2{ 0.69314718055994530942 };
+
+    constexpr double abs(double x)
+    {
+        return (x < 0.0) ? -x : x;
+    }
+
+    // Newton's method. x must be >= 0.
+    constexpr double sqrt(double x)
+    {
+        if (x == 0.0)
+            return 0.0;
+
+        double guess{ (x > 1.0) ? x : 1.0 };
+        for (int i{ 0 }; i < 1100; ++i) // the guess at least halves until it is close, then converges quadratically
+        {
+            const double next{ 0.5 * (guess + x / guess) };
+            if (next >= guess)
+                break;
+            guess = next;
+        }
+        return guess;
+    }
+
+    // Reduces x to [-pi/2, pi/2] and sums the Taylor series. Accurate to ~1e-15 for |x| < 1e6.
+    constexpr double sin(double x)
+    {
+        const auto turns{ static_cast<long long>(x / (2.0 * pi)) };
+        x -= static_cast<double>(turns) * 2.0 * pi;   // [-2pi, 2pi]
+        if (x > pi)
+            x -= 2.0 * pi;
+        if (x < -pi)
+            x += 2.0 * pi;                             // [-pi, pi]
+        if (x > pi / 2)
+            x = pi - x;
+        if (x < -pi / 2)
+            x = -pi - x;                               // [-pi/2, pi/2], sin(pi - x) == sin(x)
+
+        double term{ x };
+        double sum{ x };
+        for (int n{ 1 }; n < 15; ++n)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    constexpr double cos(double x)
+    {
+        return sin(x + pi / 2);
+    }
+
+    // x must be > 0. x = m * 2^e with m in [1, 2), ln(m) = 2 * atanh((m - 1) / (m + 1)).
+    constexpr double log(double x)
+    {
+        int e{ 0 };
+        while (x >= 2.0)
+        {
+            x /= 2.0;
+            ++e;
+        }
+        while (x < 1.0)
+        {
+            x *= 2.0;
+            --e;
+        }
+
+        const double y{ (x - 1.0) / (x + 1.0) }; // [0, 1/3)
+        double term{ y };
+        double sum{ 0.0 };
+        for (int n{ 1 }; n < 60; n += 2)
+        {
+            sum += term / n;
+            term *= y * y;
+        }
+        return 2.0 * sum + e * ln2;
+    }
+
+    template <std::size_t N>
+    struct LookupTable
+    {
+        double lo{};
+        double hi{};
+        double invStep{};
+        std::array<double, N + 1> values{};
+
+        // Linear interpolation between the two nearest samples; x is clamped to [lo, hi].
+        constexpr double operator()(double x) const
+        {
+            double t{ (x - lo) * invStep };
+            if (t < 0.0)
+                t = 0.0;
+            if (t > static_cast<double>(N))
+                t = static_cast<double>(N);
+
+            auto i{ static_cast<std::size_t>(t) };
+            if (i == N)
+                i = N - 1;
+            const double fraction{ t - static_cast<double>(i) };
+            return values[i] + fraction * (values[i + 1] - values[i]);
+        }
+    };
+
+    // N intervals, N + 1 samples: f(lo), ..., f(hi)
+    template <std::size_t N, typename F>
+    constexpr LookupTable<N> makeTable(F f, double lo, double hi)
+    {
+        static_assert(N > 0);
+        LookupTable<N> table{ lo, hi, static_cast<double>(N) / (hi - lo), {} };
+        for (std::size_t i{ 0 }; i <= N; ++i)
+            table.values[i] = f(lo + (hi - lo) * static_cast<double>(i) / static_cast<double>(N));
+        return table;
+    }
+
+    // Largest |table(x) - reference(x)| over samplesPerInterval points in every interval (including the midpoints,
+    // where linear interpolation is worst). consteval: can only run at compile time, so it costs nothing at runtime.
+    template <std::size_t N, typename F>
+    consteval double maxTableError(const LookupTable<N>& table, F reference, int samplesPerInterval = 4)
+    {
+        double maxError{ 0.0 };
+        const double step{ (table.hi - table.lo) / static_cast<double>(N) };
+        for (std::size_t i{ 0 }; i < N; ++i)
+        {
+            for (int s{ 0 }; s <= samplesPerInterval; ++s)
+            {
+                const double x{ table.lo + step * (static_cast<double>(i) + static_cast<double>(s) / samplesPerInterval) };
+                const double error{ abs(table(x) - reference(x)) };
+                maxError = (error > maxError) ? error : maxError;
+            }
+        }
+        return maxError;
+    }
+
+
+    /* Table-based approximations
+
+    - sin/cos: one period [0, 2pi] in 2048 intervals (16 KiB). Linear interpolation error <= h^2/8 * max|sin''| ~ 1.2e-6.
+    - sqrt/log: the exponent is handled exactly with bit manipulation, the table only covers the
+      mantissa range ([1, 4) for sqrt, [1, 2) for log).
+    */
+
+    inline constexpr auto sinTable{ makeTable<2048>([](double x) { return sin(x); }, 0.0, 2.0 * pi) };
+    inline constexpr auto sqrtTable{ makeTable<1024>([](double x) { return sqrt(x); }, 1.0, 4.0) };
+    inline constexpr auto logTable{ makeTable<1024>([](double x) { return log(x); }, 1.0, 2.0) };
+
+    constexpr double fastSin(double x)
+    {
+        constexpr double twoPi{ 2.0 * pi };
+        double turns{ static_cast<double>(static_cast<long long>(x / twoPi)) };
+        double reduced{ x - turns * twoPi };
+        if (reduced < 0.0)
+            reduced += twoPi;
+        return sinTable(reduced);
+    }
+
+    constexpr double fastCos(double x)
+    {
+        return fastSin(x + pi / 2);
+    }
+
+    // x must be finite and > 0 (normal, not subnormal)
+    constexpr double fastSqrt(double x)
+    {
+        const auto bits{ std::bit_cast<std::uint64_t>(x) };
+        int exponent{ static_cast<int>(bits >> 52) - 1023 };
+        double mantissa{ std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull) }; // [1, 2)
+        if (exponent % 2 != 0) // sqrt(m * 2^e) = sqrt(2m) * 2^((e - 1) / 2) for odd e
+        {
+            mantissa *= 2.0;
+            --exponent;
+        }
+        const auto scale{ std::bit_cast<double>(static_cast<std::uint64_t>(exponent / 2 + 1023) << 52) };
+        return sqrtTable(mantissa) * scale;
+    }
+
+    // x must be finite and > 0 (normal, not subnormal)
+    constexpr double fastLog(double x)
+    {
+        const auto bits{ std::bit_cast<std::uint64_t>(x) };
+        const int exponent{ static_cast<int>(bits >> 52) - 1023 };
+        const double mantissa{ std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull) };
+        return logTable(mantissa) + exponent * ln2;
+    }
+
+    // The generators, against values computed independently to 20 digits (not with ConstexprMath, not with <cmath>)
+    static_assert(abs(sin(1.0) - 0.84147098480789650665) < 1e-15 && abs(sin(2.5) - 0.59847214410395649405) < 1e-15
+                  && abs(sin(-0.5) + 0.47942553860420300027) < 1e-15 && abs(sin(6.0) + 0.27941549819892587281) < 1e-15);
+    static_assert(abs(sqrt(2.0) - 1.41421356237309504880) < 1e-15 && abs(sqrt(3.0) - 1.73205080756887729353) < 1e-15
+                  && abs(sqrt(0.5) - 0.70710678118654752440) < 1e-15);
+    static_assert(abs(log(10.0) - 2.30258509299404568402) < 1e-15 && abs(log(3.0) - 1.09861228866810969140) < 1e-15
+                  && abs(log(1.5) - 0.40546510810816438198) < 1e-15);
+
+    // The interpolation error, against the generators (accurate to ~1e-15, as checked above): verified by the
+    // compiler. Change a table size and the build tells you if it is still good enough.
+    static_assert(maxTableError(sinTable, [](double x) { return sin(x); }) < 1.3e-6);
+    static_assert(maxTableError(sqrtTable, [](double x) { return sqrt(x); }) < 3e-7);
+    static_assert(maxTableError(logTable, [](double x) { return log(x); }) < 1.2e-7);
+}
+
+namespace Tables
+{
+    // CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320): the CRC of every possible byte
+    constexpr std::array<std::uint32_t, 256> makeCrc32Table()
+    {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t byte{ 0 }; byte < 256; ++byte)
+        {
+            std::uint32_t crc{ byte };
+            for (int bit{ 0 }; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            table[byte] = crc;
+        }
+        return table;
+    }
+
+    inline constexpr auto crc32Table{ makeCrc32Table() };
+
+    constexpr std::uint32_t crc32(std::string_view data)
+    {
+        std::uint32_t crc{ 0xFFFFFFFFu };
+        for (char ch : data)
+            crc = crc32Table[(crc ^ static_cast<unsigned char>(ch)) & 0xFFu] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    // The same computation without the table, one bit at a time
+    constexpr std::uint32_t crc32Bitwise(std::string_view data)
+    {
+        std::uint32_t crc{ 0xFFFFFFFFu };
+        for (char ch : data)
+        {
+            crc ^= static_cast<unsigned char>(ch);
+            for (int bit{ 0 }; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        return ~crc;
+    }
+
+    static_assert(crc32("123456789") == 0xCBF43926u); // the standard check value
+    static_assert(crc32("hello") == crc32Bitwise("hello"));
+
+    constexpr std::array<std::uint8_t, 256> makePopcountTable()
+    {
+        std::array<std::uint8_t, 256> table{};
+        for (std::size_t i{ 1 }; i < 256; ++i)
+            table[i] = static_cast<std::uint8_t>((i & 1) + table[i / 2]);
+        return table;
+    }
+
+    inline constexpr auto popcountTable{ makePopcountTable() };
+
+    constexpr int popcount(std::uint64_t x)
+    {
+        int count{ 0 };
+        for (int byte{ 0 }; byte < 8; ++byte)
+        {
+            count += popcountTable[x & 0xFF];
+            x >>= 8;
+        }
+        return count;
+    }
+
+    static_assert(popcount(0) == 0 && popcount(0xFF) == 8 && popcount(~std::uint64_t{ 0 }) == 64);
+}
+
+#endif
@@ -0,0 +1,161 @@
+/* Compile-time lookup tables
+
+- lessons/052-constexpr-functions (calcCircumference2), lessons/053-consteval (greater) and
+  lessons/050-nontype-template-parameters (getSqrt) evaluate tiny functions at compile time.
+- The same tools scale up to whole tables: a constexpr function can loop and fill a std::array,
+  and a constexpr variable initialized with it is computed by the compiler and stored in the executable.
+  => No startup cost, no "is the table initialized yet?" check, and the table can live in read-only memory.
+
+- Typical tables: CRC and hash tables, bit tricks (popcount, bit reversal), approximations of expensive functions.
+- The functions used to *fill* a table must be constexpr too. std::sin, std::sqrt and std::log are not
+  (until C++26), so ConstexprMath provides simple, slow, accurate versions: they only run at compile time.
+*/
+
+/* Checking error bounds at compile time
+
+- A consteval function must be evaluated at compile time, so it can do expensive checks for free.
+- maxTableError() compares a table with its reference function, and a static_assert turns
+  "the table is accurate to 1.3e-6" from a comment into something the compiler verifies
+  every time the table size or the interpolation changes.
+- The reference is the ConstexprMath function that filled the table: that only measures the
+  interpolation. The functions themselves are checked against hard-coded digits, computed elsewhere.
+*/
+
+#include "ConstexprMath.h"
+
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// calcCircumference2 from lessons/052-constexpr-functions, now with a more precise pi
+constexpr double calcCircumference2(double radius)
+{
+    return 2.0 * ConstexprMath::pi * radius;
+}
+
+void examples()
+{
+    constexpr double circumference{ calcCircumference2(3.0) };
+    constexpr double root{ ConstexprMath::sqrt(2.0) };           // compile time
+    constexpr double sine{ ConstexprMath::fastSin(1.0) };        // compile time, through the table
+    constexpr std::uint32_t crc{ Tables::crc32("hello world") }; // compile time
+
+    std::cout << std::setprecision(10) << circumference << ' ' << root << ' ' << sine << " (std::sin: " << std::sin(1.0) << ")\n";
+    std::cout << std::hex << crc << std::dec << '\n';
+}
+
+bool verifyAtRuntime()
+{
+    // The static_asserts checked the tables against ConstexprMath; check them against <cmath> too.
+    std::mt19937_64 rng{ 5 };
+    std::uniform_real_distribution<double> angle{ -100.0, 100.0 };
+    std::uniform_real_distribution<double> exponent{ -30.0, 30.0 };
+
+    double maxSinError{ 0.0 };
+    double maxSqrtError{ 0.0 };
+    double maxLogError{ 0.0 };
+    for (int i{ 0 }; i < 100000; ++i)
+    {
+        const double a{ angle(rng) };
+        const double x{ std::pow(10.0, exponent(rng)) };
+        maxSinError = std::max(maxSinError, std::abs(ConstexprMath::fastSin(a) - std::sin(a)));
+        maxSqrtError = std::max(maxSqrtError, std::abs(ConstexprMath::fastSqrt(x) - std::sqrt(x)) / std::sqrt(x));
+        maxLogError = std::max(maxLogError, std::abs(ConstexprMath::fastLog(x) - std::log(x)));
+    }
+    std::cout << "max error: sin " << maxSinError << ", sqrt (relative) " << maxSqrtError << ", log " << maxLogError << '\n';
+
+    bool ok{ maxSinError < 1.3e-6 && maxSqrtError < 3e-7 && maxLogError < 1.2e-7 };
+    for (std::uint64_t x : { 0ull, 1ull, 0xF0F0ull, 0x8000000000000001ull, ~0ull })
+        ok = ok && Tables::popcount(x) == std::popcount(x);
+    return ok;
+}
+
+
+/* Benchmark
+
+- Table lookups are not automatically faster: they trade arithmetic for memory accesses.
+  They win when the function is expensive (sin, log) and the table stays in the L1/L2 cache.
+- std::sqrt is a single CPU instruction: a table cannot beat it.
+- The CRC table replaces 8 shift/xor steps per byte with one lookup.
+*/
+
+template <typename F>
+double nsPerCall(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+void benchmark()
+{
+    constexpr std::size_t count{ 10000000 };
+    std::mt19937_64 rng{ 9 };
+    std::uniform_real_distribution<double> dist{ 0.001, 1000.0 };
+    std::vector<double> inputs(count);
+    for (double& x : inputs)
+        x = dist(rng);
+
+    double sink{ 0.0 };
+    auto compare{ [&](const char* name, auto reference, auto table) {
+        const double a{ nsPerCall(count, [&] { for (double x : inputs) sink += reference(x); }) };
+        const double b{ nsPerCall(count, [&] { for (double x : inputs) sink += table(x); }) };
+        std::cout << std::setw(8) << name << ": <cmath> " << a << " ns, table " << b << " ns\n";
+    } };
+
+    std::cout << std::setprecision(3);
+    compare("sin", [](double x) { return std::sin(x); }, [](double x) { return ConstexprMath::fastSin(x); });
+    compare("cos", [](double x) { return std::cos(x); }, [](double x) { return ConstexprMath::fastCos(x); });
+    compare("sqrt", [](double x) { return std::sqrt(x); }, [](double x) { return ConstexprMath::fastSqrt(x); });
+    compare("log", [](double x) { return std::log(x); }, [](double x) { return ConstexprMath::fastLog(x); });
+
+    std::string data(count, '\0');
+    for (char& ch : data)
+        ch = static_cast<char>(rng());
+    std::uint32_t crc{ 0 };
+    const double bitwise{ nsPerCall(count, [&] { crc ^= Tables::crc32Bitwise(data); }) };
+    const double table{ nsPerCall(count, [&] { crc ^= Tables::crc32(data); }) };
+    std::cout << "   crc32: bitwise " << bitwise << " ns/byte, table " << table << " ns/byte\n";
+
+    std::uint64_t bits{ 0 };
+    const double popcountTable{ nsPerCall(count, [&] { for (double x : inputs) bits += static_cast<std::uint64_t>(Tables::popcount(std::bit_cast<std::uint64_t>(x))); }) };
+    const double popcountStd{ nsPerCall(count, [&] { for (double x : inputs) bits += static_cast<std::uint64_t>(std::popcount(std::bit_cast<std::uint64_t>(x))); }) };
+    std::cout << "popcount: table " << popcountTable << " ns, std::popcount " << popcountStd << " ns\n";
+
+    std::cout << "(checksum " << sink << ' ' << crc << ' ' << bits << ")\n";
+}
+
+int main()
+{
+    examples();
+
+    const bool ok{ verifyAtRuntime() };
+    benchmark();
+
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Big constexpr tables increase compile time. GCC and Clang limit the work done in one constant evaluation
+  (-fconstexpr-ops-limit, -fconstexpr-steps): split the work or raise the limit if you hit it.
+- std::popcount compiles to a single instruction when the target has one (-mpopcnt, or -march=native);
+  otherwise to a few bit tricks. Either way it beats a byte table.
+- Linear interpolation error shrinks with the square of the interval width: twice as many samples, 4x less error.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/constexpr-functions/
+- https://www.learncpp.com/cpp-tutorial/consteval-functions/
+- https://en.cppreference.com/w/cpp/numeric/bit_cast
+- https://en.wikipedia.org/wiki/Cyclic_redundancy_check
+*/
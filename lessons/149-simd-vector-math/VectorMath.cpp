@@ -0,0 +1,210 @@
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>      // for std::bit_cast (C++20)
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTOR_MATH_X86
+#include <immintrin.h>
+#endif
+
+/* One kernel source, several instruction sets
+
+- VectorMathKernels.inl is written once against a vector type "Double" and is included once per instruction set.
+- "#pragma GCC target" compiles the functions of a region for an instruction set the rest of the program
+  does not assume (compiling everything with -mavx2 would crash on CPUs without AVX2). They are only
+  called after checking the CPU at runtime.
+- GCC vector types (__m256d is "4 doubles") support +, -, *, /, comparisons and ?: lane by lane,
+  so most of the kernel code reads like scalar code. Intrinsics are only needed for fma and sqrt.
+*/
+
+#ifdef VECTOR_MATH_X86
+
+namespace Sse2 // part of x86-64: no pragma needed
+{
+    using Double = __m128d;
+
+    inline Double mulAdd(Double a, Double b, Double c) { return a * b + c; }
+    inline Double sqrtVector(Double x) { return _mm_sqrt_pd(x); }
+
+#include "VectorMathKernels.inl"
+}
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace Avx2
+{
+    using Double = __m256d;
+
+    inline Double mulAdd(Double a, Double b, Double c) { return _mm256_fmadd_pd(a, b, c); }
+    inline Double sqrtVector(Double x) { return _mm256_sqrt_pd(x); }
+
+#include "VectorMathKernels.inl"
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace Avx512
+{
+    using Double = __m512d;
+
+    inline Double mulAdd(Double a, Double b, Double c) { return _mm512_fmadd_pd(a, b, c); }
+    // the masked form (all lanes) because _mm512_sqrt_pd trips -Wmaybe-uninitialized in GCC 12
+    inline Double sqrtVector(Double x) { return _mm512_mask_sqrt_pd(x, 0xFF, x); }
+
+#include "VectorMathKernels.inl"
+}
+#pragma GCC pop_options
+
+#else
+
+namespace Generic // GCC lowers the vector operations to whatever the target has
+{
+    using Double = double __attribute__((vector_size(16)));
+
+    inline Double mulAdd(Double a, Double b, Double c) { return a * b + c; }
+
+    inline Double sqrtVector(Double x)
+    {
+        for (int i{ 0 }; i < 2; ++i)
+            x[i] = std::sqrt(x[i]);
+        return x;
+    }
+
+#include "VectorMathKernels.inl"
+}
+
+#endif
+
+namespace
+{
+    using Function = void (*)(const double* input, double* output, std::size_t count);
+
+    struct Functions
+    {
+        Function exp;
+        Function log;
+        Function sin;
+        Function cos;
+        Function sqrt;
+    };
+
+    bool isSupported(VectorMath::Isa isa)
+    {
+#ifdef VECTOR_MATH_X86
+        __builtin_cpu_init(); // needed when called during static initialization, before the runtime sets the flags
+        switch (isa)
+        {
+        case VectorMath::Isa::sse2:   return true;
+        case VectorMath::Isa::avx2:   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case VectorMath::Isa::avx512: return __builtin_cpu_supports("avx512f");
+        default:                      return false;
+        }
+#else
+        return isa == VectorMath::Isa::generic;
+#endif
+    }
+
+    Functions functionsFor(VectorMath::Isa isa)
+    {
+#ifdef VECTOR_MATH_X86
+        switch (isa)
+        {
+        case VectorMath::Isa::avx512: return { Avx512::exp, Avx512::log, Avx512::sin, Avx512::cos, Avx512::sqrt };
+        case VectorMath::Isa::avx2:   return { Avx2::exp, Avx2::log, Avx2::sin, Avx2::cos, Avx2::sqrt };
+        default:                      return { Sse2::exp, Sse2::log, Sse2::sin, Sse2::cos, Sse2::sqrt };
+        }
+#else
+        (void)isa;
+        return { Generic::exp, Generic::log, Generic::sin, Generic::cos, Generic::sqrt };
+#endif
+    }
+
+    // Chosen once, during static initialization: every call afterwards is one indirect call per span, not per element
+    VectorMath::Isa g_isa{ VectorMath::bestIsa() };
+    Functions g_functions{ functionsFor(g_isa) };
+
+    void apply(Function function, std::span<const double> input, std::span<double> output)
+    {
+        assert(input.size() == output.size());
+        function(input.data(), output.data(), std::min(input.size(), output.size()));
+    }
+
+    // float: convert blocks to double on the stack, run the double kernel, round back
+    void apply(Function function, std::span<const float> input, std::span<float> output)
+    {
+        assert(input.size() == output.size());
+        const std::size_t count{ std::min(input.size(), output.size()) };
+
+        constexpr std::size_t kBlockSize{ 256 };
+        double buffer[kBlockSize];
+        for (std::size_t first{ 0 }; first < count; first += kBlockSize)
+        {
+            const std::size_t size{ std::min(kBlockSize, count - first) };
+            std::copy_n(input.data() + first, size, buffer);
+            function(buffer, buffer, size);
+            std::transform(buffer, buffer + size, output.data() + first, [](double x) { return static_cast<float>(x); });
+        }
+    }
+}
+
+namespace VectorMath
+{
+    const char* isaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::generic: return "generic";
+        case Isa::sse2:    return "SSE2";
+        case Isa::avx2:    return "AVX2";
+        case Isa::avx512:  return "AVX-512";
+        default:           return "???";
+        }
+    }
+
+    Isa bestIsa()
+    {
+        for (Isa isa : { Isa::avx512, Isa::avx2, Isa::sse2 })
+        {
+            if (isSupported(isa))
+                return isa;
+        }
+        return Isa::generic;
+    }
+
+    Isa activeIsa()
+    {
+        return g_isa;
+    }
+
+    bool setIsa(Isa isa)
+    {
+        if (!isSupported(isa))
+            return false;
+
+        g_isa = isa;
+        g_functions = functionsFor(isa);
+        return true;
+    }
+
+    void exp(std::span<const double> input, std::span<double> output) { apply(g_functions.exp, input, output); }
+    void log(std::span<const double> input, std::span<double> output) { apply(g_functions.log, input, output); }
+    void sin(std::span<const double> input, std::span<double> output) { apply(g_functions.sin, input, output); }
+    void cos(std::span<const double> input, std::span<double> output) { apply(g_functions.cos, input, output); }
+    void sqrt(std::span<const double> input, std::span<double> output) { apply(g_functions.sqrt, input, output); }
+
+    void exp(std::span<const float> input, std::span<float> output) { apply(g_functions.exp, input, output); }
+    void log(std::span<const float> input, std::span<float> output) { apply(g_functions.log, input, output); }
+    void sin(std::span<const float> input, std::span<float> output) { apply(g_functions.sin, input, output); }
+    void cos(std::span<const float> input, std::span<float> output) { apply(g_functions.cos, input, output); }
+    void sqrt(std::span<const float> input, std::span<float> output) { apply(g_functions.sqrt, input, output); }
+}
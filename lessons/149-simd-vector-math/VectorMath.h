@@ -0,0 +1,48 @@
+#ifndef VECTOR_MATH_H
+#define VECTOR_MATH_H
+
+#include <span>     // C++20
+
+// Array-at-a-time exp, log, sin, cos and sqrt, computed with SIMD instructions.
+// * The best instruction set supported by the CPU (SSE2, AVX2 + FMA or AVX-512) is picked at runtime,
+//   so the same executable runs everywhere and uses what the machine has.
+// * Maximum error, measured against <cmath> (itself within 1 ulp of the exact result):
+//   exp 2 ulps (subnormal results included), log 2 ulps, sqrt 0 ulps (correctly rounded),
+//   sin/cos 2 ulps for |x| <= 1e5 (larger arguments are reduced less precisely).
+// * Special values follow <cmath>: exp(inf) == inf, log(0) == -inf, log(x < 0) is NaN, sin(inf) is NaN...
+// * input and output must have the same size; they may be the same span (in-place).
+// * float versions convert to double, run the double kernel and round the results: correctly rounded in
+//   almost all cases, but no faster than the double versions (there are no float kernels).
+namespace VectorMath
+{
+    enum class Isa
+    {
+        generic, // plain C++ (not an x86 CPU)
+        sse2,
+        avx2,    // AVX2 + FMA
+        avx512,  // AVX-512F
+    };
+
+    const char* isaName(Isa isa);
+
+    Isa bestIsa();   // the best instruction set this CPU supports
+    Isa activeIsa(); // the instruction set used by the functions below (bestIsa() unless changed)
+
+    // For testing and benchmarking. Returns false (and changes nothing) if the CPU does not support isa.
+    // Not thread-safe: call it before other threads use VectorMath.
+    bool setIsa(Isa isa);
+
+    void exp(std::span<const double> input, std::span<double> output);
+    void log(std::span<const double> input, std::span<double> output);
+    void sin(std::span<const double> input, std::span<double> output);
+    void cos(std::span<const double> input, std::span<double> output);
+    void sqrt(std::span<const double> input, std::span<double> output);
+
+    void exp(std::span<const float> input, std::span<float> output);
+    void log(std::span<const float> input, std::span<float> output);
+    void sin(std::span<const float> input, std::span<float> output);
+    void cos(std::span<const float> input, std::span<float> output);
+    void sqrt(std::span<const float> input, std::span<float> output);
+}
+
+#endif
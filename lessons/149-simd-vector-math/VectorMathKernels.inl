@@ -0,0 +1,213 @@
+// Vector kernels for VectorMath.cpp. This file is included once per instruction set, inside a namespace
+// (and a "#pragma GCC target" region) that defines:
+// * Double: a GCC vector of doubles (__m128d, __m256d or __m512d), used with the normal operators
+// * mulAdd(a, b, c): a * b + c, fused when the instruction set has FMA
+// * sqrtVector(x): correctly rounded square root
+// No include guard: it is meant to be compiled several times, with different Double types.
+
+// The type of a vector comparison: 64-bit integer lanes, all bits set where the comparison is true
+using Int = decltype(Double{} < Double{});
+
+inline constexpr std::size_t kWidth{ sizeof(Double) / sizeof(double) };
+
+inline Double load(const double* p)
+{
+    Double v;
+    std::memcpy(&v, p, sizeof(v)); // unaligned load
+    return v;
+}
+
+inline void store(double* p, Double v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// std::bit_cast is defined outside the target region: a call with AVX vectors would not be compiled for AVX
+template <typename To, typename From>
+To bitCast(From from)
+{
+    To to;
+    std::memcpy(&to, &from, sizeof(to));
+    return to;
+}
+
+inline Double broadcast(double x)
+{
+    return Double{} + x;
+}
+
+// Adding 1.5 * 2^52 rounds x to an integer and leaves that integer in the low mantissa bits. |x| < 2^51.
+inline constexpr double kShifter{ 0x1.8p52 };
+
+inline Double roundToInt(Double x, Int& k)
+{
+    const Double shifted{ x + kShifter };
+    k = bitCast<Int>(shifted) - std::bit_cast<std::int64_t>(kShifter);
+    return shifted - kShifter;
+}
+
+inline Double toDouble(Int k) // |k| < 2^51
+{
+    return bitCast<Double>(k + std::bit_cast<std::int64_t>(kShifter)) - kShifter;
+}
+
+// 2^k for k in [-1022, 1023]
+inline Double pow2(Int k)
+{
+    return bitCast<Double>((k + 1023) << 52);
+}
+
+// Horner's rule, highest coefficient first
+template <std::size_t N>
+Double polynomial(Double x, const std::array<double, N>& coefficients)
+{
+    Double p{ broadcast(coefficients[0]) };
+    for (std::size_t i{ 1 }; i < N; ++i)
+        p = mulAdd(p, x, broadcast(coefficients[i]));
+    return p;
+}
+
+
+/* exp(x) = 2^k * exp(r)
+
+- k = round(x / ln2), r = x - k * ln2 in [-ln2/2, ln2/2]. ln2 is split in two parts (Cody-Waite):
+  ln2Hi has trailing zero bits, so k * ln2Hi is exact and the subtraction loses nothing.
+- exp(r) is the Taylor series up to r^13: the truncation error is below 1e-17 on that interval.
+*/
+inline Double expVector(Double x)
+{
+    constexpr double kLog2e{ 1.4426950408889634 };
+    constexpr double kLn2Hi{ 6.93147180369123816490e-01 };
+    constexpr double kLn2Lo{ 1.90821492927058770002e-10 };
+    constexpr double kOverflow{ 709.782712893383973096 };   // log(DBL_MAX)
+    constexpr double kUnderflow{ -746.0 }; // exp(-745.14) is half the smallest subnormal: below, the result rounds to 0
+    constexpr std::array<double, 14> kCoefficients{ 1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0,
+                                                    1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0,
+                                                    1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0 };
+
+    Int k{};
+    const Double kd{ roundToInt(x * kLog2e, k) };
+    const Double r{ mulAdd(kd, broadcast(-kLn2Lo), mulAdd(kd, broadcast(-kLn2Hi), x)) };
+    const Double p{ polynomial(r, kCoefficients) };
+
+    // 2^1024 is not a double: in the top binade, scale by 2^(k - 1) and multiply by 2
+    const Int top{ k > 1023 };                     // -1 where k == 1024
+    Double result{ (p * (top ? broadcast(2.0) : broadcast(1.0))) * pow2(k + top) };
+    // Nor is 2^k below 2^-1022: subnormal results are scaled by 2^(k + 64), then by 2^-64 (which rounds them)
+    const Double subnormal{ (p * pow2(k + 64)) * broadcast(0x1p-64) };
+    result = (k < -1021) ? subnormal : result;
+
+    result = (x > kOverflow) ? broadcast(std::numeric_limits<double>::infinity()) : result;
+    result = (x < kUnderflow) ? broadcast(0.0) : result;
+    return result; // NaN compares false everywhere and stays NaN
+}
+
+
+/* log(x) = e * ln2 + log(m)
+
+- x = m * 2^e with m in [sqrt(1/2), sqrt(2)), read from the bits. Subnormals are scaled by 2^54 first.
+- log(m) = 2 * atanh(s) = 2s + 2s^3/3 + 2s^5/5 + ..., with s = (m - 1) / (m + 1) in [-0.172, 0.172].
+  Up to s^21 the truncation error is below 1e-18.
+*/
+inline Double logVector(Double x)
+{
+    constexpr double kLn2Hi{ 6.93147180369123816490e-01 };
+    constexpr double kLn2Lo{ 1.90821492927058770002e-10 };
+    constexpr double kSqrt2{ 1.41421356237309504880 };
+    constexpr std::array<double, 11> kCoefficients{ 1.0 / 21, 1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11,
+                                                    1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1.0 };
+
+    const Int subnormal{ x < std::numeric_limits<double>::min() };
+    const Int bits{ bitCast<Int>(subnormal ? x * 0x1p54 : x) };
+
+    Int e{ ((bits >> 52) & 0x7FF) - 1023 + (subnormal & -54) };
+    Double m{ bitCast<Double>((bits & 0x000FFFFFFFFFFFFF) | 0x3FF0000000000000) }; // [1, 2)
+    const Int high{ m > kSqrt2 };
+    m = high ? m * 0.5 : m;
+    e = e - high;
+
+    const Double f{ m - 1.0 }; // exact
+    const Double s{ f / (f + 2.0) };
+    const Double logM{ (s + s) * polynomial(s * s, kCoefficients) };
+    const Double ed{ toDouble(e) };
+    Double result{ mulAdd(ed, broadcast(kLn2Hi), mulAdd(ed, broadcast(kLn2Lo), logM)) };
+
+    result = (x == std::numeric_limits<double>::infinity()) ? x : result;
+    result = (x == 0.0) ? broadcast(-std::numeric_limits<double>::infinity()) : result;
+    result = ((x < 0.0) | (x != x)) ? broadcast(std::numeric_limits<double>::quiet_NaN()) : result;
+    return result;
+}
+
+
+/* sin and cos
+
+- k = round(x * 2/pi), r = x - k * pi/2 in [-pi/4, pi/4]. pi/2 is split in three parts: the products with k
+  are exact for |k| < 2^20, which keeps r accurate up to |x| ~ 1e5 (larger arguments lose bits).
+- The quadrant k mod 4 picks sin(r) or cos(r) and the sign: sin(x) = sin(r), cos(r), -sin(r), -cos(r).
+  cos(x) is sin(x + pi/2): the same with k + 1. Both results are computed and selected per lane.
+*/
+inline Double sinCosVector(Double x, std::int64_t quadrantOffset)
+{
+    constexpr double kTwoOverPi{ 0.636619772367581343076 };
+    constexpr double kPiOver2Part1{ 1.57079632673412561417 };
+    constexpr double kPiOver2Part2{ 6.07710050630396597660e-11 };
+    constexpr double kPiOver2Part3{ 2.02226624879595063154e-21 };
+    constexpr std::array<double, 7> kSinCoefficients{ 1.0 / 355687428096000.0, -1.0 / 1307674368000.0, 1.0 / 6227020800.0,
+                                                      -1.0 / 39916800.0, 1.0 / 362880.0, -1.0 / 5040.0, 1.0 / 120.0 };
+    constexpr std::array<double, 8> kCosCoefficients{ -1.0 / 6402373705728000.0, 1.0 / 20922789888000.0, -1.0 / 87178291200.0,
+                                                      1.0 / 479001600.0, -1.0 / 3628800.0, 1.0 / 40320.0, -1.0 / 720.0, 1.0 / 24.0 };
+
+    Int k{};
+    const Double kd{ roundToInt(x * kTwoOverPi, k) };
+    Double r{ mulAdd(kd, broadcast(-kPiOver2Part1), x) };
+    r = mulAdd(kd, broadcast(-kPiOver2Part2), r);
+    r = mulAdd(kd, broadcast(-kPiOver2Part3), r);
+
+    const Double z{ r * r };
+    // sin(r) = r - r^3/3! + r^5 * P(r^2),   cos(r) = 1 - r^2/2 + r^4 * Q(r^2)
+    const Double sinR{ mulAdd(r * z, mulAdd(z, polynomial(z, kSinCoefficients), broadcast(-1.0 / 6.0)), r) };
+    const Double cosR{ mulAdd(z * z, polynomial(z, kCosCoefficients), mulAdd(z, broadcast(-0.5), broadcast(1.0))) };
+
+    k = k + quadrantOffset;
+    Double result{ ((k & 1) != 0) ? cosR : sinR };
+    result = bitCast<Double>(bitCast<Int>(result) ^ ((k & 2) << 62)); // flip the sign in quadrants 2 and 3
+
+    const Double nanIfNotFinite{ x - x }; // inf - inf and NaN - NaN are NaN, finite - finite is 0
+    return (nanIfNotFinite == 0.0) ? result : nanIfNotFinite;
+}
+
+
+inline Double sinVector(Double x)
+{
+    return sinCosVector(x, 0);
+}
+
+inline Double cosVector(Double x)
+{
+    return sinCosVector(x, 1);
+}
+
+
+// Full vectors first, then the remainder through a padded vector (1.0 is a valid input for every kernel)
+template <Double (*kernel)(Double)>
+void transform(const double* input, double* output, std::size_t count)
+{
+    std::size_t i{ 0 };
+    for (; i + kWidth <= count; i += kWidth)
+        store(output + i, kernel(load(input + i)));
+
+    if (i < count)
+    {
+        double tail[kWidth];
+        std::fill(std::begin(tail), std::end(tail), 1.0);
+        std::copy(input + i, input + count, tail);
+        store(tail, kernel(load(tail)));
+        std::copy(tail, tail + (count - i), output + i);
+    }
+}
+
+void exp(const double* input, double* output, std::size_t count) { transform<expVector>(input, output, count); }
+void log(const double* input, double* output, std::size_t count) { transform<logVector>(input, output, count); }
+void sin(const double* input, double* output, std::size_t count) { transform<sinVector>(input, output, count); }
+void cos(const double* input, double* output, std::size_t count) { transform<cosVector>(input, output, count); }
+void sqrt(const double* input, double* output, std::size_t count) { transform<sqrtVector>(input, output, count); }
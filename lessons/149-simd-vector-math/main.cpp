@@ -0,0 +1,301 @@
+/* SIMD vector math
+
+- lessons/050-nontype-template-parameters (getSqrt) and lessons/052-constexpr-functions (calcCircumference)
+  call <cmath> one value at a time. When a program transforms whole arrays (signal processing, physics,
+  machine learning...), most of the CPU is idle: one std::exp call uses one lane of registers that hold
+  2 (SSE2), 4 (AVX2) or 8 (AVX-512) doubles.
+- VectorMath computes exp, log, sin, cos and sqrt for a whole span with SIMD instructions:
+  + the argument is reduced and a polynomial evaluated for all lanes at once, without branches
+    (special cases are handled by selecting per lane, not by an if),
+  + the best instruction set is chosen at runtime (CPU feature detection), so the executable stays portable.
+
+Accuracy
+- The results are not bit-identical to <cmath>, they are within a documented bound (in ULPs, see lessons/147-bulk-ulp-comparison).
+- main() checks the bounds on random inputs, for every instruction set the CPU supports.
+*/
+
+#include "VectorMath.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// getSqrt from lessons/050-nontype-template-parameters, for a whole array
+void examples()
+{
+    const std::vector<double> values{ 1.0, 2.0, 4.0, 9.0, 10.0 };
+    std::vector<double> roots(values.size());
+    VectorMath::sqrt(values, roots);
+
+    std::vector<double> exps(values.size());
+    VectorMath::exp(values, exps);
+
+    std::cout << std::setprecision(10);
+    for (std::size_t i{ 0 }; i < values.size(); ++i)
+        std::cout << "sqrt(" << values[i] << ") = " << roots[i] << ", exp(" << values[i] << ") = " << exps[i] << '\n';
+
+    std::cout << "best instruction set: " << VectorMath::isaName(VectorMath::bestIsa()) << '\n';
+}
+
+template <typename T>
+std::uint64_t ulpDistance(T a, T b)
+{
+    if (a != a && b != b)
+        return 0; // both NaN
+    if (a == b)
+        return 0; // including 0.0 and -0.0, inf and inf
+    if (a != a || b != b || std::isinf(a) || std::isinf(b))
+        return std::numeric_limits<std::uint64_t>::max();
+
+    using Bits = std::conditional_t<sizeof(T) == 8, std::int64_t, std::int32_t>;
+    auto ordered{ [](T x) {
+        const auto bits{ static_cast<std::int64_t>(std::bit_cast<Bits>(x)) };
+        return (bits < 0) ? -(bits & std::numeric_limits<Bits>::max()) : bits;
+    } };
+    const std::int64_t x{ ordered(a) };
+    const std::int64_t y{ ordered(b) };
+    return (x > y) ? static_cast<std::uint64_t>(x - y) : static_cast<std::uint64_t>(y - x);
+}
+
+struct Function
+{
+    const char* name;
+    void (*vectorDouble)(std::span<const double>, std::span<double>);
+    void (*vectorFloat)(std::span<const float>, std::span<float>);
+    double (*reference)(double);
+    float (*referenceFloat)(float);
+    std::uint64_t maxUlps;      // the documented bound for double
+    std::vector<double> inputs; // random inputs over the documented domain
+    std::vector<float> floatInputs; // the same, within the range of float (for the benchmark)
+};
+
+std::vector<Function> makeFunctions(std::size_t count)
+{
+    std::mt19937_64 rng{ 7 };
+    auto uniform{ [&](double lo, double hi) {
+        std::uniform_real_distribution<double> dist{ lo, hi };
+        std::vector<double> v(count);
+        for (std::size_t i{ 0 }; i < count; ++i)
+            v[i] = (i % 2 == 0) ? dist(rng) : dist(rng) * 1e-3; // half of them near zero, where the relative error is hardest
+        return v;
+    } };
+    auto positive{ [&] { // random bit patterns: every binade from subnormals to DBL_MAX
+        std::uniform_int_distribution<std::uint64_t> dist{ 1, 0x7FEFFFFFFFFFFFFF };
+        std::vector<double> v(count);
+        for (double& x : v)
+            x = std::bit_cast<double>(dist(rng));
+        return v;
+    } };
+    auto toFloat{ [](const std::vector<double>& v) { return std::vector<float>(v.begin(), v.end()); } };
+    auto positiveFloat{ [&] { // every binade from subnormals to FLT_MAX
+        std::uniform_int_distribution<std::uint32_t> dist{ 1, 0x7F7FFFFF };
+        std::vector<float> v(count);
+        for (float& x : v)
+            x = std::bit_cast<float>(dist(rng));
+        return v;
+    } };
+
+    // the lambdas convert to function pointers and pick the right <cmath> overload
+    return {
+        { "exp", VectorMath::exp, VectorMath::exp, [](double x) { return std::exp(x); }, [](float x) { return std::exp(x); }, 2, uniform(-745.0, 709.0), toFloat(uniform(-103.0, 88.0)) },
+        { "log", VectorMath::log, VectorMath::log, [](double x) { return std::log(x); }, [](float x) { return std::log(x); }, 2, positive(), positiveFloat() },
+        { "sin", VectorMath::sin, VectorMath::sin, [](double x) { return std::sin(x); }, [](float x) { return std::sin(x); }, 2, uniform(-1e5, 1e5), toFloat(uniform(-1e5, 1e5)) },
+        { "cos", VectorMath::cos, VectorMath::cos, [](double x) { return std::cos(x); }, [](float x) { return std::cos(x); }, 2, uniform(-1e5, 1e5), toFloat(uniform(-1e5, 1e5)) },
+        { "sqrt", VectorMath::sqrt, VectorMath::sqrt, [](double x) { return std::sqrt(x); }, [](float x) { return std::sqrt(x); }, 0, positive(), positiveFloat() },
+    };
+}
+
+std::vector<VectorMath::Isa> supportedIsas()
+{
+    std::vector<VectorMath::Isa> isas{};
+    for (auto isa : { VectorMath::Isa::generic, VectorMath::Isa::sse2, VectorMath::Isa::avx2, VectorMath::Isa::avx512 })
+    {
+        if (VectorMath::setIsa(isa))
+            isas.push_back(isa);
+    }
+    VectorMath::setIsa(VectorMath::bestIsa());
+    return isas;
+}
+
+bool checkSpecialValues(const std::vector<Function>& functions)
+{
+    constexpr double inf{ std::numeric_limits<double>::infinity() };
+    constexpr double nan{ std::numeric_limits<double>::quiet_NaN() };
+    const std::vector<double> inputs{ 0.0, -0.0, 1.0, -1.0, inf, -inf, nan, 1e-310, 710.0, -740.0, -745.0, -746.0, 1e5 };
+
+    bool ok{ true };
+    for (const auto& function : functions)
+    {
+        std::vector<double> results(inputs.size());
+        function.vectorDouble(inputs, results);
+
+        for (std::size_t i{ 0 }; i < inputs.size(); ++i)
+        {
+            const double expected{ function.reference(inputs[i]) };
+            if (ulpDistance(results[i], expected) > 2)
+            {
+                std::cout << function.name << '(' << inputs[i] << ") = " << results[i] << " instead of " << expected << '\n';
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkAccuracy(std::vector<Function>& functions, const std::vector<VectorMath::Isa>& isas)
+{
+    bool ok{ true };
+    for (auto isa : isas)
+    {
+        VectorMath::setIsa(isa);
+        std::cout << std::setw(8) << VectorMath::isaName(isa) << " max ulps:";
+        ok = checkSpecialValues(functions) && ok;
+
+        for (auto& function : functions)
+        {
+            const std::size_t count{ function.inputs.size() };
+            std::vector<double> results(count);
+            function.vectorDouble(function.inputs, results);
+
+            // float inputs, and an odd size to exercise the remainder
+            std::vector<float> floatInputs(function.inputs.begin(), function.inputs.begin() + static_cast<std::ptrdiff_t>(count / 4 + 1));
+            std::vector<float> floatResults(floatInputs.size());
+            function.vectorFloat(floatInputs, floatResults);
+
+            std::uint64_t maxUlps{ 0 };
+            for (std::size_t i{ 0 }; i < count; ++i)
+            {
+                const double expected{ function.reference(function.inputs[i]) };
+                if (expected != 0.0 && std::abs(expected) < std::numeric_limits<double>::min())
+                    continue; // exp: flushed to 0 by design
+                maxUlps = std::max(maxUlps, ulpDistance(results[i], expected));
+            }
+
+            std::uint64_t maxFloatUlps{ 0 };
+            for (std::size_t i{ 0 }; i < floatInputs.size(); ++i)
+            {
+                const float expected{ function.referenceFloat(floatInputs[i]) };
+                if (std::abs(expected) < std::numeric_limits<float>::min() || std::isinf(expected))
+                    continue; // out of float range: rounded twice (to double, then to a float subnormal or inf)
+                maxFloatUlps = std::max(maxFloatUlps, ulpDistance(floatResults[i], expected));
+            }
+
+            std::cout << ' ' << function.name << ' ' << maxUlps << " (float " << maxFloatUlps << ')';
+            ok = ok && maxUlps <= function.maxUlps && maxFloatUlps <= 1;
+        }
+        std::cout << '\n';
+    }
+    VectorMath::setIsa(VectorMath::bestIsa());
+    return ok;
+}
+
+
+/* Benchmark
+
+- Each function over the same inputs: <cmath> one value at a time, then VectorMath with each instruction set.
+- exp, log, sin and cos are 10-30 flops per value: SIMD width and fused multiply-add show directly.
+- sqrt is one instruction in both cases: the gain is only the SIMD width, and memory bandwidth limits it.
+- The float rows (expf...) go through the double kernels: no faster than double, while <cmath> has
+  cheaper float functions. Float kernels would do twice the values per instruction.
+*/
+
+template <typename F>
+double nsPerValue(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+void benchmark(const std::vector<Function>& functions, const std::vector<VectorMath::Isa>& isas)
+{
+    std::cout << std::setprecision(3) << std::setw(6) << "ns" << std::setw(10) << "<cmath>";
+    for (auto isa : isas)
+        std::cout << std::setw(10) << VectorMath::isaName(isa);
+    std::cout << '\n';
+
+    double sink{ 0.0 };
+    for (const auto& function : functions)
+    {
+        const auto& inputs{ function.inputs };
+        std::vector<double> results(inputs.size());
+
+        std::cout << std::setw(6) << function.name << std::setw(10) << nsPerValue(inputs.size(), [&] {
+            for (std::size_t i{ 0 }; i < inputs.size(); ++i)
+                results[i] = function.reference(inputs[i]);
+        });
+        sink += results[inputs.size() / 2];
+
+        for (auto isa : isas)
+        {
+            VectorMath::setIsa(isa);
+            std::cout << std::setw(10) << nsPerValue(inputs.size(), [&] { function.vectorDouble(inputs, results); });
+            sink += results[inputs.size() / 2];
+        }
+        std::cout << '\n';
+
+        const auto& floatInputs{ function.floatInputs };
+        std::vector<float> floatResults(floatInputs.size());
+        std::cout << std::setw(5) << function.name << 'f' << std::setw(10) << nsPerValue(floatInputs.size(), [&] {
+            for (std::size_t i{ 0 }; i < floatInputs.size(); ++i)
+                floatResults[i] = function.referenceFloat(floatInputs[i]);
+        });
+        sink += floatResults[floatInputs.size() / 2];
+
+        for (auto isa : isas)
+        {
+            VectorMath::setIsa(isa);
+            std::cout << std::setw(10) << nsPerValue(floatInputs.size(), [&] { function.vectorFloat(floatInputs, floatResults); });
+            sink += floatResults[floatInputs.size() / 2];
+        }
+        std::cout << '\n';
+    }
+    VectorMath::setIsa(VectorMath::bestIsa());
+    std::cout << "(checksum " << sink << ")\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 4000000 };
+
+    examples();
+
+    const auto isas{ supportedIsas() };
+    auto functions{ makeFunctions(count) };
+    const bool ok{ checkAccuracy(functions, isas) };
+    benchmark(functions, isas);
+
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- "#pragma GCC target" (or __attribute__((target("avx2")))) compiles selected functions for a newer CPU;
+  GCC and Clang can also generate the dispatch themselves with __attribute__((target_clones("avx2", "default"))).
+- Compiling the whole program with -march=native is simpler, but the executable may crash (illegal instruction) on older CPUs.
+- AVX-512 code can lower the clock frequency on some (older) Intel CPUs: measure before assuming 8 lanes beat 4.
+- Vectorized math libraries: glibc libmvec (used by GCC with -ffast-math and #pragma omp simd), SLEEF, Intel SVML.
+*/
+
+
+/* References
+
+- https://gcc.gnu.org/onlinedocs/gcc/Vector-Extensions.html
+- https://gcc.gnu.org/onlinedocs/gcc/x86-Function-Attributes.html
+- https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+- https://sleef.org/
+- J.-M. Muller, "Elementary Functions: Algorithms and Implementation"
+*/
@@ -0,0 +1,58 @@
+#ifndef FUNCTION_REF_H
+#define FUNCTION_REF_H
+
+#include <cassert>
+#include <memory>     // for std::addressof
+#include <type_traits>
+#include <utility>
+
+// A non-owning reference to something callable (like std::function_ref in C++26).
+// * Two pointers: the callable, and a function that knows its type and calls it. Never allocates.
+// * Cheap to copy: pass it by value, like std::string_view.
+// * It does NOT extend the lifetime of the callable: only use it as a function parameter,
+//   never store one that refers to a temporary lambda.
+template <typename Signature>
+class FunctionRef; // only the R(Args...) specialization exists
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)>
+{
+private:
+    union Target
+    {
+        void* object;
+        R (*function)(Args...);
+    };
+
+    Target m_target{};
+    R (*m_invoke)(Target, Args...){};
+
+public:
+    // A plain function: store the pointer itself, no object to refer to
+    FunctionRef(R (*function)(Args...))
+        : m_invoke{ [](Target target, Args... args) -> R { return target.function(std::forward<Args>(args)...); } }
+    {
+        assert(function && "FunctionRef to a null function pointer");
+        m_target.function = function;
+    }
+
+    // Any other callable (lambda, functor, std::function...), referred to by address.
+    // Captureless lambdas too: converting one to a function pointer would be a user-defined
+    // conversion, so the overload above only wins for real functions and function pointers.
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& callable)
+        : m_invoke{ [](Target target, Args... args) -> R {
+              return (*static_cast<std::remove_reference_t<F>*>(target.object))(std::forward<Args>(args)...);
+          } }
+    {
+        m_target.object = const_cast<void*>(static_cast<const void*>(std::addressof(callable)));
+    }
+
+    R operator()(Args... args) const
+    {
+        return m_invoke(m_target, std::forward<Args>(args)...);
+    }
+};
+
+#endif
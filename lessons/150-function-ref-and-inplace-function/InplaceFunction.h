@@ -0,0 +1,130 @@
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>         // for placement new, std::launder
+#include <type_traits>
+#include <utility>
+
+// An owning callable wrapper like std::function, with the callable stored inside the object.
+// * Capacity bytes of storage: a callable that does not fit is a compile error, not a heap allocation.
+//   => InplaceFunction never allocates, and copying one never allocates either.
+// * The callable must be copy constructible (as for std::function) and nothrow move constructible.
+// * Calling an empty InplaceFunction is a bug (assert), where std::function throws std::bad_function_call.
+template <typename Signature, std::size_t Capacity = 32, std::size_t Alignment = alignof(std::max_align_t)>
+class InplaceFunction; // only the R(Args...) specialization exists
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Alignment>
+class InplaceFunction<R(Args...), Capacity, Alignment>
+{
+private:
+    // What a std::function does with virtual functions, written by hand: one table per stored type
+    struct Operations
+    {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*copy)(const void* from, void* to);
+        void (*move)(void* from, void* to); // move-constructs into to, and destroys from
+        void (*destroy)(void* storage);
+    };
+
+    template <typename F>
+    static constexpr Operations s_operations{
+        [](void* storage, Args&&... args) -> R { return (*std::launder(static_cast<F*>(storage)))(std::forward<Args>(args)...); },
+        [](const void* from, void* to) { ::new (to) F(*std::launder(static_cast<const F*>(from))); },
+        [](void* from, void* to) {
+            F* source{ std::launder(static_cast<F*>(from)) };
+            ::new (to) F(std::move(*source));
+            source->~F();
+        },
+        [](void* storage) { std::launder(static_cast<F*>(storage))->~F(); },
+    };
+
+    alignas(Alignment) std::byte m_storage[Capacity];
+    const Operations* m_operations{ nullptr }; // nullptr: empty
+
+public:
+    static constexpr std::size_t capacity{ Capacity };
+
+    InplaceFunction() = default;
+
+    template <typename F, typename Stored = std::decay_t<F>>
+        requires(!std::is_same_v<Stored, InplaceFunction> && std::is_invocable_r_v<R, Stored&, Args...>)
+    InplaceFunction(F&& callable)
+        : m_operations{ &s_operations<Stored> }
+    {
+        static_assert(sizeof(Stored) <= Capacity, "the callable does not fit: increase Capacity or capture less");
+        static_assert(Alignment % alignof(Stored) == 0, "the callable needs a stricter alignment");
+        static_assert(std::is_copy_constructible_v<Stored>, "the callable must be copy constructible");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>, "the callable must be nothrow move constructible");
+
+        ::new (static_cast<void*>(m_storage)) Stored(std::forward<F>(callable));
+    }
+
+    InplaceFunction(const InplaceFunction& other)
+        : m_operations{ other.m_operations }
+    {
+        if (m_operations)
+            m_operations->copy(other.m_storage, m_storage);
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept
+        : m_operations{ other.m_operations }
+    {
+        if (m_operations)
+        {
+            m_operations->move(other.m_storage, m_storage);
+            other.m_operations = nullptr;
+        }
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& other)
+    {
+        if (this != &other)
+        {
+            InplaceFunction copy{ other }; // if the copy throws, *this is unchanged
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.m_operations)
+            {
+                other.m_operations->move(other.m_storage, m_storage);
+                m_operations = other.m_operations;
+                other.m_operations = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        if (m_operations)
+        {
+            m_operations->destroy(m_storage);
+            m_operations = nullptr;
+        }
+    }
+
+    explicit operator bool() const { return m_operations != nullptr; }
+
+    // const like std::function::operator(): the stored callable may still modify its own captures (mutable lambdas)
+    R operator()(Args... args) const
+    {
+        assert(m_operations && "calling an empty InplaceFunction");
+        return m_operations->invoke(const_cast<std::byte*>(m_storage), std::forward<Args>(args)...);
+    }
+};
+
+#endif
@@ -0,0 +1,21 @@
+#include "Sorting.h"
+
+void sortWithPointer(std::span<int> values, bool (*less)(int, int))
+{
+    std::sort(values.begin(), values.end(), less);
+}
+
+void sortWithStdFunction(std::span<int> values, const std::function<bool(int, int)>& less)
+{
+    std::sort(values.begin(), values.end(), std::cref(less)); // std::sort copies its comparator, and copying a std::function may allocate
+}
+
+void sortWithFunctionRef(std::span<int> values, FunctionRef<bool(int, int)> less)
+{
+    std::sort(values.begin(), values.end(), less);
+}
+
+void sortWithInplaceFunction(std::span<int> values, const InplaceFunction<bool(int, int)>& less)
+{
+    std::sort(values.begin(), values.end(), std::cref(less)); // same: avoid copying the whole buffer
+}
@@ -0,0 +1,26 @@
+#ifndef SORTING_H
+#define SORTING_H
+
+#include "FunctionRef.h"
+#include "InplaceFunction.h"
+
+#include <algorithm>
+#include <functional>
+#include <span>
+
+// The same sort, with the comparator passed in the ways compared by lessons/106-function-pointer
+// and lessons/110-lambda. All but the template are defined in Sorting.cpp, like a library would:
+// the compiler cannot see the comparator while compiling the sort, so every comparison is an indirect call.
+
+// sol2/sol3: a template, instantiated (and inlined) for each comparator type. Must be in the header.
+void sortWithTemplate(std::span<int> values, const auto& less)
+{
+    std::sort(values.begin(), values.end(), less);
+}
+
+void sortWithPointer(std::span<int> values, bool (*less)(int, int));                        // sol4, loo
+void sortWithStdFunction(std::span<int> values, const std::function<bool(int, int)>& less);  // sol1, loo3
+void sortWithFunctionRef(std::span<int> values, FunctionRef<bool(int, int)> less);
+void sortWithInplaceFunction(std::span<int> values, const InplaceFunction<bool(int, int)>& less);
+
+#endif
@@ -0,0 +1,190 @@
+/* Callbacks without std::function
+
+- lessons/106-function-pointer passes callbacks as function pointers (loo) or std::function (loo3),
+  lessons/110-lambda compares std::function, templates and function pointers (sol1 ... sol4).
+- Function pointers cannot hold a lambda with captures. std::function can hold anything, but:
+  + a callable bigger than its small internal buffer (16 bytes in libstdc++) is copied to the heap,
+    and so is every copy of the std::function,
+  + it has to support copying, type queries (target_type) and throwing bad_function_call: more code per call.
+
+Two lighter alternatives
+- FunctionRef<R(Args...)>: does not own anything. Two pointers, never allocates. The best parameter type
+  for "a callback used during this call" (sort comparators, visitors, for-each callbacks).
+- InplaceFunction<R(Args...), Capacity>: owns a copy of the callable like std::function, but in a buffer inside
+  the object. Too big does not compile. For callbacks that must be stored (event handlers, task queues).
+
+- Templates (sol2/sol3) remain the fastest: the compiler sees the lambda and inlines it. But every
+  comparator type instantiates the whole algorithm again, and the code must live in a header.
+*/
+
+#include "FunctionRef.h"
+#include "InplaceFunction.h"
+#include "Sorting.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+// Counts heap allocations, to check the "never allocates" claims
+static std::size_t g_allocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* p{ std::malloc(size ? size : 1) })
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// moo from lessons/106-function-pointer
+bool moo(int x, int y)
+{
+    return x > y;
+}
+
+// loo from lessons/106-function-pointer, with a FunctionRef parameter: accepts moo and capturing lambdas alike
+void loo4(int x, int y, FunctionRef<bool(int, int)> fcn)
+{
+    if (fcn(x, y))
+        std::cout << x << " is greater than " << y << '\n';
+    else
+        std::cout << x << " is not greater than " << y << '\n';
+}
+
+bool examples()
+{
+    loo4(3, 4, moo);
+    const int offset{ 2 };
+    loo4(3, 4, [offset](int x, int y) { return x + offset > y; });
+    loo4(3, 4, [](int x, int y) { return x < y; }); // captureless: referred to like any other lambda
+
+    const auto less{ [](int x, int y) { return x < y; } };
+    const FunctionRef<bool(int, int)> lessRef{ less };
+    const FunctionRef<bool(int, int)> mooRef{ moo };
+    const bool refsOk{ lessRef(1, 2) && !lessRef(2, 1) && mooRef(2, 1) };
+
+    // A callable of 40 bytes: too big for the internal buffer of std::function
+    struct Big
+    {
+        double weights[5]{ 1.0, 2.0, 3.0, 4.0, 5.0 };
+        double operator()(int i) const { return weights[i % 5]; }
+    };
+
+    const std::size_t before{ g_allocations };
+    std::function<double(int)> standard{ Big{} };
+    std::function<double(int)> standardCopy{ standard };
+    const std::size_t standardAllocations{ g_allocations - before };
+
+    InplaceFunction<double(int), 48> inplace{ Big{} };
+    InplaceFunction<double(int), 48> inplaceCopy{ inplace };
+    InplaceFunction<double(int), 48> moved{ std::move(inplaceCopy) };
+    const std::size_t inplaceAllocations{ g_allocations - before - standardAllocations };
+    // InplaceFunction<double(int), 32> tooSmall{ Big{} }; // compile error: the callable does not fit
+
+    std::cout << "allocations: std::function " << standardAllocations << ", InplaceFunction " << inplaceAllocations << '\n';
+
+    // a mutable lambda keeps its state inside the InplaceFunction
+    InplaceFunction<int()> counter{ [n = 0]() mutable { return ++n; } };
+    counter();
+    const bool ok{ refsOk && standard(1) == 2.0 && inplace(1) == 2.0 && moved(4) == 5.0 && !inplaceCopy && counter() == 2 };
+
+    return ok && inplaceAllocations == 0;
+}
+
+
+/* Benchmark
+
+- Sorting 10^6 ints calls the comparator ~2 * 10^7 times: the call overhead dominates.
+- The comparator captures a reference (descending or not), so a plain function pointer needs a global instead.
+*/
+
+static bool g_descending{ false };
+
+bool lessGlobal(int a, int b)
+{
+    return g_descending ? a > b : a < b;
+}
+
+template <typename F>
+double measureMilliseconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 11 };
+    std::vector<int> original(count);
+    for (int& x : original)
+        x = static_cast<int>(rng());
+
+    bool descending{ false };
+    auto less{ [&descending](int a, int b) { return descending ? a > b : a < b; } };
+
+    std::vector<int> reference{ original };
+    std::sort(reference.begin(), reference.end());
+
+    bool ok{ true };
+    std::vector<int> values{};
+    auto run{ [&](const char* name, auto sort) {
+        values = original;
+        const std::size_t allocationsBefore{ g_allocations };
+        const double ms{ measureMilliseconds([&] { sort(values); }) };
+        std::cout << std::setw(20) << name << ": " << std::setw(7) << ms << " ms, " << g_allocations - allocationsBefore << " allocations\n";
+        ok = ok && values == reference;
+    } };
+
+    std::cout << std::setprecision(3) << std::fixed;
+    run("template", [&](std::vector<int>& v) { sortWithTemplate(v, less); });
+    run("function pointer", [&](std::vector<int>& v) { sortWithPointer(v, lessGlobal); });
+    run("std::function", [&](std::vector<int>& v) { sortWithStdFunction(v, less); });
+    run("FunctionRef", [&](std::vector<int>& v) { sortWithFunctionRef(v, less); });
+    run("InplaceFunction", [&](std::vector<int>& v) { sortWithInplaceFunction(v, less); });
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 1000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- C++26 adds std::function_ref (non-owning) and C++23 std::move_only_function (owning, move-only, may still allocate).
+- Never store a FunctionRef to a temporary: FunctionRef<void()> f{ [] {} }; f(); // dangling, the lambda is gone
+  A capture-less lambda converts to a function pointer first, so that one case is safe.
+- InplaceFunction's Capacity is part of its type: InplaceFunction<void(), 32> and InplaceFunction<void(), 64> are
+  different types. Pick one size per use (e.g. a type alias for "event handler").
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/function-pointers/
+- https://www.learncpp.com/cpp-tutorial/introduction-to-lambdas-anonymous-functions/
+- https://en.cppreference.com/w/cpp/utility/functional/function_ref
+- https://vittorioromeo.com/index/blog/passing_functions_to_functions.html
+*/
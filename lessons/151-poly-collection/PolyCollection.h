@@ -0,0 +1,170 @@
+#ifndef POLY_COLLECTION_H
+#define POLY_COLLECTION_H
+
+#include <concepts>   // for std::derived_from (C++20)
+#include <cstddef>
+#include <memory>
+#include <new>        // for std::launder
+#include <span>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+// A container of objects of different classes derived from Base, stored by value.
+// * Each concrete type has its own segment: a std::vector<T>. No heap allocation per object,
+//   objects of the same type are contiguous in memory.
+// * Iteration goes segment by segment: the virtual calls made while visiting one segment all go to the
+//   same function (perfectly predicted), and forEachOf<Ts...>() calls the listed types without any virtual call.
+// * The order of insertion is NOT kept: only the order within a segment.
+// * Objects are stored as their static type: insert(derived) where derived is a Base& would slice. Use emplace<T>().
+// * Like std::vector, inserting may move the objects of that segment and invalidate references to them.
+template <typename Base>
+class PolyCollection
+{
+private:
+    // The type-erased part of a segment: everything forEach() needs to visit the objects as Base&.
+    class SegmentBase
+    {
+    public:
+        virtual ~SegmentBase() = default;
+
+        virtual std::size_t size() const = 0;
+        virtual Base* firstBase() = 0;      // the Base subobject of the first element (nullptr if empty)
+        virtual std::size_t stride() const = 0;
+        virtual void clear() = 0;
+    };
+
+    template <typename T>
+    class Segment final : public SegmentBase
+    {
+    public:
+        std::vector<T> objects{};
+
+        std::size_t size() const override { return objects.size(); }
+        Base* firstBase() override { return objects.empty() ? nullptr : static_cast<Base*>(objects.data()); }
+        std::size_t stride() const override { return sizeof(T); }
+        void clear() override { objects.clear(); }
+    };
+
+    struct Entry
+    {
+        std::type_index type;
+        std::unique_ptr<SegmentBase> segment;
+    };
+
+    std::vector<Entry> m_segments{}; // a handful of types: a linear search beats a hash map
+    std::size_t m_size{ 0 };
+
+    template <typename T>
+    Segment<T>* findSegment() const
+    {
+        for (const auto& entry : m_segments)
+        {
+            if (entry.type == std::type_index{ typeid(T) })
+                return static_cast<Segment<T>*>(entry.segment.get());
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    Segment<T>& segmentFor()
+    {
+        if (auto* segment{ findSegment<T>() })
+            return *segment;
+
+        auto segment{ std::make_unique<Segment<T>>() };
+        auto& result{ *segment };
+        m_segments.push_back({ std::type_index{ typeid(T) }, std::move(segment) });
+        return result;
+    }
+
+public:
+    template <std::derived_from<Base> T, typename... Args>
+    T& emplace(Args&&... args)
+    {
+        T& object{ segmentFor<T>().objects.emplace_back(std::forward<Args>(args)...) };
+        ++m_size;
+        return object;
+    }
+
+    template <std::derived_from<Base> T>
+    T& insert(T object)
+    {
+        return emplace<T>(std::move(object));
+    }
+
+    // Reserving avoids moving the objects while a segment grows
+    template <std::derived_from<Base> T>
+    void reserve(std::size_t count)
+    {
+        segmentFor<T>().objects.reserve(count);
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::size_t segmentCount() const { return m_segments.size(); }
+
+    // The objects of type T (empty if there are none)
+    template <std::derived_from<Base> T>
+    std::span<T> segment()
+    {
+        auto* segment{ findSegment<T>() };
+        return segment ? std::span<T>{ segment->objects } : std::span<T>{};
+    }
+
+    void clear()
+    {
+        for (auto& entry : m_segments)
+            entry.segment->clear();
+        m_size = 0;
+    }
+
+    // f(Base&) for every object, segment by segment
+    template <typename F>
+    void forEach(F&& f)
+    {
+        for (auto& entry : m_segments)
+            forEachBase(*entry.segment, f);
+    }
+
+    // f(T&) with the static type T for the segments of Ts..., then f(Base&) for the other segments.
+    // With a generic lambda, calls on T are resolved at compile time (and inlined) when T or the function is final.
+    template <std::derived_from<Base>... Ts, typename F>
+    void forEachOf(F&& f)
+    {
+        (forEachIn<Ts>(f), ...);
+
+        for (auto& entry : m_segments)
+        {
+            if (((entry.type == std::type_index{ typeid(Ts) }) || ...))
+                continue;
+
+            forEachBase(*entry.segment, f);
+        }
+    }
+
+private:
+    // The Base subobjects of a std::vector<T> are sizeof(T) bytes apart: walk them with a byte stride,
+    // three virtual calls per segment instead of one per element.
+    template <typename F>
+    static void forEachBase(SegmentBase& segment, F& f)
+    {
+        auto* bytes{ reinterpret_cast<std::byte*>(segment.firstBase()) };
+        const std::size_t stride{ segment.stride() };
+        const std::size_t count{ segment.size() };
+        for (std::size_t i{ 0 }; i < count; ++i)
+            f(*std::launder(reinterpret_cast<Base*>(bytes + i * stride)));
+    }
+
+    template <typename T, typename F>
+    void forEachIn(F& f)
+    {
+        if (auto* segment{ findSegment<T>() })
+        {
+            for (T& object : segment->objects)
+                f(object);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,211 @@
+/* Polymorphic collections without the pointer chasing
+
+- lessons/128-virtual-functions and lessons/130-abstract call virtual functions through base pointers.
+  A heterogeneous container is then usually a std::vector<std::unique_ptr<Animal>>. Visiting each element:
+  + loads the pointer, then the object somewhere on the heap (a likely cache miss once the data is bigger than the cache),
+  + loads the vtable pointer, then calls through it: with mixed types the CPU mispredicts the target again and again,
+  + and the compiler cannot inline a function it does not know.
+
+PolyCollection keeps the virtual interface, but stores every concrete type in its own std::vector:
+- objects are contiguous and read sequentially (the hardware prefetcher loves that),
+- within a segment every call goes to the same function: the branch predictor gets it right,
+- forEachOf<Cow, Dragonfly>() even knows the static types: no virtual call at all for final classes.
+*/
+
+#include "PolyCollection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <string_view>
+#include <vector>
+
+// Animal1 from lessons/130-abstract, with a number to compute in the benchmark
+class Animal
+{
+protected:
+    int m_age{};
+
+public:
+    explicit Animal(int age)
+        : m_age{ age }
+    {
+    }
+
+    virtual ~Animal() = default;
+
+    virtual std::string_view speak() const = 0;
+    virtual double foodPerDay() const = 0; // kg
+};
+
+// final: the compiler knows no class overrides these functions, so a call on a Cow& can be devirtualized
+class Cow final : public Animal
+{
+    double m_weight{};
+
+public:
+    Cow(int age, double weight)
+        : Animal{ age }, m_weight{ weight }
+    {
+    }
+
+    std::string_view speak() const override { return "Moo"; }
+    double foodPerDay() const override { return 0.025 * m_weight + 0.1 * m_age; }
+};
+
+class Dragonfly final : public Animal
+{
+public:
+    explicit Dragonfly(int age)
+        : Animal{ age }
+    {
+    }
+
+    std::string_view speak() const override { return "Buzz"; }
+    double foodPerDay() const override { return 0.0001 * (1 + m_age); }
+};
+
+class Dog final : public Animal
+{
+    double m_weight{};
+    bool m_working{};
+
+public:
+    Dog(int age, double weight, bool working)
+        : Animal{ age }, m_weight{ weight }, m_working{ working }
+    {
+    }
+
+    std::string_view speak() const override { return "Woof"; }
+    double foodPerDay() const override { return (m_working ? 0.04 : 0.025) * m_weight; }
+};
+
+bool examples()
+{
+    PolyCollection<Animal> animals{};
+    animals.emplace<Cow>(3, 600.0);
+    animals.emplace<Dragonfly>(1);
+    animals.emplace<Cow>(5, 700.0);
+    animals.emplace<Dog>(2, 30.0, true);
+
+    // grouped by type, not in insertion order
+    animals.forEach([](const Animal& animal) { std::cout << animal.speak() << ' '; });
+    std::cout << '\n';
+
+    int cows{ 0 };
+    int others{ 0 };
+    animals.forEachOf<Cow>([&](const auto& animal) {
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(animal)>, Cow>)
+            ++cows; // static type Cow
+        else
+            ++others; // Dragonfly and Dog, seen as Animal
+    });
+
+    return animals.size() == 4 && animals.segmentCount() == 3 && animals.segment<Cow>().size() == 2 && cows == 2 && others == 2;
+}
+
+
+/* Benchmark
+
+- 10^7 animals of 3 types in random order, and the total food per day.
+- std::vector<std::unique_ptr<Animal>>: objects allocated in creation order, but visited in random type order
+  like a real program that adds and removes objects over time (the pointers are shuffled).
+*/
+
+template <typename F>
+double measureMilliseconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 13 };
+    std::uniform_int_distribution<int> kind{ 0, 2 };
+    std::uniform_int_distribution<int> age{ 0, 15 };
+
+    std::vector<std::unique_ptr<Animal>> pointers{};
+    pointers.reserve(count);
+    PolyCollection<Animal> collection{};
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        const int a{ age(rng) };
+        switch (kind(rng))
+        {
+        case 0:
+            pointers.push_back(std::make_unique<Cow>(a, 500.0 + a));
+            collection.emplace<Cow>(a, 500.0 + a);
+            break;
+        case 1:
+            pointers.push_back(std::make_unique<Dragonfly>(a));
+            collection.emplace<Dragonfly>(a);
+            break;
+        default:
+            pointers.push_back(std::make_unique<Dog>(a, 20.0 + a, a % 2 == 0));
+            collection.emplace<Dog>(a, 20.0 + a, a % 2 == 0);
+            break;
+        }
+    }
+    std::shuffle(pointers.begin(), pointers.end(), rng);
+
+    double pointerTotal{ 0.0 };
+    const double pointerMs{ measureMilliseconds([&] {
+        for (const auto& animal : pointers)
+            pointerTotal += animal->foodPerDay();
+    }) };
+
+    double segmentTotal{ 0.0 };
+    const double segmentMs{ measureMilliseconds([&] { collection.forEach([&](const Animal& animal) { segmentTotal += animal.foodPerDay(); }); }) };
+
+    double staticTotal{ 0.0 };
+    const double staticMs{ measureMilliseconds([&] {
+        collection.forEachOf<Cow, Dragonfly, Dog>([&](const auto& animal) { staticTotal += animal.foodPerDay(); });
+    }) };
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "vector<unique_ptr<Animal>>:    " << pointerMs << " ms\n"
+              << "PolyCollection::forEach:       " << segmentMs << " ms (virtual calls, one target per segment)\n"
+              << "PolyCollection::forEachOf<..>: " << staticMs << " ms (static types, inlined)\n"
+              << "total food: " << pointerTotal << " kg/day\n";
+
+    // the sums are taken in different orders: equal up to rounding
+    auto close{ [](double a, double b) { return std::abs(a - b) <= 1e-9 * std::abs(b); } };
+    return close(segmentTotal, pointerTotal) && close(staticTotal, pointerTotal);
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Segments give up the global order. When order matters (draw calls sorted by depth...), keep an index
+  or sort within segments instead.
+- The same idea without virtual functions: a std::vector per type and a std::tuple of vectors
+  (or std::variant in a vector: contiguous, but one switch per element and the size of the biggest type).
+- Boost.PolyCollection (base_collection, function_collection, any_collection) is a complete implementation.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/virtual-functions/
+- https://www.learncpp.com/cpp-tutorial/the-virtual-table/
+- https://www.boost.org/doc/libs/release/doc/html/poly_collection.html
+- https://bannalia.blogspot.com/2014/05/fast-polymorphic-collections.html
+*/
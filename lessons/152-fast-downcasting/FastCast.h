@@ -0,0 +1,142 @@
+#ifndef FAST_CAST_H
+#define FAST_CAST_H
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+// Opt-in type identification for a class hierarchy: is<T>(p) and as<T>(p) in constant time, whatever the depth,
+// without RTTI (works with -fno-rtti), for single, multiple and virtual inheritance.
+//
+// Every class of the hierarchy:
+// * derives (directly or not) from FastCast::Castable,
+// * names itself and its direct bases:  using FastCastClass = FastCast::Class<Copier, Scanner, Printer>;
+// * overrides fastCastSelf():           FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+// A class that forgets the override is identified as its parent (is<ItsOwnType> is false).
+// A base class that appears several times in an object (non-virtual diamond) is ambiguous: as<> it returns nullptr.
+namespace FastCast
+{
+    using TypeId = std::uint32_t;
+    inline constexpr std::size_t kMaxTypes{ 256 }; // per program, all hierarchies together
+
+    using Upcast = void* (*)(void* mostDerived);
+
+    struct ClassInfo
+    {
+        std::bitset<kMaxTypes> ancestors{};      // the id of every unambiguous base class (direct or not), and its own
+        std::array<Upcast, kMaxTypes> upcasts{}; // complete object -> base class subobject, by base class id
+    };
+
+    // The runtime identity of an object: the class it was created as, and the address of the complete object
+    struct Self
+    {
+        const ClassInfo* info;
+        void* object;
+    };
+
+    template <typename T, typename... DirectBases>
+    struct Class
+    {
+        using Type = T;
+    };
+
+    class Castable
+    {
+    public:
+        using FastCastClass = Class<Castable>;
+
+        virtual ~Castable() = default;
+        virtual Self fastCastSelf() const = 0;
+    };
+
+    namespace detail
+    {
+        inline TypeId nextTypeId()
+        {
+            static std::atomic<TypeId> s_next{ 0 };
+            const TypeId id{ s_next++ };
+            // Checked in release builds too: a bigger id would index past the end of ClassInfo::upcasts
+            if (id >= kMaxTypes)
+                throw std::length_error{ "FastCast: too many classes, increase kMaxTypes" };
+            return id;
+        }
+    }
+
+    // Dense ids 0, 1, 2... in the order classes are first used
+    template <typename T>
+    TypeId typeId()
+    {
+        static const TypeId s_id{ detail::nextTypeId() };
+        return s_id;
+    }
+
+    namespace detail
+    {
+        template <typename Derived, typename Base>
+        void addAncestor(ClassInfo& info);
+
+        template <typename Derived, typename T, typename... DirectBases>
+        void addBases(ClassInfo& info, Class<T, DirectBases...>)
+        {
+            static_assert((std::is_base_of_v<DirectBases, T> && ...), "FastCastClass lists a class that is not a base");
+            (addAncestor<Derived, DirectBases>(info), ...);
+        }
+
+        // The compiler knows the layout of Derived: the upcast to any unambiguous base, even through
+        // virtual inheritance, is one implicit conversion. The whole base list is walked once, at the first use.
+        template <typename Derived, typename Base>
+        void addAncestor(ClassInfo& info)
+        {
+            if constexpr (std::is_convertible_v<Derived*, Base*>) // false if Base is ambiguous
+            {
+                const TypeId id{ typeId<Base>() };
+                info.ancestors.set(id);
+                info.upcasts[id] = [](void* object) -> void* { return static_cast<Base*>(static_cast<Derived*>(object)); };
+            }
+            addBases<Derived>(info, typename Base::FastCastClass{});
+        }
+
+        template <typename T>
+        const ClassInfo& classInfo()
+        {
+            static const ClassInfo s_info{ [] {
+                ClassInfo info{};
+                addAncestor<T, T>(info);
+                return info;
+            }() };
+            return s_info;
+        }
+    }
+
+    template <typename T>
+    Self self(const T* object)
+    {
+        static_assert(std::is_same_v<typename T::FastCastClass::Type, T>, "T must declare FastCastClass = FastCast::Class<T, its direct bases...>");
+        return { &detail::classInfo<T>(), const_cast<T*>(object) };
+    }
+
+    // Is *p a T (or derived from T)? false for nullptr.
+    template <typename T, typename From>
+    bool is(const From* p)
+    {
+        return p && p->fastCastSelf().info->ancestors.test(typeId<T>());
+    }
+
+    // Like dynamic_cast<T*>(p): downcasts and cross-casts, nullptr if *p is not a T
+    template <typename T, typename From>
+    auto as(From* p) -> std::conditional_t<std::is_const_v<From>, const T*, T*>
+    {
+        if (!p)
+            return nullptr;
+
+        const Self self{ p->fastCastSelf() };
+        const Upcast upcast{ self.info->upcasts[typeId<T>()] };
+        return upcast ? static_cast<T*>(upcast(self.object)) : nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,227 @@
+/* Downcasting without dynamic_cast
+
+- lessons/132-dynamic_cast converts a Base* to a Derived* with dynamic_cast, which checks the type at runtime.
+- dynamic_cast has to handle any hierarchy it is given without knowing it in advance: it walks the type_info
+  of the object's class and of its bases. Each step compares type_info objects (with GCC: compares the names,
+  sometimes with strcmp). The deeper the hierarchy, the slower a cast, and a failed cast walks everything.
+
+FastCast: give each class of a hierarchy a small id and, once per class, the set of its ancestors.
+- is<T>(p): one virtual call (which class is *p?) and one bit test, whatever the depth.
+- as<T>(p): the same, then a precomputed upcast from the complete object to the T subobject.
+  Upcasts are always known to the compiler, even through multiple and virtual inheritance
+  (lessons/128-multiple-inheritance, lessons/131-virtual-base-class), so downcasts and cross-casts work too.
+*/
+
+#include "FastCast.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Base and Derived from lessons/132-dynamic_cast
+class Base : public FastCast::Castable
+{
+protected:
+    int m_value{};
+
+public:
+    using FastCastClass = FastCast::Class<Base, FastCast::Castable>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+
+    Base(int value)
+        : m_value{ value }
+    {
+    }
+};
+
+class Derived : public Base
+{
+protected:
+    std::string m_name{};
+
+public:
+    using FastCastClass = FastCast::Class<Derived, Base>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+
+    Derived(int value, std::string_view name)
+        : Base{ value }, m_name{ name }
+    {
+    }
+
+    const std::string& getName() const { return m_name; }
+};
+
+// The devices of lessons/131-virtual-base-class: a diamond with a virtual base
+class PoweredDevice : public FastCast::Castable
+{
+public:
+    using FastCastClass = FastCast::Class<PoweredDevice, FastCast::Castable>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+
+    int m_power{ 120 };
+};
+
+class Scanner : virtual public PoweredDevice
+{
+public:
+    using FastCastClass = FastCast::Class<Scanner, PoweredDevice>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+
+    int m_dpi{ 600 };
+};
+
+class Printer : virtual public PoweredDevice
+{
+public:
+    using FastCastClass = FastCast::Class<Printer, PoweredDevice>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+
+    int m_pagesPerMinute{ 20 };
+};
+
+class Copier : public Scanner, public Printer
+{
+public:
+    using FastCastClass = FastCast::Class<Copier, Scanner, Printer>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+};
+
+bool examples()
+{
+    std::unique_ptr<Base> b{ std::make_unique<Derived>(1, "Apple") };
+    if (Derived* d{ FastCast::as<Derived>(b.get()) })
+        std::cout << "The name of the Derived is: " << d->getName() << '\n';
+
+    const Base plain{ 2 };
+    bool ok{ FastCast::as<Derived>(&plain) == nullptr && FastCast::is<Base>(&plain) && !FastCast::is<Derived>(&plain) };
+
+    // Every cast between the devices gives the same pointer as dynamic_cast
+    Copier copier{};
+    Scanner scanner{};
+    Printer printer{};
+    auto check{ [&ok](auto* from) {
+        ok = ok && FastCast::as<PoweredDevice>(from) == dynamic_cast<PoweredDevice*>(from)
+             && FastCast::as<Scanner>(from) == dynamic_cast<Scanner*>(from)
+             && FastCast::as<Printer>(from) == dynamic_cast<Printer*>(from)
+             && FastCast::as<Copier>(from) == dynamic_cast<Copier*>(from);
+    } };
+    for (PoweredDevice* device : { static_cast<PoweredDevice*>(&copier), static_cast<PoweredDevice*>(&scanner), static_cast<PoweredDevice*>(&printer) })
+        check(device);
+    check(static_cast<Scanner*>(&copier));
+    check(static_cast<Printer*>(&copier)); // Printer* -> Scanner* is a cross-cast
+
+    Printer* p{ FastCast::as<Printer>(static_cast<PoweredDevice*>(&copier)) }; // down from a virtual base: static_cast cannot do that
+    std::cout << "copier: " << p->m_pagesPerMinute << " pages per minute, " << p->m_power << " W\n";
+    return ok;
+}
+
+
+/* Benchmark
+
+- Three hierarchies, 3, 6 and 10 classes deep: Level<0> <- Level<1> <- ... <- Level<depth - 1>.
+- Objects of random levels, cast from Level<0>* to the middle level: about half of the casts fail.
+*/
+
+template <int Depth, int N>
+class Level : public Level<Depth, N - 1>
+{
+public:
+    using FastCastClass = FastCast::Class<Level, Level<Depth, N - 1>>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+};
+
+template <int Depth>
+class Level<Depth, 0> : public FastCast::Castable
+{
+public:
+    using FastCastClass = FastCast::Class<Level, FastCast::Castable>;
+    FastCast::Self fastCastSelf() const override { return FastCast::self(this); }
+};
+
+template <typename F>
+double nsPerCast(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+template <int Depth>
+bool benchmarkDepth(std::size_t count)
+{
+    using Root = Level<Depth, 0>;
+    using Target = Level<Depth, Depth / 2>;
+
+    // one factory per level
+    auto factories{ []<int... Ns>(std::integer_sequence<int, Ns...>) {
+        return std::vector<std::unique_ptr<Root> (*)()>{ [] { return std::unique_ptr<Root>{ std::make_unique<Level<Depth, Ns>>() }; }... };
+    }(std::make_integer_sequence<int, Depth>{}) };
+
+    std::mt19937 rng{ 17 };
+    std::uniform_int_distribution<std::size_t> level{ 0, Depth - 1 };
+    std::vector<std::unique_ptr<Root>> objects{};
+    for (std::size_t i{ 0 }; i < count; ++i)
+        objects.push_back(factories[level(rng)]());
+
+    std::size_t dynamicFound{ 0 };
+    const double dynamicNs{ nsPerCast(count, [&] {
+        for (const auto& object : objects)
+            dynamicFound += (dynamic_cast<Target*>(object.get()) != nullptr);
+    }) };
+
+    std::size_t fastFound{ 0 };
+    const double fastNs{ nsPerCast(count, [&] {
+        for (const auto& object : objects)
+            fastFound += (FastCast::as<Target>(object.get()) != nullptr);
+    }) };
+
+    std::size_t isFound{ 0 };
+    const double isNs{ nsPerCast(count, [&] {
+        for (const auto& object : objects)
+            isFound += FastCast::is<Target>(object.get());
+    }) };
+
+    std::cout << std::setw(5) << Depth << std::setw(16) << dynamicNs << std::setw(16) << fastNs << std::setw(16) << isNs << '\n';
+    return dynamicFound == fastFound && fastFound == isFound;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << std::fixed << std::setprecision(2) << "depth" << std::setw(16) << "dynamic_cast ns" << std::setw(16) << "as<T> ns" << std::setw(16) << "is<T> ns" << '\n';
+    return benchmarkDepth<3>(count) && benchmarkDepth<6>(count) && benchmarkDepth<10>(count);
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 2000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- The ids are assigned at the first use of each class, so they differ between runs: never store or send them.
+- LLVM uses a variant of this idea (isa<>, dyn_cast<>) with a "kind" enum per hierarchy: for single inheritance,
+  classes numbered in depth-first order make "is a T" a range check: first(T) <= kind <= last(T).
+- If a design needs many downcasts, a virtual function (or std::variant + std::visit) is often the better fix.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/dynamic-casting/
+- https://www.learncpp.com/cpp-tutorial/virtual-base-classes/
+- https://llvm.org/docs/HowToSetUpLLVMStyleRTTI.html
+- https://itanium-cxx-abi.github.io/cxx-abi/abi.html#rtti
+*/
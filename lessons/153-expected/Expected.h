@@ -0,0 +1,276 @@
+#ifndef EXPECTED_H
+#define EXPECTED_H
+
+#include <exception>
+#include <functional>   // for std::invoke
+#include <memory>       // for std::construct_at, std::destroy_at
+#include <type_traits>
+#include <utility>
+
+// Expected<T, E>: either a value of type T, or an error of type E explaining why there is no value.
+// Modeled on C++23 std::expected (with camelCase names), for C++20.
+// * Like std::optional, but a failure carries a reason. Like an exception, but returning it is as cheap
+//   as returning a value, and the caller sees in the signature that the function can fail.
+// * Compact: a union of T and E plus a bool. Trivially copyable if T and E are.
+// * [[nodiscard]]: ignoring a returned Expected is a warning, so errors are not dropped silently.
+// * Monadic chaining: andThen(), transform(), orElse(), transformError().
+
+template <typename E>
+class Unexpected
+{
+private:
+    E m_error;
+
+public:
+    constexpr explicit Unexpected(E error)
+        : m_error{ std::move(error) }
+    {
+    }
+
+    constexpr const E& error() const& { return m_error; }
+    constexpr E&& error() && { return std::move(m_error); }
+};
+
+// value() on an Expected that holds an error (like std::bad_optional_access for std::optional)
+class BadExpectedAccess : public std::exception
+{
+public:
+    const char* what() const noexcept override { return "Expected::value() called on an error"; }
+};
+
+template <typename T, typename E>
+class [[nodiscard]] Expected
+{
+    static_assert(!std::is_reference_v<T> && !std::is_reference_v<E> && !std::is_void_v<T>);
+
+private:
+    union
+    {
+        T m_value;
+        E m_error;
+    };
+    bool m_hasValue;
+
+public:
+    using ValueType = T;
+    using ErrorType = E;
+
+    constexpr Expected() requires std::is_default_constructible_v<T>
+        : m_value{}, m_hasValue{ true }
+    {
+    }
+
+    // Implicit, so that "return value;" and "return Unexpected{ error };" both work
+    template <typename U = T>
+        requires(std::is_constructible_v<T, U&&> && !std::is_same_v<std::remove_cvref_t<U>, Expected>
+                 && !std::is_same_v<std::remove_cvref_t<U>, Unexpected<E>>)
+    constexpr Expected(U&& value)
+        : m_value(std::forward<U>(value)), m_hasValue{ true }
+    {
+    }
+
+    template <typename G>
+    constexpr Expected(const Unexpected<G>& unexpected)
+        : m_error(unexpected.error()), m_hasValue{ false }
+    {
+    }
+
+    template <typename G>
+    constexpr Expected(Unexpected<G>&& unexpected)
+        : m_error(std::move(unexpected).error()), m_hasValue{ false }
+    {
+    }
+
+    // The special members are trivial when T and E are (C++20: several versions, picked by the requires clause)
+    constexpr Expected(const Expected&) requires(std::is_trivially_copy_constructible_v<T> && std::is_trivially_copy_constructible_v<E>) = default;
+    constexpr Expected(const Expected& other)
+        : m_hasValue{ other.m_hasValue }
+    {
+        if (m_hasValue)
+            std::construct_at(&m_value, other.m_value);
+        else
+            std::construct_at(&m_error, other.m_error);
+    }
+
+    constexpr Expected(Expected&&) requires(std::is_trivially_move_constructible_v<T> && std::is_trivially_move_constructible_v<E>) = default;
+    constexpr Expected(Expected&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_constructible_v<E>)
+        : m_hasValue{ other.m_hasValue }
+    {
+        if (m_hasValue)
+            std::construct_at(&m_value, std::move(other.m_value));
+        else
+            std::construct_at(&m_error, std::move(other.m_error));
+    }
+
+    // Assignment keeps *this unchanged if it throws (the strong guarantee). Like std::expected, it
+    // needs T or E to be nothrow move constructible: see reinitialize().
+    constexpr Expected& operator=(const Expected&) requires(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>) = default;
+    constexpr Expected& operator=(const Expected& other)
+        requires(!(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>)
+                 && (std::is_nothrow_move_constructible_v<T> || std::is_nothrow_move_constructible_v<E>))
+    {
+        if (m_hasValue && other.m_hasValue)
+            m_value = other.m_value;
+        else if (!m_hasValue && !other.m_hasValue)
+            m_error = other.m_error;
+        else if (m_hasValue)
+            reinitialize(m_error, m_value, other.m_error);
+        else
+            reinitialize(m_value, m_error, other.m_value);
+        m_hasValue = other.m_hasValue;
+        return *this;
+    }
+
+    constexpr Expected& operator=(Expected&&) requires(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>) = default;
+    constexpr Expected& operator=(Expected&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+                                                             && std::is_nothrow_move_constructible_v<E> && std::is_nothrow_move_assignable_v<E>)
+        requires(!(std::is_trivially_copyable_v<T> && std::is_trivially_copyable_v<E>)
+                 && (std::is_nothrow_move_constructible_v<T> || std::is_nothrow_move_constructible_v<E>))
+    {
+        if (m_hasValue && other.m_hasValue)
+            m_value = std::move(other.m_value);
+        else if (!m_hasValue && !other.m_hasValue)
+            m_error = std::move(other.m_error);
+        else if (m_hasValue)
+            reinitialize(m_error, m_value, std::move(other.m_error));
+        else
+            reinitialize(m_value, m_error, std::move(other.m_value));
+        m_hasValue = other.m_hasValue;
+        return *this;
+    }
+
+    constexpr ~Expected() requires(std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>) = default;
+    constexpr ~Expected()
+    {
+        destroy();
+    }
+
+    constexpr bool hasValue() const { return m_hasValue; }
+    constexpr explicit operator bool() const { return m_hasValue; }
+
+    // Unchecked access, like std::optional: only when hasValue() (resp. !hasValue() for error())
+    constexpr T& operator*() & { return m_value; }
+    constexpr const T& operator*() const& { return m_value; }
+    constexpr T&& operator*() && { return std::move(m_value); }
+    constexpr T* operator->() { return &m_value; }
+    constexpr const T* operator->() const { return &m_value; }
+
+    constexpr E& error() & { return m_error; }
+    constexpr const E& error() const& { return m_error; }
+    constexpr E&& error() && { return std::move(m_error); }
+
+    // Checked access: throws BadExpectedAccess if there is no value
+    constexpr T& value() &
+    {
+        if (!m_hasValue)
+            throw BadExpectedAccess{};
+        return m_value;
+    }
+
+    constexpr const T& value() const&
+    {
+        if (!m_hasValue)
+            throw BadExpectedAccess{};
+        return m_value;
+    }
+
+    constexpr T&& value() &&
+    {
+        if (!m_hasValue)
+            throw BadExpectedAccess{};
+        return std::move(m_value);
+    }
+
+    template <typename U>
+    constexpr T valueOr(U&& fallback) const&
+    {
+        return m_hasValue ? m_value : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    // f(value) -> Expected<U, E>: the next step that can fail. An error skips it and is passed along.
+    template <typename F>
+    constexpr auto andThen(F&& f) const&
+    {
+        using Result = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+        static_assert(std::is_same_v<typename Result::ErrorType, E>, "andThen() must return an Expected with the same error type");
+        if (m_hasValue)
+            return std::invoke(std::forward<F>(f), m_value);
+        return Result{ Unexpected{ m_error } };
+    }
+
+    // f(value) -> U: a step that cannot fail
+    template <typename F>
+    constexpr auto transform(F&& f) const&
+    {
+        using U = std::remove_cv_t<std::invoke_result_t<F, const T&>>;
+        if (m_hasValue)
+            return Expected<U, E>{ std::invoke(std::forward<F>(f), m_value) };
+        return Expected<U, E>{ Unexpected{ m_error } };
+    }
+
+    // f(error) -> Expected<T, G>: recovery. A value skips it.
+    template <typename F>
+    constexpr auto orElse(F&& f) const&
+    {
+        using Result = std::remove_cvref_t<std::invoke_result_t<F, const E&>>;
+        static_assert(std::is_same_v<typename Result::ValueType, T>, "orElse() must return an Expected with the same value type");
+        if (m_hasValue)
+            return Result{ m_value };
+        return std::invoke(std::forward<F>(f), m_error);
+    }
+
+    // f(error) -> G: converts the error, e.g. to a more general error type
+    template <typename F>
+    constexpr auto transformError(F&& f) const&
+    {
+        using G = std::remove_cv_t<std::invoke_result_t<F, const E&>>;
+        if (m_hasValue)
+            return Expected<T, G>{ m_value };
+        return Expected<T, G>{ Unexpected{ std::invoke(std::forward<F>(f), m_error) } };
+    }
+
+private:
+    // Replaces the active member current (of type Old) by a New constructed from args, when the
+    // assignment switches between value and error. If constructing the New throws, current is left
+    // in place: built aside first when moving a New cannot throw, otherwise current is moved aside
+    // and moved back (moving an Old then cannot throw, from the requires clause of the assignment).
+    template <typename New, typename Old, typename... Args>
+    static constexpr void reinitialize(New& replacement, Old& current, Args&&... args)
+    {
+        if constexpr (std::is_nothrow_constructible_v<New, Args...>)
+        {
+            std::destroy_at(&current);
+            std::construct_at(&replacement, std::forward<Args>(args)...);
+        }
+        else if constexpr (std::is_nothrow_move_constructible_v<New>)
+        {
+            New temporary(std::forward<Args>(args)...);
+            std::destroy_at(&current);
+            std::construct_at(&replacement, std::move(temporary));
+        }
+        else
+        {
+            Old saved(std::move(current));
+            std::destroy_at(&current);
+            try
+            {
+                std::construct_at(&replacement, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                std::construct_at(&current, std::move(saved));
+                throw;
+            }
+        }
+    }
+
+    constexpr void destroy()
+    {
+        if (m_hasValue)
+            std::destroy_at(&m_value);
+        else
+            std::destroy_at(&m_error);
+    }
+};
+
+#endif
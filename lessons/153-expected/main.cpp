@@ -0,0 +1,288 @@
+/* Expected: errors as return values
+
+- lessons/064-std-optional returns std::optional<int> from doIntDivision2: the caller knows it failed, not why.
+- lessons/134-exception-handling throws: the reason travels with the exception, but
+  + throwing is expensive: allocate the exception, walk the unwind tables of every frame, run destructors...
+    (~1-2 microseconds with GCC, and it does not scale across threads on some platforms),
+  + "zero-cost" exceptions are only free while nothing is thrown.
+  => fine for rare, exceptional failures. Not for "10% of the input lines are malformed" in a hot loop.
+- Error codes (return a status, the result through a reference) are cheap but easy to ignore and awkward to chain.
+
+Expected<T, E> holds a T or an E: as cheap as returning a value, the reason is kept, and [[nodiscard]]
+makes ignoring it a warning. C++23 has std::expected; Expected.h is the same idea for C++20.
+*/
+
+#include "Expected.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum class ParseError : std::uint8_t
+{
+    empty,
+    invalidCharacter,
+    outOfRange,
+    divisionByZero,
+};
+
+std::string_view errorText(ParseError error)
+{
+    switch (error)
+    {
+    case ParseError::empty:            return "empty input";
+    case ParseError::invalidCharacter: return "invalid character";
+    case ParseError::outOfRange:       return "out of range";
+    case ParseError::divisionByZero:   return "division by zero";
+    default:                           return "???";
+    }
+}
+
+// doIntDivision2 from lessons/064-std-optional, with a reason for the failure
+Expected<int, ParseError> doIntDivision3(int x, int y)
+{
+    if (y == 0)
+        return Unexpected{ ParseError::divisionByZero };
+    return x / y;
+}
+
+// The same parsing, reporting errors in the three ways
+
+Expected<int, ParseError> parseInt(std::string_view text)
+{
+    if (text.empty())
+        return Unexpected{ ParseError::empty };
+
+    int value{};
+    const auto [end, error]{ std::from_chars(text.data(), text.data() + text.size(), value) };
+    if (error == std::errc::result_out_of_range)
+        return Unexpected{ ParseError::outOfRange };
+    if (error != std::errc{} || end != text.data() + text.size())
+        return Unexpected{ ParseError::invalidCharacter };
+    return value;
+}
+
+class ParseException : public std::runtime_error
+{
+public:
+    ParseError error;
+
+    explicit ParseException(ParseError e)
+        : std::runtime_error{ std::string{ errorText(e) } }, error{ e }
+    {
+    }
+};
+
+int parseIntOrThrow(std::string_view text)
+{
+    const auto result{ parseInt(text) };
+    if (!result)
+        throw ParseException{ result.error() };
+    return *result;
+}
+
+// Error code: the error is returned (std::nullopt on success), the value written through a reference.
+// Not a plain ParseError: ParseError{} is ParseError::empty, a real error.
+[[nodiscard]] std::optional<ParseError> parseIntCode(std::string_view text, int& value)
+{
+    const auto result{ parseInt(text) };
+    if (!result)
+        return result.error();
+    value = *result;
+    return std::nullopt;
+}
+
+bool examples()
+{
+    static_assert(sizeof(Expected<int, ParseError>) == 8);    // 4 (int) + 1 (error/bool) + padding
+    static_assert(std::is_trivially_copyable_v<Expected<int, ParseError>>);
+
+    if (auto result{ doIntDivision3(20, 5) })
+        std::cout << "Result 1: " << *result << '\n';
+    if (auto result{ doIntDivision3(20, 0) }; !result)
+        std::cout << "Result 2: failed, " << errorText(result.error()) << '\n';
+
+    // Chaining: parse two numbers, divide, format. The first failure skips the remaining steps.
+    auto divideText{ [](std::string_view a, std::string_view b) {
+        return parseInt(a)
+            .andThen([b](int x) { return parseInt(b).andThen([x](int y) { return doIntDivision3(x, y); }); })
+            .transform([](int q) { return "quotient " + std::to_string(q); })
+            .transformError([](ParseError e) { return std::string{ errorText(e) }; });
+    } };
+
+    for (auto [a, b] : { std::pair{ "84", "2" }, std::pair{ "84", "0" }, std::pair{ "8x4", "2" }, std::pair{ "99999999999", "1" } })
+    {
+        const auto result{ divideText(a, b) };
+        std::cout << a << " / " << b << ": " << (result ? *result : "error: " + result.error()) << '\n';
+    }
+
+    // orElse: recover from some errors
+    const auto withDefault{ parseInt("").orElse([](ParseError e) -> Expected<int, ParseError> {
+        if (e == ParseError::empty)
+            return 0;
+        return Unexpected{ e };
+    }) };
+
+    // parseInt("12"); // warning: ignoring return value ... declared with attribute 'nodiscard'
+
+    bool threw{ false };
+    try
+    {
+        [[maybe_unused]] const int x{ parseInt("abc").value() };
+    }
+    catch (const BadExpectedAccess&)
+    {
+        threw = true;
+    }
+
+    // value() and error() on a non-const Expected modify it in place
+    auto quotient{ divideText("84", "2") };
+    quotient.value() += '!';
+    auto failure{ divideText("84", "0") };
+    failure.error().insert(0, "84 / 0: ");
+
+    // Assigning an error over a value: if copying the error throws, the value is still there
+    struct ThrowingError
+    {
+        ThrowingError() = default;
+        ThrowingError(const ThrowingError&) { throw std::runtime_error{ "copy" }; }
+        ThrowingError(ThrowingError&&) = default;
+        ThrowingError& operator=(const ThrowingError&) = default;
+        ThrowingError& operator=(ThrowingError&&) = default;
+    };
+    Expected<std::string, ThrowingError> kept{ "value" };
+    const Expected<std::string, ThrowingError> error{ Unexpected{ ThrowingError{} } };
+    bool assignmentThrew{ false };
+    try
+    {
+        kept = error;
+    }
+    catch (const std::runtime_error&)
+    {
+        assignmentThrew = true;
+    }
+
+    // The error code version: no error for "12", ParseError::empty for "" (not mistaken for success)
+    int code{ 0 };
+    const bool codesOk{ !parseIntCode("12", code) && code == 12 && parseIntCode("", code) == ParseError::empty && code == 12 };
+
+    return codesOk && withDefault.valueOr(-1) == 0 && threw && divideText("84", "2").value() == "quotient 42" && quotient.value() == "quotient 42!"
+        && failure.error() == "84 / 0: division by zero" && assignmentThrew && kept.hasValue() && *kept == "value";
+}
+
+
+/* Benchmark
+
+- Parse 10^6 tokens and sum the valid ones, with 0%, 0.1%, 1% and 10% of invalid tokens.
+- Exceptions: cheap while nothing is thrown, then every failure costs thousands of instructions.
+- Expected and error codes: the cost does not depend on the failure rate.
+*/
+
+template <typename F>
+double nsPerToken(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << std::fixed << std::setprecision(2) << "failures" << std::setw(14) << "exceptions" << std::setw(12) << "Expected"
+              << std::setw(14) << "error code" << "   (ns per token)\n";
+
+    bool ok{ true };
+    for (double failureRate : { 0.0, 0.001, 0.01, 0.1 })
+    {
+        std::mt19937 rng{ 19 };
+        std::uniform_int_distribution<int> number{ -100000, 100000 };
+        std::bernoulli_distribution fails{ failureRate };
+
+        std::vector<std::string> tokens(count);
+        for (auto& token : tokens)
+            token = fails(rng) ? "12a" : std::to_string(number(rng));
+
+        long long sums[3]{};
+        std::size_t errors[3]{};
+
+        const double exceptionNs{ nsPerToken(count, [&] {
+            for (const auto& token : tokens)
+            {
+                try
+                {
+                    sums[0] += parseIntOrThrow(token);
+                }
+                catch (const ParseException&)
+                {
+                    ++errors[0];
+                }
+            }
+        }) };
+
+        const double expectedNs{ nsPerToken(count, [&] {
+            for (const auto& token : tokens)
+            {
+                const auto result{ parseInt(token) };
+                if (result)
+                    sums[1] += *result;
+                else
+                    ++errors[1];
+            }
+        }) };
+
+        const double codeNs{ nsPerToken(count, [&] {
+            for (const auto& token : tokens)
+            {
+                int value{};
+                if (!parseIntCode(token, value))
+                    sums[2] += value;
+                else
+                    ++errors[2];
+            }
+        }) };
+
+        std::cout << std::setw(7) << failureRate * 100 << '%' << std::setw(14) << exceptionNs << std::setw(12) << expectedNs << std::setw(14) << codeNs << '\n';
+        ok = ok && sums[0] == sums[1] && sums[1] == sums[2] && errors[0] == errors[1] && errors[1] == errors[2];
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 1000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Use exceptions for errors the caller cannot handle locally (out of memory, broken invariants, failed setup);
+  use Expected for failures that are a normal outcome (parsing, lookups, validation).
+- Keep E small (an enum, or a small struct): every Expected<T, E> is as big as the bigger of T and E.
+- std::expected<void, E> exists for functions that return nothing but can fail; Expected.h leaves it out.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/stdoptional/
+- https://www.learncpp.com/cpp-tutorial/the-need-for-exceptions/
+- https://en.cppreference.com/w/cpp/utility/expected
+- https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0709r4.pdf (Herb Sutter, "Zero-overhead deterministic exceptions")
+*/
@@ -0,0 +1,119 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include "Relocation.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+// The Array<T> of lessons/079-classes-and-header-files, grown into a resizable container.
+// Growing relocates the elements: with realloc (one call, and often no copy at all) when T is
+// trivially relocatable, element by element otherwise.
+template <typename T>
+class Array
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc/realloc only guarantee alignof(std::max_align_t)");
+
+private:
+    T* m_data{};
+    std::size_t m_length{};
+    std::size_t m_capacity{};
+
+    void grow(std::size_t capacity)
+    {
+        if constexpr (isTriviallyRelocatable<T>)
+        {
+            // realloc copies the bytes if it has to move the block; large blocks are remapped, not copied
+            void* data{ std::realloc(static_cast<void*>(m_data), capacity * sizeof(T)) };
+            if (!data)
+                throw std::bad_alloc{};
+            m_data = static_cast<T*>(data);
+        }
+        else
+        {
+            T* data{ static_cast<T*>(std::malloc(capacity * sizeof(T))) };
+            if (!data)
+                throw std::bad_alloc{};
+            try
+            {
+                relocate(m_data, m_length, data);
+            }
+            catch (...)
+            {
+                std::free(data); // the elements are still in m_data
+                throw;
+            }
+            std::free(m_data);
+            m_data = data;
+        }
+        m_capacity = capacity;
+    }
+
+public:
+    Array() = default;
+
+    Array(const Array&) = delete;
+    Array& operator=(const Array&) = delete;
+
+    ~Array()
+    {
+        erase();
+    }
+
+    void erase()
+    {
+        std::destroy_n(m_data, m_length);
+        std::free(m_data);
+        m_data = nullptr;
+        m_length = 0;
+        m_capacity = 0;
+    }
+
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > m_capacity)
+            grow(capacity);
+    }
+
+    template <typename... Args>
+    T& emplaceBack(Args&&... args)
+    {
+        if (m_length == m_capacity)
+        {
+            // args may refer to an element (a.emplaceBack(a[0])), which grow() moves or frees:
+            // build the new element first, then move it into the new storage
+            T value(std::forward<Args>(args)...);
+            grow(m_capacity ? 2 * m_capacity : 4);
+            T* element{ ::new (static_cast<void*>(m_data + m_length)) T(std::move(value)) };
+            ++m_length;
+            return *element;
+        }
+
+        T* element{ ::new (static_cast<void*>(m_data + m_length)) T(std::forward<Args>(args)...) };
+        ++m_length;
+        return *element;
+    }
+
+    void pushBack(T value) { emplaceBack(std::move(value)); }
+
+    T& operator[](std::size_t index)
+    {
+        assert(index < m_length);
+        return m_data[index];
+    }
+
+    const T& operator[](std::size_t index) const
+    {
+        assert(index < m_length);
+        return m_data[index];
+    }
+
+    std::size_t getLength() const { return m_length; }
+    std::size_t getCapacity() const { return m_capacity; }
+};
+
+#endif
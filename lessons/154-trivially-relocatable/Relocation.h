@@ -0,0 +1,105 @@
+#ifndef RELOCATION_H
+#define RELOCATION_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Relocation = move an object to a new address and destroy the old one (what a container does when it grows).
+// For most types, that is the same as copying the bytes and forgetting the old object: "trivially relocatable".
+// * Automatic for trivially copyable types.
+// * Opt-in for other types, either with a member alias:   using TriviallyRelocatable = std::true_type;
+//   or by specializing IsTriviallyRelocatable (for types you cannot change, like std::unique_ptr).
+// * Do NOT opt in for types that point into themselves (std::string with its small buffer, std::list in libstdc++,
+//   objects that register their address somewhere): their bytes are only valid at their address.
+template <typename T>
+struct IsTriviallyRelocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T>>
+{
+};
+
+template <typename T>
+    requires requires { typename T::TriviallyRelocatable; }
+struct IsTriviallyRelocatable<T>
+    : std::bool_constant<T::TriviallyRelocatable::value>
+{
+};
+
+// std::unique_ptr with the default deleter is a single pointer
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type
+{
+};
+
+template <typename T>
+inline constexpr bool isTriviallyRelocatable{ IsTriviallyRelocatable<T>::value };
+
+// Relocates count objects from source to the uninitialized memory at destination (the ranges must not overlap).
+// Afterwards the source objects are gone: do not destroy them.
+template <typename T>
+void relocate(T* source, std::size_t count, T* destination)
+{
+    if constexpr (isTriviallyRelocatable<T>)
+    {
+        // One memcpy instead of count moves and count destructor calls. (Formally, C++ only allows this for
+        // trivially copyable types; C++26 standardizes trivial relocation. It works on all major compilers.)
+        if (count > 0)
+            std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+    }
+    else
+    {
+        // As std::vector does: move if that cannot throw, otherwise copy (lessons/138-move-if-noexcept).
+        // If a copy throws, uninitialized_copy destroys what it built and the source is intact.
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            std::uninitialized_move_n(source, count, destination);
+        else
+            std::uninitialized_copy_n(source, count, destination);
+        std::destroy_n(source, count);
+    }
+}
+
+
+/* Relocation audit
+
+How a container grows with elements of type T, known at compile time:
+- trivially relocatable: memcpy (and realloc, which can even grow the block in place),
+- nothrow move: one move constructor and one destructor per element,
+- otherwise: one COPY per element (strong exception guarantee), usually a performance bug:
+  a move constructor that is not noexcept (forgotten, or implicitly not noexcept because of a member).
+*/
+
+enum class Relocation
+{
+    triviallyRelocatable,
+    nothrowMove,
+    copy,         // the move constructor may throw (or there is none): growing copies every element
+    throwingMove, // move-only and the move may throw: moved anyway, without the strong exception guarantee
+    impossible,   // neither movable nor copyable
+};
+
+template <typename T>
+consteval Relocation relocationOf()
+{
+    if constexpr (isTriviallyRelocatable<T>)
+        return Relocation::triviallyRelocatable;
+    else if constexpr (std::is_nothrow_move_constructible_v<T>)
+        return Relocation::nothrowMove;
+    else if constexpr (std::is_copy_constructible_v<T>)
+        return Relocation::copy;
+    else if constexpr (std::is_move_constructible_v<T>)
+        return Relocation::throwingMove;
+    else
+        return Relocation::impossible;
+}
+
+// For a static_assert in the code that owns the types: static_assert(relocatesEfficiently<MyString, Widget>());
+template <typename... Ts>
+consteval bool relocatesEfficiently()
+{
+    return ((relocationOf<Ts>() == Relocation::triviallyRelocatable || relocationOf<Ts>() == Relocation::nothrowMove) && ...);
+}
+
+#endif
@@ -0,0 +1,299 @@
+/* Trivially relocatable types
+
+- lessons/120-move-constructor-and-move-assignment: mySwapMove moves instead of copying.
+- lessons/138-move-if-noexcept: std::vector grows with std::move_if_noexcept, so it moves each element
+  (if the move constructor is noexcept) or copies it.
+- Even moving is wasteful for most types: moving a std::unique_ptr to a new buffer copies the pointer,
+  writes nullptr into the old one, then runs the old one's destructor, which checks for nullptr... per element.
+  The end result is exactly what memcpy of the whole buffer would give.
+
+- A type is "trivially relocatable" when moving it and destroying the source equals copying its bytes.
+  True for almost every type: unique_ptr, shared_ptr, vector, MyString...
+  False for types that store their own address (or the address of one of their members).
+- Array<T> (Array.h) asks IsTriviallyRelocatable<T> and grows with a single realloc for those types.
+*/
+
+#include "Array.h"
+#include "Relocation.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// MyString from lessons/117-shallow-vs-deep-copy, with the move operations of lessons/120
+class MyString
+{
+private:
+    char* m_data{};
+    int m_length{};
+
+public:
+    using TriviallyRelocatable = std::true_type; // a pointer and a length: the bytes can move anywhere
+
+    MyString(const char* source = "")
+    {
+        assert(source);
+        m_length = static_cast<int>(std::strlen(source)) + 1;
+        m_data = new char[static_cast<std::size_t>(m_length)];
+        std::memcpy(m_data, source, static_cast<std::size_t>(m_length));
+    }
+
+    MyString(const MyString&) = delete;
+    MyString& operator=(const MyString&) = delete;
+
+    MyString(MyString&& source) noexcept
+        : m_data{ source.m_data }, m_length{ source.m_length }
+    {
+        source.m_data = nullptr;
+        source.m_length = 0;
+    }
+
+    ~MyString()
+    {
+        delete[] m_data;
+    }
+
+    const char* getString() const { return m_data; }
+    int getLength() const { return m_length; }
+};
+
+// Auto_ptr4 from lessons/120-move-constructor-and-move-assignment (copy disabled, as that lesson recommends)
+template <typename T>
+class Auto_ptr4
+{
+    T* m_ptr{};
+
+public:
+    using TriviallyRelocatable = std::true_type;
+
+    Auto_ptr4(T* ptr = nullptr)
+        : m_ptr{ ptr }
+    {
+    }
+
+    ~Auto_ptr4()
+    {
+        delete m_ptr;
+    }
+
+    Auto_ptr4(const Auto_ptr4&) = delete;
+    Auto_ptr4& operator=(const Auto_ptr4&) = delete;
+
+    Auto_ptr4(Auto_ptr4&& a) noexcept
+        : m_ptr(a.m_ptr)
+    {
+        a.m_ptr = nullptr;
+    }
+
+    Auto_ptr4& operator=(Auto_ptr4&& a) noexcept
+    {
+        if (&a == this)
+            return *this;
+        delete m_ptr;
+        m_ptr = a.m_ptr;
+        a.m_ptr = nullptr;
+        return *this;
+    }
+
+    T& operator*() const { return *m_ptr; }
+};
+
+// NOT trivially relocatable: m_current points into the object itself
+class SmallBuffer
+{
+    char m_buffer[16]{};
+    char* m_current{ m_buffer };
+
+public:
+    SmallBuffer() = default;
+    SmallBuffer(SmallBuffer&& other) noexcept
+        : m_current{ m_buffer + (other.m_current - other.m_buffer) }
+    {
+        std::memcpy(m_buffer, other.m_buffer, sizeof(m_buffer));
+    }
+    ~SmallBuffer() = default;
+
+    bool valid() const { return m_current >= m_buffer && m_current <= m_buffer + sizeof(m_buffer); }
+};
+
+// A move constructor without noexcept: containers copy it instead
+class Widget
+{
+    std::vector<int> m_values{ 1, 2, 3 };
+
+public:
+    Widget() = default;
+    Widget(const Widget&) = default;
+    Widget(Widget&& other) // forgot noexcept
+        : m_values{ std::move(other.m_values) }
+    {
+    }
+};
+
+std::string_view toString(Relocation relocation)
+{
+    switch (relocation)
+    {
+    case Relocation::triviallyRelocatable: return "memcpy";
+    case Relocation::nothrowMove:          return "move + destroy";
+    case Relocation::copy:                 return "COPY (move constructor not noexcept)";
+    case Relocation::throwingMove:         return "move, may throw";
+    case Relocation::impossible:           return "cannot relocate";
+    default:                               return "???";
+    }
+}
+
+// The audit: computed at compile time, printed for the lesson
+template <typename T>
+void printAudit(std::string_view name)
+{
+    constexpr Relocation relocation{ relocationOf<T>() };
+    std::cout << std::setw(22) << name << ": " << toString(relocation) << '\n';
+}
+
+bool examples()
+{
+    printAudit<int>("int");
+    printAudit<MyString>("MyString");
+    printAudit<Auto_ptr4<int>>("Auto_ptr4<int>");
+    printAudit<std::unique_ptr<int>>("std::unique_ptr<int>");
+    printAudit<std::string>("std::string");
+    printAudit<SmallBuffer>("SmallBuffer");
+    printAudit<Widget>("Widget");
+
+    static_assert(relocatesEfficiently<int, MyString, Auto_ptr4<int>, std::unique_ptr<int>, SmallBuffer>());
+    static_assert(!relocatesEfficiently<Widget>()); // the audit catches the missing noexcept at compile time
+
+    Array<MyString> strings{};
+    for (const char* s : { "Hello", "relocatable", "world" })
+        strings.emplaceBack(s);
+    for (int i{ 0 }; i < 100; ++i) // grows several times: realloc
+        strings.emplaceBack("x");
+
+    Array<SmallBuffer> buffers{};
+    for (int i{ 0 }; i < 100; ++i) // grows with the move constructor, which fixes m_current
+        buffers.emplaceBack();
+
+    // An element of the array itself, when it is full: grow() moves it before it is copied
+    Array<std::string> words{};
+    for (const char* s : { "Hello", "relocatable", "world", "!" })
+        words.emplaceBack(s);
+    words.emplaceBack(words[0]);
+
+    bool ok{ std::string_view{ strings[1].getString() } == "relocatable" && strings.getLength() == 103
+             && words.getLength() == 5 && words[4] == "Hello" && words[0] == "Hello" };
+    for (std::size_t i{ 0 }; i < buffers.getLength(); ++i)
+        ok = ok && buffers[i].valid();
+    return ok;
+}
+
+
+/* Benchmark
+
+- push back 10^7 std::unique_ptr<int> (without reserve): ~22 reallocations, 2 * 10^7 elements relocated in total.
+- Array<std::unique_ptr<int>>: realloc. Array<Boxed> (the same pointer, not declared relocatable):
+  move + destroy per element, like std::vector.
+- Array<Widget> vs Array<NoexceptWidget>: the cost of a forgotten noexcept.
+*/
+
+struct Boxed
+{
+    std::unique_ptr<int> pointer{};
+};
+
+struct NoexceptWidget
+{
+    std::vector<int> values{ 1, 2, 3 }; // implicit move constructor: noexcept
+};
+
+template <typename F>
+double measureMilliseconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << std::fixed << std::setprecision(1);
+    bool ok{ true };
+
+    // Empty pointers: only the cost of growing is measured, not the allocation of what they point to
+    const double vectorMs{ measureMilliseconds([&] {
+        std::vector<std::unique_ptr<int>> v{};
+        for (std::size_t i{ 0 }; i < count; ++i)
+            v.emplace_back();
+        ok = ok && v.size() == count;
+    }) };
+
+    const double boxedMs{ measureMilliseconds([&] {
+        Array<Boxed> a{};
+        for (std::size_t i{ 0 }; i < count; ++i)
+            a.emplaceBack();
+        ok = ok && a.getLength() == count;
+    }) };
+
+    const double relocatableMs{ measureMilliseconds([&] {
+        Array<std::unique_ptr<int>> a{};
+        for (std::size_t i{ 0 }; i < count; ++i)
+            a.emplaceBack();
+        ok = ok && a.getLength() == count;
+    }) };
+
+    std::cout << "push back " << count << " std::unique_ptr<int>:\n"
+              << "  std::vector:                 " << vectorMs << " ms\n"
+              << "  Array, move + destroy:       " << boxedMs << " ms\n"
+              << "  Array, trivially relocated:  " << relocatableMs << " ms\n";
+
+    const std::size_t widgets{ count / 10 };
+    const double copyMs{ measureMilliseconds([&] {
+        Array<Widget> a{};
+        for (std::size_t i{ 0 }; i < widgets; ++i)
+            a.emplaceBack();
+    }) };
+    const double moveMs{ measureMilliseconds([&] {
+        Array<NoexceptWidget> a{};
+        for (std::size_t i{ 0 }; i < widgets; ++i)
+            a.emplaceBack();
+    }) };
+    std::cout << "push back " << widgets << " widgets: move constructor without noexcept " << copyMs << " ms, with noexcept " << moveMs << " ms\n";
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- std::vector cannot use realloc: it uses std::allocator (operator new), which has no "resize in place".
+  Libraries with their own vectors do this: Folly (fbvector, IsRelocatable), Qt (Q_RELOCATABLE_TYPE),
+  Bloomberg BDE (bslmf::IsBitwiseMoveable), Abseil (absl::is_trivially_relocatable).
+- C++26 adds trivial relocatability to the language (std::is_trivially_relocatable, std::trivially_relocate).
+- libstdc++'s std::string keeps a pointer to its own small buffer: NOT trivially relocatable (libc++'s is).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/move-constructors-and-move-assignment/
+- https://www.learncpp.com/cpp-tutorial/stdmove_if_noexcept/
+- https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2024/p1144r10.html (Arthur O'Dwyer, "std::is_trivially_relocatable")
+- https://github.com/facebook/folly/blob/main/folly/docs/FBVector.md
+*/
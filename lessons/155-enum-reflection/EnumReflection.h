@@ -0,0 +1,204 @@
+#ifndef ENUM_REFLECTION_H
+#define ENUM_REFLECTION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Requires C++20, GCC or Clang.
+// * EnumReflection::names<E>, values<E>, count<E>: the enumerators of E, found at compile time.
+// * toString(e): one table lookup (no switch to write, no switch to forget to update).
+// * fromString<E>(text): one hash, one string comparison (a perfect hash, searched at compile time).
+// The tables are constexpr: computed by the compiler, no runtime initialization.
+//
+// How: inside a function template, __PRETTY_FUNCTION__ spells out the template arguments, so
+// name<Color, static_cast<Color>(2)>() sees "... V = Color::blue]" if 2 is an enumerator, and "(Color)2" if not.
+// Every value in EnumRange<E> is tried, which limits it to enumerators in [-128, 127] by default:
+// specialize EnumRange for enums with larger values (at the cost of compile time).
+namespace EnumReflection
+{
+    template <typename E>
+    struct EnumRange
+    {
+        static constexpr int min{ -128 };
+        static constexpr int max{ 127 };
+    };
+
+    namespace detail
+    {
+        template <typename E, E V>
+        consteval std::string_view prettyName()
+        {
+            return __PRETTY_FUNCTION__;
+        }
+
+        // "... [with E = Color; E V = Color::blue; ...]" (GCC) or "... [E = Color, V = Color::blue]" (Clang)
+        template <typename E, E V>
+        consteval std::string_view name()
+        {
+            std::string_view pretty{ prettyName<E, V>() };
+            const std::size_t start{ pretty.find("V = ") + 4 };
+            std::size_t end{ pretty.find_first_of(";]", start) };
+            pretty = pretty.substr(start, end - start);
+
+            // Not an enumerator: "(Color)5" (GCC) or "(Color)5" / "5" (Clang)
+            if (pretty.empty() || pretty.front() == '(' || pretty.front() == '-' || (pretty.front() >= '0' && pretty.front() <= '9'))
+                return {};
+
+            const std::size_t scope{ pretty.rfind("::") };
+            return (scope == std::string_view::npos) ? pretty : pretty.substr(scope + 2); // "Color::blue" -> "blue"
+        }
+
+        template <typename E>
+        consteval int rangeMin()
+        {
+            using U = std::underlying_type_t<E>;
+            return (EnumRange<E>::min < static_cast<long long>(std::numeric_limits<U>::min()))
+                ? static_cast<int>(std::numeric_limits<U>::min()) : EnumRange<E>::min;
+        }
+
+        template <typename E>
+        consteval int rangeMax()
+        {
+            using U = std::underlying_type_t<E>;
+            return (EnumRange<E>::max > static_cast<long long>(std::numeric_limits<U>::max()))
+                ? static_cast<int>(std::numeric_limits<U>::max()) : EnumRange<E>::max;
+        }
+
+        template <typename E, int... Is>
+        consteval auto allNames(std::integer_sequence<int, Is...>)
+        {
+            return std::array<std::string_view, sizeof...(Is)>{ name<E, static_cast<E>(rangeMin<E>() + Is)>()... };
+        }
+
+        template <typename E>
+        inline constexpr auto candidates{ allNames<E>(std::make_integer_sequence<int, rangeMax<E>() - rangeMin<E>() + 1>{}) };
+
+        template <typename E>
+        consteval std::size_t countValid()
+        {
+            std::size_t n{ 0 };
+            for (std::string_view s : candidates<E>)
+                n += !s.empty();
+            return n;
+        }
+    }
+
+    // Number of enumerators (aliases, like "max_students = cartman + 1" with the same value, count once)
+    template <typename E>
+    inline constexpr std::size_t count{ detail::countValid<E>() };
+
+    // In increasing order of value
+    template <typename E>
+    inline constexpr auto values{ [] {
+        std::array<E, count<E>> result{};
+        std::size_t n{ 0 };
+        for (std::size_t i{ 0 }; i < detail::candidates<E>.size(); ++i)
+            if (!detail::candidates<E>[i].empty())
+                result[n++] = static_cast<E>(detail::rangeMin<E>() + static_cast<int>(i));
+        return result;
+    }() };
+
+    template <typename E>
+    inline constexpr auto names{ [] {
+        std::array<std::string_view, count<E>> result{};
+        std::size_t n{ 0 };
+        for (std::string_view s : detail::candidates<E>)
+            if (!s.empty())
+                result[n++] = s;
+        return result;
+    }() };
+
+    namespace detail
+    {
+        // Dense table from value to name, indexed by value - values.front(): O(1) for any enum
+        // whose values are not too spread out (always true inside EnumRange).
+        template <typename E>
+        inline constexpr auto nameByValue{ [] {
+            constexpr int first{ static_cast<int>(values<E>.front()) };
+            constexpr int last{ static_cast<int>(values<E>.back()) };
+            std::array<std::string_view, static_cast<std::size_t>(last - first + 1)> result{};
+            result.fill(""); // the gaps (GCC 12 refuses to read the value-initialized ones in a constant expression)
+            for (std::size_t i{ 0 }; i < count<E>; ++i)
+                result[static_cast<std::size_t>(static_cast<int>(values<E>[i]) - first)] = names<E>[i];
+            return result;
+        }() };
+
+        // FNV-1a with a seed; the seed is the knob the perfect hash search turns
+        constexpr std::uint32_t hash(std::string_view text, std::uint32_t seed)
+        {
+            std::uint32_t h{ 2166136261u ^ seed };
+            for (char c : text)
+                h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+            return h ^ (h >> 15);
+        }
+
+        constexpr std::size_t bitCeil(std::size_t n)
+        {
+            std::size_t power{ 1 };
+            while (power < n)
+                power *= 2;
+            return power;
+        }
+
+        template <std::size_t Slots>
+        struct PerfectHash
+        {
+            std::uint32_t seed{};
+            std::array<std::uint8_t, Slots> slots{}; // index into names + 1, or 0 for an empty slot
+        };
+
+        // Tries seeds until every name lands in its own slot. With at least twice as many slots as names,
+        // a few tries (for small enums) to a few hundred (for ~100 enumerators) are enough.
+        template <typename E>
+        inline constexpr auto perfectHash{ [] {
+            static_assert(count<E> < 255, "slots store an index in a std::uint8_t");
+            constexpr std::size_t slotCount{ bitCeil(2 * count<E> + 1) };
+            PerfectHash<slotCount> result{};
+            for (std::uint32_t seed{ 0 }; seed < 100000; ++seed)
+            {
+                result = { seed, {} };
+                bool collision{ false };
+                for (std::size_t i{ 0 }; i < count<E> && !collision; ++i)
+                {
+                    auto& slot{ result.slots[hash(names<E>[i], seed) & (slotCount - 1)] };
+                    collision = slot != 0;
+                    slot = static_cast<std::uint8_t>(i + 1);
+                }
+                if (!collision)
+                    return result;
+            }
+            throw "no perfect hash found: enlarge the table"; // a compile error, since this runs at compile time
+        }() };
+    }
+
+    // "" for values that are not enumerators
+    template <typename E>
+        requires std::is_enum_v<E>
+    constexpr std::string_view toString(E value)
+    {
+        const auto index{ static_cast<long long>(value) - static_cast<long long>(values<E>.front()) };
+        if (index < 0 || index >= static_cast<long long>(detail::nameByValue<E>.size()))
+            return std::string_view{};
+        return detail::nameByValue<E>[static_cast<std::size_t>(index)];
+    }
+
+    template <typename E>
+        requires std::is_enum_v<E>
+    constexpr std::optional<E> fromString(std::string_view text)
+    {
+        const auto& perfectHash{ detail::perfectHash<E> };
+        const std::size_t slot{ detail::hash(text, perfectHash.seed) & (perfectHash.slots.size() - 1) };
+        const std::size_t entry{ perfectHash.slots[slot] };
+        if (entry == 0 || names<E>[entry - 1] != text) // only one candidate to compare with
+            return std::nullopt;
+        return values<E>[entry - 1];
+    }
+}
+
+#endif
@@ -0,0 +1,332 @@
+/* Enum reflection: enum <-> string without writing the switch
+
+- lessons/067-scoped-enumerations (getAnimal) converts an enum to a string with a switch: one case per
+  enumerator, to keep in sync by hand. Parsing the other way is a chain of comparisons, or a
+  std::unordered_map<std::string_view, Animals> built at startup.
+- EnumReflection.h asks the compiler for the names (see the header) and builds, at compile time:
+  + a table indexed by value: toString is one load,
+  + a perfect hash of the names (no collisions, by construction): fromString hashes the text once and
+    compares with a single candidate.
+- Adding an enumerator updates everything: nothing to forget.
+*/
+
+#include "EnumReflection.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using EnumReflection::fromString;
+using EnumReflection::toString;
+
+// From lessons/066-unscoped-enumerations, lessons/067-scoped-enumerations and lessons/090-array-and-enumerators
+enum Color : int // a fixed underlying type: see the notes
+{
+    red,
+    green,
+    blue,
+};
+
+enum class Animals
+{
+    chicken,
+    dog,
+};
+
+enum class StudentNames2
+{
+    kenny,
+    kyle,
+    stan,
+    butters,
+    cartman,
+    max_students,
+};
+
+// getAnimal from lessons/067-scoped-enumerations: the hand-written way
+constexpr std::string_view getAnimal(Animals animal)
+{
+    using enum Animals;
+
+    switch (animal)
+    {
+    case chicken: return "chicken";
+    case dog:     return "dog";
+    default:      return "???";
+    }
+}
+
+// Values do not have to be contiguous, or start at 0
+enum class HttpStatus : short
+{
+    ok = 200,
+    created = 201,
+    noContent = 204,
+    badRequest = 400,
+    notFound = 404,
+    internalError = 500,
+};
+
+template <>
+struct EnumReflection::EnumRange<HttpStatus>
+{
+    static constexpr int min{ 100 };
+    static constexpr int max{ 599 };
+};
+
+bool examples()
+{
+    // Everything below is known at compile time
+    static_assert(EnumReflection::count<Color> == 3);
+    static_assert(toString(Animals::dog) == getAnimal(Animals::dog));
+    static_assert(toString(StudentNames2::max_students) == "max_students");
+    static_assert(fromString<StudentNames2>("cartman") == StudentNames2::cartman);
+    static_assert(!fromString<StudentNames2>("eric"));
+    static_assert(toString(HttpStatus::notFound) == "notFound" && toString(static_cast<HttpStatus>(405)).empty());
+
+    for (auto name : EnumReflection::names<StudentNames2>)
+        std::cout << name << ' ';
+    std::cout << '\n';
+
+    for (auto status : EnumReflection::values<HttpStatus>)
+        std::cout << static_cast<int>(status) << ' ' << toString(status) << '\n';
+
+    const std::string input{ "green" }; // at runtime
+    const std::optional<Color> color{ fromString<Color>(input) };
+    std::cout << input << " -> " << (color ? static_cast<int>(*color) : -1) << '\n';
+
+    return color == green && !fromString<Color>("Green") && toString(blue) == "blue";
+}
+
+
+/* Benchmark
+
+- Log lines "<level> <message>": parse the level (6 enumerators).
+- Config lines "<key> = <value>": parse the key (24 enumerators).
+- Three parsers: a chain of comparisons (what the switch turns into for strings), std::unordered_map, fromString.
+- And toString of the parsed values: switch vs table.
+*/
+
+enum class LogLevel
+{
+    trace,
+    debug,
+    info,
+    warning,
+    error,
+    critical,
+};
+
+enum class ConfigKey
+{
+    host,
+    port,
+    user,
+    password,
+    database,
+    timeout,
+    retries,
+    logLevel,
+    logFile,
+    cacheSize,
+    threads,
+    queueLength,
+    compression,
+    encryption,
+    certificate,
+    privateKey,
+    maxConnections,
+    keepAlive,
+    bufferSize,
+    locale,
+    timezone,
+    dataDirectory,
+    tempDirectory,
+    verbose,
+};
+
+std::optional<LogLevel> parseLogLevelByHand(std::string_view text)
+{
+    using enum LogLevel;
+    if (text == "trace")    return trace;
+    if (text == "debug")    return debug;
+    if (text == "info")     return info;
+    if (text == "warning")  return warning;
+    if (text == "error")    return error;
+    if (text == "critical") return critical;
+    return std::nullopt;
+}
+
+std::optional<ConfigKey> parseConfigKeyByHand(std::string_view text)
+{
+    using enum ConfigKey;
+    if (text == "host")           return host;
+    if (text == "port")           return port;
+    if (text == "user")           return user;
+    if (text == "password")       return password;
+    if (text == "database")       return database;
+    if (text == "timeout")        return timeout;
+    if (text == "retries")        return retries;
+    if (text == "logLevel")       return logLevel;
+    if (text == "logFile")        return logFile;
+    if (text == "cacheSize")      return cacheSize;
+    if (text == "threads")        return threads;
+    if (text == "queueLength")    return queueLength;
+    if (text == "compression")    return compression;
+    if (text == "encryption")     return encryption;
+    if (text == "certificate")    return certificate;
+    if (text == "privateKey")     return privateKey;
+    if (text == "maxConnections") return maxConnections;
+    if (text == "keepAlive")      return keepAlive;
+    if (text == "bufferSize")     return bufferSize;
+    if (text == "locale")         return locale;
+    if (text == "timezone")       return timezone;
+    if (text == "dataDirectory")  return dataDirectory;
+    if (text == "tempDirectory")  return tempDirectory;
+    if (text == "verbose")        return verbose;
+    return std::nullopt;
+}
+
+std::string_view logLevelName(LogLevel level)
+{
+    using enum LogLevel;
+    switch (level)
+    {
+    case trace:    return "trace";
+    case debug:    return "debug";
+    case info:     return "info";
+    case warning:  return "warning";
+    case error:    return "error";
+    case critical: return "critical";
+    default:       return "???";
+    }
+}
+
+// What a program without reflection builds at startup
+template <typename E>
+std::unordered_map<std::string_view, E> makeMap()
+{
+    std::unordered_map<std::string_view, E> map{};
+    for (std::size_t i{ 0 }; i < EnumReflection::count<E>; ++i)
+        map.emplace(EnumReflection::names<E>[i], EnumReflection::values<E>[i]);
+    return map;
+}
+
+// lines: "<token><separator>...", a few percent of them with an unknown token
+template <typename E>
+std::vector<std::string> makeLines(std::size_t count, std::string_view separator, std::string_view rest)
+{
+    std::mt19937 rng{ 3 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, EnumReflection::count<E> - 1 };
+    std::bernoulli_distribution unknown{ 0.02 };
+
+    std::vector<std::string> lines(count);
+    for (auto& line : lines)
+        line = std::string{ unknown(rng) ? std::string_view{ "unknownToken" } : EnumReflection::names<E>[pick(rng)] }
+            .append(separator).append(rest);
+    return lines;
+}
+
+template <typename E, typename Parse>
+double parseAll(const std::vector<std::string>& lines, std::string_view separator, Parse&& parse, std::vector<std::size_t>& histogram)
+{
+    histogram.assign(EnumReflection::count<E> + 1, 0);
+    const auto start{ std::chrono::steady_clock::now() };
+    for (const auto& line : lines)
+    {
+        const std::string_view text{ line };
+        const std::optional<E> value{ parse(text.substr(0, text.find(separator))) };
+        ++histogram[value ? static_cast<std::size_t>(*value) : EnumReflection::count<E>];
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(lines.size());
+}
+
+template <typename E, typename ParseByHand>
+bool benchmarkParsing(std::string_view title, std::size_t count, std::string_view separator, std::string_view rest, ParseByHand&& parseByHand)
+{
+    const auto lines{ makeLines<E>(count, separator, rest) };
+    const auto map{ makeMap<E>() };
+    std::vector<std::size_t> histograms[3]{};
+
+    const double byHandNs{ parseAll<E>(lines, separator, parseByHand, histograms[0]) };
+    const double mapNs{ parseAll<E>(lines, separator, [&](std::string_view s) -> std::optional<E> {
+        const auto found{ map.find(s) };
+        if (found == map.end())
+            return std::nullopt;
+        return found->second;
+    }, histograms[1]) };
+    const double reflectionNs{ parseAll<E>(lines, separator, [](std::string_view s) { return fromString<E>(s); }, histograms[2]) };
+
+    std::cout << std::setw(28) << title << std::setw(12) << byHandNs << std::setw(16) << mapNs << std::setw(14) << reflectionNs << '\n';
+    return histograms[0] == histograms[1] && histograms[1] == histograms[2];
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << std::fixed << std::setprecision(2) << std::setw(28) << "parse (ns per line)" << std::setw(12) << "by hand"
+              << std::setw(16) << "unordered_map" << std::setw(14) << "fromString" << '\n';
+
+    bool ok{ benchmarkParsing<LogLevel>("log level (6 names)", count, " ", "connection accepted from 10.0.0.1", parseLogLevelByHand) };
+    ok = benchmarkParsing<ConfigKey>("config key (24 names)", count, " = ", "42", parseConfigKeyByHand) && ok;
+
+    std::mt19937 rng{ 4 };
+    std::uniform_int_distribution<int> pick{ 0, static_cast<int>(EnumReflection::count<LogLevel>) - 1 };
+    std::vector<LogLevel> levels(count);
+    for (auto& level : levels)
+        level = static_cast<LogLevel>(pick(rng));
+
+    std::size_t lengths[2]{};
+    const auto start{ std::chrono::steady_clock::now() };
+    for (LogLevel level : levels)
+        lengths[0] += logLevelName(level).size();
+    const auto middle{ std::chrono::steady_clock::now() };
+    for (LogLevel level : levels)
+        lengths[1] += toString(level).size();
+    const auto end{ std::chrono::steady_clock::now() };
+
+    const auto perValue{ [&](auto duration) { return std::chrono::duration<double, std::nano>(duration).count() / static_cast<double>(count); } };
+    std::cout << std::setw(28) << "toString (ns per value)" << std::setw(12) << perValue(middle - start) << std::setw(30) << perValue(end - middle) << '\n';
+
+    return ok && lengths[0] == lengths[1];
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 2000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- The chain of comparisons gets slower with every enumerator (and with random input, the branch predictor
+  cannot help); std::unordered_map hashes the whole text, then follows a pointer to a node.
+  The perfect hash: one hash, one table load, one comparison, whatever the number of enumerators.
+- __PRETTY_FUNCTION__ is not standard, but GCC, Clang (and MSVC's __FUNCSIG__) all spell the enumerator out.
+  Libraries doing this: magic_enum, enchantum. C++26 reflection (std::meta::enumerators_of) makes it standard.
+- Every value of EnumRange<E> instantiates a function: wide ranges cost compile time.
+- Flags enums (values 1, 2, 4, ... 1 << 30) do not fit a range: they need a range of bit positions instead.
+- Unscoped enums without a fixed underlying type (enum Color { red, green, blue }) only have the values
+  0..3: casting 4 is unspecified (GCC warns), and Clang rejects it in a constant expression.
+  Give them a fixed type (enum Color : int), as above, or a narrower EnumRange.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/scoped-enumerations-enum-classes/
+- https://www.learncpp.com/cpp-tutorial/converting-an-enumeration-to-and-from-a-string/
+- https://github.com/Neargye/magic_enum
+- https://en.wikipedia.org/wiki/Perfect_hash_function
+*/
@@ -0,0 +1,256 @@
+#ifndef STATIC_MAP_H
+#define STATIC_MAP_H
+
+#include <array>
+#include <bit>         // for std::endian
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits> // for std::is_constant_evaluated
+#include <utility>
+#include <vector>
+
+// StaticMap<Value, N>: a map from N string keys, fixed at compile time, to values.
+// * Built by a constexpr constructor: "constexpr auto map{ makeStaticMap<int>({ { "add", 1 }, ... }) };"
+//   computes everything at compile time. No heap, no startup cost, the tables live in read-only memory.
+// * A minimal perfect hash: the N keys land in N slots without collisions, so find() is
+//   hash the key, read one pilot, compute the slot, compare one key. Same cost for 10 or 10,000 keys.
+// * Keys are std::string_views: the strings must outlive the map (string literals do).
+//   Value must be default constructible (the slots are a std::array).
+// * The map holds its slots: a big one built at run time belongs in static storage or on the heap,
+//   not in a local variable.
+//
+// The perfect hash ("hash and displace", as in CHD and PTHash):
+// * every key has a 64-bit hash h; its low bits pick a bucket (about 2 keys per bucket),
+// * each bucket gets a "pilot", a small number chosen at build time so that
+//   slot = mix(h + pilot * constant) % N lands all the keys of the bucket on free slots,
+// * buckets are placed biggest first, while the table is still empty: hard cases first.
+namespace StaticMapHash
+{
+    // Little-endian load of n <= 8 characters. At compile time, with shifts (memcpy is not constexpr);
+    // at run time, with memcpy, which compiles to a single load.
+    constexpr std::uint64_t load(const char* p, std::size_t n)
+    {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+        {
+            std::uint64_t word{ 0 };
+            if (n == 8)
+                std::memcpy(&word, p, 8);
+            else
+            {
+                std::uint32_t half{};
+                std::memcpy(&half, p, 4);
+                word = half;
+            }
+            return word;
+        }
+
+        std::uint64_t word{ 0 };
+        for (std::size_t j{ 0 }; j < n; ++j)
+            word |= std::uint64_t{ static_cast<unsigned char>(p[j]) } << (8 * j);
+        return word;
+    }
+
+    constexpr std::uint64_t round(std::uint64_t h, std::uint64_t word)
+    {
+        h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    // 8 characters per step, no loop over the last few characters: the last 8 (or 4) characters
+    // are read as one word, overlapping the previous one. Keys of 1 to 3 characters use first, middle, last.
+    constexpr std::uint64_t hash(std::string_view key)
+    {
+        const char* p{ key.data() };
+        const std::size_t n{ key.size() };
+        std::uint64_t h{ n * 0x9E3779B97F4A7C15ull };
+        if (n >= 8)
+        {
+            for (std::size_t i{ 0 }; i + 8 < n; i += 8)
+                h = round(h, load(p + i, 8));
+            h = round(h, load(p + n - 8, 8));
+        }
+        else if (n >= 4)
+            h = round(h, load(p, 4) | (load(p + n - 4, 4) << 32));
+        else if (n > 0)
+            h = round(h, std::uint64_t{ static_cast<unsigned char>(p[0]) } | (std::uint64_t{ static_cast<unsigned char>(p[n / 2]) } << 8)
+                | (std::uint64_t{ static_cast<unsigned char>(p[n - 1]) } << 16));
+        return round(h, 0);
+    }
+
+    // splitmix64 finalizer
+    constexpr std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // x in [0, 2^32) -> [0, n) with a multiplication instead of a division (Lemire's "fast range")
+    constexpr std::size_t range(std::uint64_t x32, std::size_t n)
+    {
+        return static_cast<std::size_t>((x32 * n) >> 32);
+    }
+}
+
+template <typename Value, std::size_t N>
+class StaticMap
+{
+    static_assert(N > 0 && N < (std::size_t{ 1 } << 31));
+
+public:
+    using Entry = std::pair<std::string_view, Value>;
+
+    static constexpr std::size_t bucketCount{ N / 2 + 1 };
+
+private:
+    std::array<Entry, N> m_slots{};
+    std::array<std::uint32_t, bucketCount> m_pilots{};
+
+    static constexpr std::size_t bucketOf(std::uint64_t h)
+    {
+        return StaticMapHash::range(h & 0xFFFFFFFF, bucketCount);
+    }
+
+    static constexpr std::size_t slotOf(std::uint64_t h, std::uint32_t pilot)
+    {
+        return StaticMapHash::range(StaticMapHash::mix(h + pilot * 0x9E3779B97F4A7C15ull) >> 32, N);
+    }
+
+public:
+    // Throws (a compile error, when evaluated at compile time) if two keys are equal, or if the
+    // search for a bucket's pilot fails (not expected to happen with distinct 64-bit hashes).
+    // The scratch arrays (~25 bytes per key) are std::vectors, allocated at compile time too (C++20):
+    // on the stack, a map built at run time with a few 100,000 keys would overflow it. The loops go
+    // through plain pointers and few function calls: at compile time, every operation counts against
+    // the compiler's limit (-fconstexpr-ops-limit).
+    constexpr explicit StaticMap(const std::array<Entry, N>& entries)
+    {
+        // Sort the keys by bucket (a counting sort): bucket b holds hashes[start[b], start[b + 1])
+        std::vector<std::uint64_t> keyHashStorage(N);
+        std::vector<std::size_t> startStorage(bucketCount + 1);
+        std::uint64_t* keyHashes{ keyHashStorage.data() };
+        std::size_t* start{ startStorage.data() };
+        for (std::size_t i{ 0 }; i < N; ++i)
+        {
+            keyHashes[i] = StaticMapHash::hash(entries[i].first);
+            ++start[bucketOf(keyHashes[i]) + 1];
+        }
+        std::size_t maxSize{ 0 };
+        for (std::size_t b{ 0 }; b < bucketCount; ++b)
+        {
+            maxSize = (start[b + 1] > maxSize) ? start[b + 1] : maxSize;
+            start[b + 1] += start[b];
+        }
+
+        std::vector<std::uint64_t> hashStorage(N);
+        std::vector<std::size_t> keyStorage(N);
+        std::vector<std::size_t> filledStorage(bucketCount);
+        std::uint64_t* hashes{ hashStorage.data() };
+        std::size_t* keys{ keyStorage.data() };
+        std::size_t* filled{ filledStorage.data() };
+        for (std::size_t i{ 0 }; i < N; ++i)
+        {
+            const std::size_t b{ bucketOf(keyHashes[i]) };
+            const std::size_t k{ start[b] + filled[b]++ };
+            hashes[k] = keyHashes[i];
+            keys[k] = i;
+        }
+
+        std::vector<char> takenStorage(N); // not std::vector<bool>: a plain array of flags
+        char* taken{ takenStorage.data() };
+        std::size_t slots[16]{};
+        for (std::size_t size{ maxSize }; size > 0; --size) // biggest buckets first
+        {
+            if (size > 16)
+                throw std::logic_error{ "StaticMap: bucket too big" }; // ~impossible with a decent hash
+
+            for (std::size_t b{ 0 }; b < bucketCount; ++b)
+            {
+                if (filled[b] != size)
+                    continue;
+                const std::uint64_t* bucket{ hashes + start[b] };
+
+                // Two keys with the same hash collide for every pilot
+                for (std::size_t k{ 1 }; k < size; ++k)
+                    for (std::size_t j{ 0 }; j < k; ++j)
+                        if (bucket[k] == bucket[j])
+                            throw std::logic_error{ "StaticMap: duplicate key" };
+
+                // A bucket of one key that needs the last free slot takes N tries on average: after 64 * N,
+                // the odds that a placement exists but was missed are about e^-64
+                constexpr std::uint64_t maxPilot{ (64 * std::uint64_t{ N } + 1024 < 0xFFFFFFFF) ? 64 * std::uint64_t{ N } + 1024 : 0xFFFFFFFF };
+                std::uint32_t pilot{ 0 };
+                bool fits{ false };
+                if (size == 1) // most buckets, and the longest searches (the table is nearly full): a shorter loop
+                {
+                    while (pilot != maxPilot && taken[slotOf(bucket[0], pilot)])
+                        ++pilot;
+                    fits = pilot != maxPilot;
+                    slots[0] = fits ? slotOf(bucket[0], pilot) : 0;
+                }
+                else
+                {
+                    for (; pilot != maxPilot; ++pilot)
+                    {
+                        fits = true;
+                        for (std::size_t k{ 0 }; k < size && fits; ++k)
+                        {
+                            slots[k] = slotOf(bucket[k], pilot);
+                            fits = !taken[slots[k]];
+                            for (std::size_t j{ 0 }; j < k && fits; ++j)
+                                fits = slots[j] != slots[k];
+                        }
+                        if (fits)
+                            break;
+                    }
+                }
+                if (!fits)
+                    throw std::logic_error{ "StaticMap: no pilot places a bucket (the key hashes collide in every slot)" };
+
+                for (std::size_t k{ 0 }; k < size; ++k)
+                {
+                    taken[slots[k]] = 1;
+                    m_slots[slots[k]] = entries[keys[start[b] + k]];
+                }
+                m_pilots[b] = pilot;
+            }
+        }
+    }
+
+    // nullptr if the key is not in the map
+    constexpr const Value* find(std::string_view key) const
+    {
+        const std::uint64_t h{ StaticMapHash::hash(key) };
+        const Entry& entry{ m_slots[slotOf(h, m_pilots[bucketOf(h)])] };
+        return (entry.first == key) ? &entry.second : nullptr;
+    }
+
+    constexpr bool contains(std::string_view key) const { return find(key) != nullptr; }
+
+    constexpr const Value& at(std::string_view key) const
+    {
+        const Value* value{ find(key) };
+        if (!value)
+            throw std::out_of_range{ "StaticMap::at: unknown key" };
+        return *value;
+    }
+
+    // In slot order, not in the order of the constructor
+    constexpr auto begin() const { return m_slots.begin(); }
+    constexpr auto end() const { return m_slots.end(); }
+    static constexpr std::size_t size() { return N; }
+};
+
+// makeStaticMap<int>({ { "one", 1 }, { "two", 2 } }): Value is given, N is deduced from the list
+template <typename Value, std::size_t N>
+constexpr StaticMap<Value, N> makeStaticMap(const std::pair<std::string_view, Value> (&entries)[N])
+{
+    return StaticMap<Value, N>{ std::to_array(entries) };
+}
+
+#endif
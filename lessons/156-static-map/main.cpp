@@ -0,0 +1,256 @@
+/* StaticMap: switch on a string
+
+- lessons/036-switch-statement: the condition of a switch must be an integral (or enum) type.
+  To dispatch on a string, the options are:
+  + an if-else chain of comparisons: O(number of cases), and one mispredicted branch after another,
+  + a std::unordered_map<std::string, ...> filled at startup: heap allocations, a hash, then a pointer
+    to follow to the node (a likely cache miss), and a static initialization to order correctly,
+  + a sorted array and binary search: log2(n) string comparisons, each a hard-to-predict branch.
+- When the keys are known at compile time, the compiler can build a perfect hash: no collisions, so
+  a lookup is one hash and one comparison, and there is nothing to do at startup (StaticMap.h).
+- Switch on a string = look the string up in a StaticMap of enumerators, then switch on the enumerator.
+*/
+
+#include "StaticMap.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class Command
+{
+    add,
+    remove,
+    list,
+    help,
+    quit,
+};
+
+constexpr auto g_commands{ makeStaticMap<Command>({
+    { "add", Command::add },
+    { "remove", Command::remove },
+    { "rm", Command::remove },
+    { "list", Command::list },
+    { "ls", Command::list },
+    { "help", Command::help },
+    { "?", Command::help },
+    { "quit", Command::quit },
+    { "exit", Command::quit },
+}) };
+
+// "switch (input)", which lessons/036-switch-statement cannot write
+std::string_view execute(std::string_view input)
+{
+    const Command* command{ g_commands.find(input) };
+    if (!command)
+        return "unknown command";
+
+    switch (*command)
+    {
+    case Command::add:    return "adding";
+    case Command::remove: return "removing";
+    case Command::list:   return "listing";
+    case Command::help:   return "helping";
+    case Command::quit:   return "quitting";
+    default:              return "???";
+    }
+}
+
+bool examples()
+{
+    // Built and queried at compile time
+    static_assert(g_commands.at("rm") == Command::remove);
+    static_assert(!g_commands.contains("delete"));
+
+    // constexpr auto duplicate{ makeStaticMap<int>({ { "a", 1 }, { "a", 2 } }) }; // error: ... "StaticMap: duplicate key"
+
+    for (std::string_view input : { "ls", "exit", "rm", "delete" })
+        std::cout << input << ": " << execute(input) << '\n';
+
+    for (const auto& [name, command] : g_commands)
+        std::cout << name << '=' << static_cast<int>(command) << ' ';
+    std::cout << '\n';
+
+    return execute("?") == "helping" && execute("") == "unknown command";
+}
+
+
+/* Benchmark
+
+- N = 10, 100, 1000, 10000 keys like "net.qxfa.size", all known at compile time: the StaticMaps of all
+  four sizes are built by the compiler (a few seconds of compile time for the biggest).
+- 10^6 lookups of random keys, 10% of them not in the map, with:
+  + std::unordered_map<std::string, int> (with heterogeneous lookup: no std::string built per lookup),
+  + a sorted std::vector and std::lower_bound,
+  + StaticMap.
+*/
+
+constexpr std::size_t kMaxKeyLength{ 32 };
+
+template <std::size_t N>
+struct KeyText
+{
+    std::array<char, N * kMaxKeyLength> chars{};
+    std::array<std::size_t, N> lengths{};
+};
+
+// Key i: prefix + 4 letters (distinct for every i) + suffix
+template <std::size_t N>
+constexpr KeyText<N> makeKeyText()
+{
+    constexpr std::string_view prefixes[]{ "", "net.", "ui.", "storage.cache." };
+    constexpr std::string_view suffixes[]{ "", ".size", "_timeout_ms" };
+
+    KeyText<N> text{};
+    for (std::size_t i{ 0 }; i < N; ++i)
+    {
+        char* key{ text.chars.data() + i * kMaxKeyLength };
+        std::size_t length{ 0 };
+        for (char c : prefixes[i % 4])
+            key[length++] = c;
+        std::size_t letters{ (i * 7919 + 12345) % (26 * 26 * 26 * 26) }; // a permutation of [0, 26^4)
+        for (int j{ 0 }; j < 4; ++j, letters /= 26)
+            key[length++] = static_cast<char>('a' + letters % 26);
+        for (char c : suffixes[(i / 4) % 3])
+            key[length++] = c;
+        text.lengths[i] = length;
+    }
+    return text;
+}
+
+template <std::size_t N>
+inline constexpr KeyText<N> g_keyText{ makeKeyText<N>() };
+
+template <std::size_t N>
+constexpr std::array<std::pair<std::string_view, int>, N> makeEntries()
+{
+    std::array<std::pair<std::string_view, int>, N> entries{};
+    for (std::size_t i{ 0 }; i < N; ++i)
+        entries[i] = { std::string_view{ g_keyText<N>.chars.data() + i * kMaxKeyLength, g_keyText<N>.lengths[i] }, static_cast<int>(i) };
+    return entries;
+}
+
+template <std::size_t N>
+inline constexpr auto g_entries{ makeEntries<N>() };
+
+template <std::size_t N>
+inline constexpr StaticMap<int, N> g_map{ g_entries<N> };
+
+// Lets unordered_map::find take a std::string_view (C++20)
+struct StringHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+template <typename F>
+double nsPerLookup(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+template <std::size_t N>
+bool benchmarkSize(std::size_t count)
+{
+    const auto& entries{ g_entries<N> };
+
+    std::unordered_map<std::string, int, StringHash, std::equal_to<>> hashMap{};
+    for (const auto& [key, value] : entries)
+        hashMap.emplace(key, value);
+
+    std::vector<std::pair<std::string_view, int>> sorted(entries.begin(), entries.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    std::mt19937 rng{ 7 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, N - 1 };
+    std::bernoulli_distribution miss{ 0.1 };
+    std::vector<std::string> queries(count);
+    for (auto& query : queries)
+    {
+        query = entries[pick(rng)].first;
+        if (miss(rng))
+            query.back() = '#';
+    }
+
+    long long sums[3]{};
+
+    const double hashMapNs{ nsPerLookup(count, [&] {
+        for (const auto& query : queries)
+            if (const auto found{ hashMap.find(std::string_view{ query }) }; found != hashMap.end())
+                sums[0] += found->second;
+    }) };
+
+    const double sortedNs{ nsPerLookup(count, [&] {
+        for (const auto& query : queries)
+        {
+            const std::string_view key{ query };
+            const auto found{ std::lower_bound(sorted.begin(), sorted.end(), key, [](const auto& entry, std::string_view k) { return entry.first < k; }) };
+            if (found != sorted.end() && found->first == key)
+                sums[1] += found->second;
+        }
+    }) };
+
+    const double staticMapNs{ nsPerLookup(count, [&] {
+        for (const auto& query : queries)
+            if (const int* value{ g_map<N>.find(query) })
+                sums[2] += *value;
+    }) };
+
+    std::cout << std::setw(6) << N << std::setw(16) << hashMapNs << std::setw(15) << sortedNs << std::setw(12) << staticMapNs << '\n';
+    return sums[0] == sums[1] && sums[1] == sums[2];
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << std::fixed << std::setprecision(2) << std::setw(6) << "keys" << std::setw(16) << "unordered_map" << std::setw(15)
+              << "binary search" << std::setw(12) << "StaticMap" << "   (ns per lookup)\n";
+
+    bool ok{ benchmarkSize<10>(count) };
+    ok = benchmarkSize<100>(count) && ok;
+    ok = benchmarkSize<1000>(count) && ok;
+    ok = benchmarkSize<10000>(count) && ok;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 1000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- "Minimal": N keys in exactly N slots, plus about N/2 pilots. An unordered_map needs a node per key
+  (key, value, next pointer, cached hash, malloc overhead) plus the bucket array.
+- Building at compile time is bounded by the compiler's constexpr limits (-fconstexpr-ops-limit,
+  -fconstexpr-loop-limit): beyond ~10^5 keys, generate the tables with a build step instead.
+- A miss still costs a hash and one comparison: the key is compared, never assumed to be there.
+  (Some perfect hash libraries skip the comparison when every queried key is known to be in the set.)
+- Libraries: frozen (serge-sans-paille/frozen), gperf (a code generator, since 1989), PTHash (for billions of keys).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/switch-statement-basics/
+- https://cmph.sourceforge.net/papers/esa09.pdf (Belazzougui, Botelho, Dietzfelbinger, "Hash, displace, and compress")
+- https://arxiv.org/abs/2104.10402 (Pibiri, Trani, "PTHash: Revisiting FCH Minimal Perfect Hashing")
+- https://lemire.me/blog/2016/06/27/a-fast-alternative-to-the-modulo-reduction/
+*/
@@ -0,0 +1,112 @@
+#include "IDGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace
+{
+    std::uint64_t readState(const std::filesystem::path& path)
+    {
+        std::ifstream inf{ path };
+        if (!inf)
+            return 0; // first run
+
+        std::uint64_t value{};
+        if (!(inf >> value))
+            throw std::runtime_error{ "IDGenerator: corrupt state file " + path.string() };
+        return value;
+    }
+
+    // Writes a temporary file, then renames it over the old one: a crash in the middle leaves
+    // either the old or the new value, never half a number.
+    void writeState(const std::filesystem::path& path, std::uint64_t value)
+    {
+        std::filesystem::path temporary{ path };
+        temporary += ".tmp";
+        {
+            std::ofstream outf{ temporary, std::ios::trunc };
+            outf << value << '\n';
+            outf.close();
+            if (!outf)
+                throw std::runtime_error{ "IDGenerator: cannot write " + temporary.string() };
+        }
+        std::error_code error{};
+        std::filesystem::rename(temporary, path, error);
+        if (error)
+            throw std::runtime_error{ "IDGenerator: cannot replace " + path.string() + ": " + error.message() };
+    }
+
+    std::uint64_t millisecondsSinceEpoch()
+    {
+        const auto now{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(now - IDGenerator::kEpochMs, 0));
+    }
+}
+
+IDGenerator::IDGenerator()
+    : IDGenerator{ Options{} }
+{
+}
+
+IDGenerator::IDGenerator(Options options)
+    : m_options{ std::move(options) }
+{
+    if (m_options.blockSize == 0)
+        throw std::invalid_argument{ "IDGenerator: blockSize must be > 0" };
+    if (m_options.nodeId >= (std::uint64_t{ 1 } << kNodeBits))
+        throw std::invalid_argument{ "IDGenerator: nodeId must be < 1024" };
+
+    if (!m_options.stateFile.empty())
+    {
+        // Everything below the saved mark may have been handed out by the previous run: start above it.
+        // The first refill extends the lease (and writes the file) before handing out any ID.
+        const std::uint64_t start{ std::max<std::uint64_t>(readState(m_options.stateFile), 1) };
+        m_next.store(start);
+        m_ceiling.store(start);
+    }
+}
+
+// Time-ordered values are [milliseconds][sequence]: the next block starts at the current millisecond,
+// or right after the last block if that is later (several blocks in the same millisecond, the sequence
+// overflowing into the next milliseconds, or the clock going backwards). A CAS loop, since the new
+// value depends on the old one; still once per block.
+std::uint64_t IDGenerator::reserveTimeOrdered()
+{
+    const std::uint64_t now{ millisecondsSinceEpoch() << kSequenceBits };
+    std::uint64_t first{ m_next.load(std::memory_order_relaxed) };
+    while (!m_next.compare_exchange_weak(first, std::max(first, now) + m_options.blockSize, std::memory_order_relaxed))
+    {
+    }
+    return std::max(first, now);
+}
+
+void IDGenerator::refill(Block& block)
+{
+    const std::uint64_t first{ (m_options.layout == Layout::timeOrdered)
+        ? reserveTimeOrdered()
+        : m_next.fetch_add(m_options.blockSize, std::memory_order_relaxed) };
+    const std::uint64_t end{ first + m_options.blockSize };
+
+    if (end > m_ceiling.load(std::memory_order_acquire))
+        extendLease(end);
+
+    block = { m_serial, first, end };
+}
+
+// Saves a new high-water mark before any value below it is used. Once every leaseSize IDs,
+// so the file write (milliseconds) is amortized like the atomic operation is.
+void IDGenerator::extendLease(std::uint64_t end)
+{
+    std::scoped_lock lock{ m_stateMutex };
+    if (end <= m_ceiling.load(std::memory_order_relaxed))
+        return; // another thread got there first
+
+    const std::uint64_t ceiling{ end + m_options.leaseSize };
+    writeState(m_options.stateFile, ceiling);
+    m_ceiling.store(ceiling, std::memory_order_release);
+}
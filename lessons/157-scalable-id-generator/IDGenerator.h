@@ -0,0 +1,96 @@
+#ifndef ID_GENERATOR_H
+#define ID_GENERATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+
+// IDGenerator from lessons/083-static-member-functions, for many threads and across restarts.
+// * 64-bit IDs (an int overflows after 2^31 IDs).
+// * Threads do not share a counter per ID: each one reserves a block of IDs from the shared atomic
+//   counter, then hands them out from a thread_local block without any synchronization.
+//   One atomic operation per blockSize IDs instead of one per ID.
+// * Layout::timeOrdered: [milliseconds since kEpochMs: 42 bits][sequence: 12 bits][node: 10 bits],
+//   like Twitter's Snowflake. IDs sort (roughly) by creation time and several machines
+//   (different nodeId) never produce the same ID.
+// * stateFile: the high-water mark is written to a file before IDs above it are handed out
+//   (the "hi/lo" scheme), so a restarted program continues after the last ID it could have used.
+//
+// IDs are unique, not contiguous: a thread's unused block, and the rest of the lease at exit, are skipped.
+class IDGenerator
+{
+public:
+    enum class Layout
+    {
+        sequential,
+        timeOrdered,
+    };
+
+    struct Options
+    {
+        Layout layout{ Layout::sequential };
+        std::uint64_t blockSize{ 1024 };            // IDs a thread reserves at a time
+        std::filesystem::path stateFile{};          // empty: no persistence
+        std::uint64_t leaseSize{ 1 << 20 };         // IDs covered by one write of stateFile
+        std::uint64_t nodeId{ 0 };                  // timeOrdered: 0 to 1023
+    };
+
+    static constexpr int kNodeBits{ 10 };
+    static constexpr int kSequenceBits{ 12 };
+    static constexpr std::int64_t kEpochMs{ 1704067200000 }; // 2024-01-01 00:00:00 UTC
+
+    IDGenerator();
+    explicit IDGenerator(Options options);
+
+    IDGenerator(const IDGenerator&) = delete;
+    IDGenerator& operator=(const IDGenerator&) = delete;
+
+    // Thread-safe. Never returns 0.
+    std::uint64_t getNextID()
+    {
+        Block& block{ s_block };
+        if (block.owner != m_serial || block.next == block.end) [[unlikely]]
+            refill(block);
+
+        const std::uint64_t value{ block.next++ };
+        return (m_options.layout == Layout::timeOrdered) ? (value << kNodeBits) | m_options.nodeId : value;
+    }
+
+    // When a Layout::timeOrdered ID was created (milliseconds since 1970), give or take one block
+    static std::int64_t getTimestampMs(std::uint64_t id)
+    {
+        return static_cast<std::int64_t>(id >> (kNodeBits + kSequenceBits)) + kEpochMs;
+    }
+
+private:
+    // The IDs [next, end) of the generator whose m_serial is owner. A thread caches one block,
+    // for the last generator it used: alternating between generators wastes blocks, but stays correct.
+    struct Block
+    {
+        std::uint64_t owner{};
+        std::uint64_t next{};
+        std::uint64_t end{};
+    };
+
+    static thread_local Block s_block;
+    static inline std::atomic<std::uint64_t> s_serials{ 0 }; // not the address: a new generator can reuse it
+
+    const Options m_options;
+    const std::uint64_t m_serial{ ++s_serials };
+
+    // The next value to reserve, and the high-water mark: the values below it are covered by stateFile.
+    // On separate cache lines: every refill writes m_next, but only reads m_ceiling.
+    alignas(64) std::atomic<std::uint64_t> m_next{ 1 };
+    alignas(64) std::atomic<std::uint64_t> m_ceiling{ std::numeric_limits<std::uint64_t>::max() };
+    std::mutex m_stateMutex;
+
+    void refill(Block& block);
+    std::uint64_t reserveTimeOrdered();
+    void extendLease(std::uint64_t end);
+};
+
+inline thread_local IDGenerator::Block IDGenerator::s_block{};
+
+#endif
@@ -0,0 +1,193 @@
+/* A scalable ID generator
+
+- lessons/083-static-member-functions: IDGenerator::getNextID() returns s_nextID++.
+  + Called from two threads at once, it is a data race: undefined behavior, and in practice
+    two threads can read the same value and return the same ID.
+  + Making s_nextID a std::atomic<int> fixes the race, but every ID is then a read-modify-write of one
+    shared cache line: with many cores, the line bounces between them and the threads wait in line.
+  + An int overflows after 2^31 IDs, and the IDs restart at 1 with the program.
+
+- IDGenerator.h: 64-bit IDs, per-thread blocks (one atomic operation per 1024 IDs), an optional
+  time-ordered layout, and a high-water mark saved to a file so that IDs stay unique across restarts.
+*/
+
+#include "IDGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The original, from lessons/083-static-member-functions: only safe from one thread
+class IDGenerator083
+{
+private:
+    static inline int s_nextID{ 1 };
+
+public:
+    static int getNextID() { return s_nextID++; }
+};
+
+// Each thread calls getNextID count times; returns all the IDs
+template <typename GetID>
+std::vector<std::uint64_t> collectIDs(int threadCount, std::size_t count, GetID getID)
+{
+    std::vector<std::vector<std::uint64_t>> perThread(static_cast<std::size_t>(threadCount));
+    std::vector<std::thread> threads{};
+    for (auto& ids : perThread)
+        threads.emplace_back([&ids, count, &getID] {
+            ids.reserve(count);
+            for (std::size_t i{ 0 }; i < count; ++i)
+                ids.push_back(getID());
+        });
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<std::uint64_t> all{};
+    for (const auto& ids : perThread)
+        all.insert(all.end(), ids.begin(), ids.end());
+    return all;
+}
+
+bool allUnique(std::vector<std::uint64_t> ids)
+{
+    std::sort(ids.begin(), ids.end());
+    return std::adjacent_find(ids.begin(), ids.end()) == ids.end() && (ids.empty() || ids.front() != 0);
+}
+
+bool examples()
+{
+    std::cout << IDGenerator083::getNextID() << ' ' << IDGenerator083::getNextID() << '\n'; // 1 2
+
+    IDGenerator sequential{};
+    const bool sequentialUnique{ allUnique(collectIDs(8, 100000, [&] { return sequential.getNextID(); })) };
+
+    IDGenerator timeOrdered{ { .layout = IDGenerator::Layout::timeOrdered, .blockSize = 64, .nodeId = 42 } };
+    const auto timeOrderedIDs{ collectIDs(8, 100000, [&] { return timeOrdered.getNextID(); }) };
+    const auto nowMs{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+    const std::uint64_t id{ timeOrderedIDs.back() };
+    // Ahead of the clock here: 800,000 IDs in a few milliseconds is more than 4096 per millisecond (see the notes)
+    std::cout << "time-ordered ID " << id << ": node " << (id & 1023) << ", timestamp - clock: " << IDGenerator::getTimestampMs(id) - nowMs << " ms\n";
+    const bool timeOrderedValid{ allUnique(timeOrderedIDs) && (id & 1023) == 42 && std::abs(nowMs - IDGenerator::getTimestampMs(id)) < 10000 };
+
+    // Persistence: a "restarted" generator continues after everything the first one could have handed out
+    const auto stateFile{ std::filesystem::temp_directory_path() / "lesson-157-idgenerator.state" };
+    std::filesystem::remove(stateFile);
+    std::uint64_t lastBeforeRestart{};
+    {
+        IDGenerator generator{ { .stateFile = stateFile, .leaseSize = 10000 } };
+        for (int i{ 0 }; i < 5000; ++i)
+            lastBeforeRestart = generator.getNextID();
+    }
+    std::uint64_t firstAfterRestart{};
+    {
+        IDGenerator generator{ { .stateFile = stateFile, .leaseSize = 10000 } };
+        firstAfterRestart = generator.getNextID();
+    }
+    std::filesystem::remove(stateFile);
+    std::cout << "last ID before the restart: " << lastBeforeRestart << ", first ID after: " << firstAfterRestart << '\n';
+
+    return sequentialUnique && timeOrderedValid && firstAfterRestart > lastBeforeRestart;
+}
+
+
+/* Benchmark
+
+- IDs per second, with 1 to 64 threads sharing one generator:
+  + a std::mutex around s_nextID++,
+  + std::atomic<std::uint64_t>::fetch_add per ID,
+  + IDGenerator (blocks of 1024), sequential and time-ordered.
+- With a single core, the threads take turns and nothing is contended: the atomic and the mutex only
+  pay their base cost. With many cores, the mutex and the shared atomic get slower as threads are added,
+  the blocks do not.
+*/
+
+template <typename GetID>
+double idsPerSecond(int threadCount, std::size_t count, GetID getID, std::atomic<std::uint64_t>& sink)
+{
+    const std::size_t perThread{ count / static_cast<std::size_t>(threadCount) };
+    const auto start{ std::chrono::steady_clock::now() };
+    std::vector<std::thread> threads{};
+    for (int t{ 0 }; t < threadCount; ++t)
+        threads.emplace_back([&] {
+            std::uint64_t sum{ 0 };
+            for (std::size_t i{ 0 }; i < perThread; ++i)
+                sum += getID();
+            sink += sum;
+        });
+    for (auto& thread : threads)
+        thread.join();
+    const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+    return static_cast<double>(perThread * static_cast<std::size_t>(threadCount)) / seconds;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n'
+              << std::setw(8) << "threads" << std::setw(12) << "mutex" << std::setw(12) << "atomic" << std::setw(14) << "blocks"
+              << std::setw(14) << "time-ordered" << "   (millions of IDs per second)\n";
+
+    std::atomic<std::uint64_t> sink{ 0 };
+    for (int threads : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        std::mutex mutex{};
+        std::uint64_t nextID{ 1 };
+        const double mutexRate{ idsPerSecond(threads, count, [&] {
+            std::scoped_lock lock{ mutex };
+            return nextID++;
+        }, sink) };
+
+        std::atomic<std::uint64_t> atomicID{ 1 };
+        const double atomicRate{ idsPerSecond(threads, count, [&] { return atomicID.fetch_add(1, std::memory_order_relaxed); }, sink) };
+
+        IDGenerator sequential{};
+        const double blockRate{ idsPerSecond(threads, count, [&] { return sequential.getNextID(); }, sink) };
+
+        IDGenerator timeOrdered{ { .layout = IDGenerator::Layout::timeOrdered } };
+        const double timeOrderedRate{ idsPerSecond(threads, count, [&] { return timeOrdered.getNextID(); }, sink) };
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << threads << std::setw(12) << mutexRate / 1e6
+                  << std::setw(12) << atomicRate / 1e6 << std::setw(14) << blockRate / 1e6 << std::setw(14) << timeOrderedRate / 1e6 << '\n';
+    }
+    return sink > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 8000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- The blocks trade contiguity for speed: IDs from different threads interleave, and the unused part of
+  a block is lost when a thread ends. Smaller blocks waste less and contend more.
+- Time-ordered IDs: 42 bits of milliseconds last 139 years from kEpochMs; 12 bits of sequence allow
+  4096 IDs per millisecond per node before the sequence borrows from the next millisecond (the IDs stay
+  unique and increasing, only the timestamp runs ahead of the clock).
+- The state file is replaced atomically (rename), but surviving a power failure also needs the data on
+  the disk: fsync (POSIX) or FlushFileBuffers (Windows), which standard C++ does not offer.
+- The hi/lo scheme is what ORMs (Hibernate) use with database sequences; Snowflake, ULID and UUIDv7 are
+  time-ordered layouts.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/static-member-functions/
+- https://en.cppreference.com/w/cpp/atomic/atomic/fetch_add
+- https://en.wikipedia.org/wiki/Snowflake_ID
+- https://www.rfc-editor.org/rfc/rfc9562 (UUID version 7: time-ordered)
+*/
@@ -0,0 +1,173 @@
+#ifndef CONCURRENT_ACCUMULATOR_H
+#define CONCURRENT_ACCUMULATOR_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+// Accumulator from lessons/084-friend, for counters that many threads update at once (metrics, statistics).
+// * One shared std::atomic: every add() from every core writes the same cache line, which then
+//   travels from core to core ("cache-line ping-pong"): adds get slower as cores are added.
+// * Sharded: each thread adds to its own shard, and each shard has its own cache line, so adds from
+//   different threads never touch the same line. Reads are rarer: they visit every shard and combine.
+// * A read while threads are adding sees each shard at a slightly different moment: fine for metrics,
+//   not for "exactly how many right now".
+namespace Sharding
+{
+    inline constexpr std::size_t kCacheLineSize{ 64 }; // std::hardware_destructive_interference_size, which GCC warns about in headers
+
+    inline std::size_t defaultShardCount()
+    {
+        return std::bit_ceil(std::max<std::size_t>(std::thread::hardware_concurrency(), 1));
+    }
+
+    // Threads are numbered 0, 1, 2... on first use: thread n uses shard n % shardCount.
+    // With no more threads than shards, no two threads share a shard.
+    inline std::size_t threadIndex()
+    {
+        static std::atomic<std::size_t> s_threadCount{ 0 };
+        static thread_local const std::size_t s_index{ s_threadCount.fetch_add(1, std::memory_order_relaxed) };
+        return s_index;
+    }
+}
+
+class ConcurrentAccumulator
+{
+public:
+    struct Summary
+    {
+        long long sum{};
+        long long min{ std::numeric_limits<long long>::max() };
+        long long max{ std::numeric_limits<long long>::min() };
+        std::uint64_t count{};
+
+        double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+    };
+
+private:
+    struct alignas(Sharding::kCacheLineSize) Shard
+    {
+        std::atomic<long long> sum{ 0 };
+        std::atomic<long long> min{ std::numeric_limits<long long>::max() };
+        std::atomic<long long> max{ std::numeric_limits<long long>::min() };
+        std::atomic<std::uint64_t> count{ 0 };
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::size_t m_mask;
+
+public:
+    explicit ConcurrentAccumulator(std::size_t shardCount = Sharding::defaultShardCount())
+        : m_shards{ std::make_unique<Shard[]>(std::bit_ceil(shardCount)) }, m_mask{ std::bit_ceil(shardCount) - 1 }
+    {
+    }
+
+    // Relaxed atomic operations: they only have to be indivisible (two threads sharing a shard),
+    // they do not order anything else. On an unshared cache line, they are cheap.
+    void add(long long value)
+    {
+        Shard& shard{ m_shards[Sharding::threadIndex() & m_mask] };
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+
+        // Min and max rarely change: a plain load first, a compare-exchange only when needed
+        long long min{ shard.min.load(std::memory_order_relaxed) };
+        while (value < min && !shard.min.compare_exchange_weak(min, value, std::memory_order_relaxed))
+        {
+        }
+        long long max{ shard.max.load(std::memory_order_relaxed) };
+        while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    Summary read() const
+    {
+        Summary summary{};
+        for (std::size_t i{ 0 }; i <= m_mask; ++i)
+        {
+            const Shard& shard{ m_shards[i] };
+            summary.sum += shard.sum.load(std::memory_order_relaxed);
+            summary.count += shard.count.load(std::memory_order_relaxed);
+            summary.min = std::min(summary.min, shard.min.load(std::memory_order_relaxed));
+            summary.max = std::max(summary.max, shard.max.load(std::memory_order_relaxed));
+        }
+        return summary;
+    }
+
+    long long sum() const { return read().sum; }
+};
+
+// The same sharding for a histogram of non-negative values, with power-of-two buckets:
+// bucket 0 holds 0, bucket b holds [2^(b-1), 2^b). Coarse (a factor of 2), but add() is a bit scan
+// and one increment, and 65 buckets cover every std::uint64_t (latencies in ns, sizes in bytes...).
+class ConcurrentHistogram
+{
+public:
+    static constexpr std::size_t kBucketCount{ 65 };
+    using Counts = std::array<std::uint64_t, kBucketCount>;
+
+private:
+    struct alignas(Sharding::kCacheLineSize) Shard
+    {
+        std::array<std::atomic<std::uint64_t>, kBucketCount> counts{};
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::size_t m_mask;
+
+public:
+    explicit ConcurrentHistogram(std::size_t shardCount = Sharding::defaultShardCount())
+        : m_shards{ std::make_unique<Shard[]>(std::bit_ceil(shardCount)) }, m_mask{ std::bit_ceil(shardCount) - 1 }
+    {
+    }
+
+    static std::size_t bucketOf(std::uint64_t value) { return static_cast<std::size_t>(std::bit_width(value)); }
+
+    // The largest value that falls in bucket b
+    static std::uint64_t bucketUpperBound(std::size_t b)
+    {
+        return (b == 0) ? 0 : (b >= 64) ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t{ 1 } << b) - 1;
+    }
+
+    void add(std::uint64_t value)
+    {
+        m_shards[Sharding::threadIndex() & m_mask].counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Counts read() const
+    {
+        Counts counts{};
+        for (std::size_t i{ 0 }; i <= m_mask; ++i)
+            for (std::size_t b{ 0 }; b < kBucketCount; ++b)
+                counts[b] += m_shards[i].counts[b].load(std::memory_order_relaxed);
+        return counts;
+    }
+
+    // An upper bound of the q-quantile (q = 0.99: 99% of the values are <= the result)
+    std::uint64_t quantile(double q) const
+    {
+        const Counts counts{ read() };
+        std::uint64_t total{ 0 };
+        for (std::uint64_t count : counts)
+            total += count;
+
+        const auto rank{ static_cast<std::uint64_t>(q * static_cast<double>(total)) };
+        std::uint64_t seen{ 0 };
+        for (std::size_t b{ 0 }; b < kBucketCount; ++b)
+        {
+            seen += counts[b];
+            if (seen > rank || (seen == total && seen > 0))
+                return bucketUpperBound(b);
+        }
+        return 0;
+    }
+};
+
+#endif
@@ -0,0 +1,183 @@
+/* A sharded concurrent accumulator
+
+- lessons/084-friend: Accumulator::add() does m_value += value. From several threads, that is a data race.
+- std::atomic makes it correct, but not fast: an atomic add needs the cache line holding the value in
+  the core's own cache, in exclusive state. When all the cores add to the same value, the line moves
+  from core to core for every add (~100 cycles each time), and the adds are serialized.
+- False sharing: giving each thread its own counter is not enough if the counters are next to each
+  other in memory: they share a cache line, which ping-pongs just the same.
+- ConcurrentAccumulator.h: one shard per thread, each shard on its own cache line (alignas(64)).
+  add() only touches the caller's shard; read() combines all the shards.
+*/
+
+#include "ConcurrentAccumulator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// From lessons/084-friend: only safe from one thread
+class Accumulator
+{
+private:
+    int m_value{ 0 };
+
+public:
+    void add(int value) { m_value += value; }
+
+    friend void print(const Accumulator& accumulator);
+};
+
+void print(const Accumulator& accumulator)
+{
+    std::cout << accumulator.m_value;
+}
+
+void print(const ConcurrentAccumulator::Summary& summary)
+{
+    std::cout << "count " << summary.count << ", sum " << summary.sum << ", min " << summary.min << ", max " << summary.max
+              << ", mean " << summary.mean();
+}
+
+template <typename F>
+void runThreads(int threadCount, F&& f)
+{
+    std::vector<std::thread> threads{};
+    for (int t{ 0 }; t < threadCount; ++t)
+        threads.emplace_back(f, t);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+bool examples()
+{
+    Accumulator acc{};
+    acc.add(5);
+    print(acc);
+    std::cout << '\n';
+
+    // 8 threads add 1, 2, ..., 100000 each
+    ConcurrentAccumulator accumulator{};
+    runThreads(8, [&](int) {
+        for (long long i{ 1 }; i <= 100000; ++i)
+            accumulator.add(i);
+    });
+    const auto summary{ accumulator.read() };
+    print(summary);
+    std::cout << '\n';
+
+    // Request latencies (in microseconds), recorded by 4 threads
+    ConcurrentHistogram latencies{};
+    runThreads(4, [&](int t) {
+        for (std::uint64_t i{ 0 }; i < 10000; ++i)
+            latencies.add((i % 100 == 0) ? 5000 + static_cast<std::uint64_t>(t) : 20 + i % 50); // 1% slow requests
+    });
+    const auto counts{ latencies.read() };
+    for (std::size_t b{ 0 }; b < counts.size(); ++b)
+        if (counts[b] > 0)
+            std::cout << "<= " << ConcurrentHistogram::bucketUpperBound(b) << " us: " << counts[b] << '\n';
+    std::cout << "p50 <= " << latencies.quantile(0.5) << " us, p99.5 <= " << latencies.quantile(0.995) << " us\n";
+
+    return summary.count == 800000 && summary.sum == 8 * 5000050000LL && summary.min == 1 && summary.max == 100000
+        && latencies.quantile(0.5) == 63 && latencies.quantile(0.995) == 8191;
+}
+
+
+/* Benchmark
+
+- Millions of adds per second, from 1 thread to all the hardware threads (and 8, at least):
+  + one shared std::atomic<int>::fetch_add,
+  + one std::atomic per thread, in a std::vector: adjacent, so up to 8 share a cache line (false sharing),
+  + ConcurrentAccumulator (sum, count, min and max per add),
+  + ConcurrentHistogram.
+- With a single core, nothing ping-pongs and the columns only show the cost of the instructions.
+*/
+
+template <typename Add>
+double addsPerSecond(int threadCount, std::size_t count, Add add)
+{
+    const std::size_t perThread{ count / static_cast<std::size_t>(threadCount) };
+    const auto start{ std::chrono::steady_clock::now() };
+    runThreads(threadCount, [&](int t) {
+        for (std::size_t i{ 0 }; i < perThread; ++i)
+            add(t, i);
+    });
+    const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+    return static_cast<double>(perThread * static_cast<std::size_t>(threadCount)) / seconds / 1e6;
+}
+
+bool benchmark(std::size_t count)
+{
+    const int hardwareThreads{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::vector<int> threadCounts{};
+    for (int threads{ 1 }; threads < std::max(hardwareThreads, 8); threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(std::max(hardwareThreads, 8));
+
+    std::cout << "hardware threads: " << hardwareThreads << '\n'
+              << std::setw(8) << "threads" << std::setw(16) << "shared atomic" << std::setw(16) << "false sharing"
+              << std::setw(13) << "sharded" << std::setw(13) << "histogram" << "   (millions of adds per second)\n";
+
+    bool ok{ true };
+    for (int threads : threadCounts)
+    {
+        const std::size_t perThread{ count / static_cast<std::size_t>(threads) };
+
+        std::atomic<int> shared{ 0 };
+        const double sharedRate{ addsPerSecond(threads, count, [&](int, std::size_t) { shared.fetch_add(1, std::memory_order_relaxed); }) };
+
+        std::vector<std::atomic<long long>> adjacent(static_cast<std::size_t>(threads));
+        const double adjacentRate{ addsPerSecond(threads, count, [&](int t, std::size_t) {
+            adjacent[static_cast<std::size_t>(t)].fetch_add(1, std::memory_order_relaxed);
+        }) };
+
+        ConcurrentAccumulator accumulator{};
+        const double shardedRate{ addsPerSecond(threads, count, [&](int, std::size_t i) { accumulator.add(static_cast<long long>(i & 1023)); }) };
+
+        ConcurrentHistogram histogram{};
+        const double histogramRate{ addsPerSecond(threads, count, [&](int, std::size_t i) { histogram.add(i & 1023); }) };
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << threads << std::setw(16) << sharedRate << std::setw(16)
+                  << adjacentRate << std::setw(13) << shardedRate << std::setw(13) << histogramRate << '\n';
+
+        const auto total{ perThread * static_cast<std::size_t>(threads) };
+        ok = ok && static_cast<std::size_t>(shared.load()) == total && accumulator.read().count == total;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 20000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Memory: one cache line per shard (the histogram: 9 lines per shard). Shard count = hardware threads,
+  rounded up to a power of two, so that "index & mask" replaces a division.
+- More threads than shards: threads share shards, which is still correct (the shards are atomic),
+  just contended again. A thread keeps its index for its whole life.
+- A plain (non-atomic) per-thread counter, read only after join(), is faster still. The atomics are
+  here so that read() can run while other threads add.
+- The same idea in the JDK (java.util.concurrent.atomic.LongAdder), folly (ThreadCachedInt) and the
+  Linux kernel (per-CPU counters).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/friend-non-member-functions/
+- https://en.cppreference.com/w/cpp/thread/hardware_destructive_interference_size
+- https://docs.oracle.com/javase/8/docs/api/java/util/concurrent/atomic/LongAdder.html
+*/
@@ -0,0 +1,396 @@
+#include "EmployeeTable.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EMPLOYEE_TABLE_X86
+#include <immintrin.h>
+#endif
+
+/* Selection kernels
+
+- select*(ids, ages, wages, count, filter, selection) writes the indices (0 to count - 1) of the rows that
+  match into selection and returns how many there are. selection must have room for count + 16 indices:
+  the SIMD versions store a whole register at a time.
+- Scalar: branchless. Every index is written, and the count only advances when the row matches, so an
+  unpredictable filter (50% of the rows) costs no branch mispredictions.
+- AVX2: 8 rows at a time. The comparisons give an 8-bit mask; a lookup table turns the mask into a
+  permutation that moves the selected lanes to the front of the register.
+- AVX-512: 16 rows at a time, and the instruction set has "compress and store" built in.
+*/
+
+namespace
+{
+    using SelectFunction = std::size_t (*)(const int* ids, const int* ages, const double* wages, std::size_t count,
+                                           const EmployeeFilter& filter, std::uint32_t* selection);
+
+    std::size_t selectScalar(const int* ids, const int* ages, const double* wages, std::size_t first, std::size_t count,
+                             const EmployeeFilter& f, std::uint32_t* selection, std::size_t selected)
+    {
+        for (std::size_t i{ first }; i < count; ++i)
+        {
+            selection[selected] = static_cast<std::uint32_t>(i);
+            selected += (ids[i] >= f.minId) & (ids[i] <= f.maxId) & (ages[i] >= f.minAge) & (ages[i] <= f.maxAge)
+                & (wages[i] >= f.minWage) & (wages[i] <= f.maxWage);
+        }
+        return selected;
+    }
+
+    std::size_t selectGeneric(const int* ids, const int* ages, const double* wages, std::size_t count,
+                              const EmployeeFilter& filter, std::uint32_t* selection)
+    {
+        return selectScalar(ids, ages, wages, 0, count, filter, selection, 0);
+    }
+
+    // For each 8-bit mask, the lanes whose bit is set, in order: mask 0b00100110 -> 1, 2, 5, 0, 0...
+    constexpr auto kCompressTable{ [] {
+        std::array<std::array<std::uint32_t, 8>, 256> table{};
+        for (std::size_t mask{ 0 }; mask < 256; ++mask)
+        {
+            std::size_t n{ 0 };
+            for (std::uint32_t lane{ 0 }; lane < 8; ++lane)
+                if (mask & (std::size_t{ 1 } << lane))
+                    table[mask][n++] = lane;
+        }
+        return table;
+    }() };
+}
+
+#ifdef EMPLOYEE_TABLE_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace
+{
+    std::size_t selectAvx2(const int* ids, const int* ages, const double* wages, std::size_t count,
+                           const EmployeeFilter& f, std::uint32_t* selection)
+    {
+        const __m256i minId{ _mm256_set1_epi32(f.minId) };
+        const __m256i maxId{ _mm256_set1_epi32(f.maxId) };
+        const __m256i minAge{ _mm256_set1_epi32(f.minAge) };
+        const __m256i maxAge{ _mm256_set1_epi32(f.maxAge) };
+        const __m256d minWage{ _mm256_set1_pd(f.minWage) };
+        const __m256d maxWage{ _mm256_set1_pd(f.maxWage) };
+        const __m256i eight{ _mm256_set1_epi32(8) };
+        __m256i rows{ _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7) };
+
+        std::size_t selected{ 0 };
+        std::size_t i{ 0 };
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256i id{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i)) };
+            const __m256i age{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ages + i)) };
+            // AVX2 only has "greater than" for integers: a row fails if min > x or x > max
+            const __m256i fails{ _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(minId, id), _mm256_cmpgt_epi32(id, maxId)),
+                                                 _mm256_or_si256(_mm256_cmpgt_epi32(minAge, age), _mm256_cmpgt_epi32(age, maxAge))) };
+            const auto intMask{ static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(fails))) };
+
+            const __m256d wageLow{ _mm256_loadu_pd(wages + i) };
+            const __m256d wageHigh{ _mm256_loadu_pd(wages + i + 4) };
+            const auto wageMask{ static_cast<unsigned>(
+                _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(wageLow, minWage, _CMP_GE_OQ), _mm256_cmp_pd(wageLow, maxWage, _CMP_LE_OQ)))
+                | (_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(wageHigh, minWage, _CMP_GE_OQ), _mm256_cmp_pd(wageHigh, maxWage, _CMP_LE_OQ))) << 4)) };
+
+            const unsigned mask{ ~intMask & wageMask & 0xFF };
+            const __m256i permutation{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kCompressTable[mask].data())) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(selection + selected), _mm256_permutevar8x32_epi32(rows, permutation));
+            selected += static_cast<std::size_t>(std::popcount(mask));
+            rows = _mm256_add_epi32(rows, eight);
+        }
+        return selectScalar(ids, ages, wages, i, count, f, selection, selected);
+    }
+}
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace
+{
+    std::size_t selectAvx512(const int* ids, const int* ages, const double* wages, std::size_t count,
+                             const EmployeeFilter& f, std::uint32_t* selection)
+    {
+        const __m512i minId{ _mm512_set1_epi32(f.minId) };
+        const __m512i maxId{ _mm512_set1_epi32(f.maxId) };
+        const __m512i minAge{ _mm512_set1_epi32(f.minAge) };
+        const __m512i maxAge{ _mm512_set1_epi32(f.maxAge) };
+        const __m512d minWage{ _mm512_set1_pd(f.minWage) };
+        const __m512d maxWage{ _mm512_set1_pd(f.maxWage) };
+        const __m512i sixteen{ _mm512_set1_epi32(16) };
+        __m512i rows{ _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15) };
+
+        std::size_t selected{ 0 };
+        std::size_t i{ 0 };
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512i id{ _mm512_loadu_si512(ids + i) };
+            const __m512i age{ _mm512_loadu_si512(ages + i) };
+            __mmask16 mask{ _mm512_cmpge_epi32_mask(id, minId) };
+            mask = _mm512_mask_cmple_epi32_mask(mask, id, maxId); // the masked compares AND with the mask
+            mask = _mm512_mask_cmpge_epi32_mask(mask, age, minAge);
+            mask = _mm512_mask_cmple_epi32_mask(mask, age, maxAge);
+
+            const __m512d wageLow{ _mm512_loadu_pd(wages + i) };
+            const __m512d wageHigh{ _mm512_loadu_pd(wages + i + 8) };
+            const auto low{ _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(wageLow, minWage, _CMP_GE_OQ), wageLow, maxWage, _CMP_LE_OQ) };
+            const auto high{ _mm512_mask_cmp_pd_mask(_mm512_cmp_pd_mask(wageHigh, minWage, _CMP_GE_OQ), wageHigh, maxWage, _CMP_LE_OQ) };
+            mask = static_cast<__mmask16>(mask & (low | (high << 8)));
+
+            _mm512_mask_compressstoreu_epi32(selection + selected, mask, rows);
+            selected += static_cast<std::size_t>(std::popcount(static_cast<unsigned>(mask)));
+            rows = _mm512_add_epi32(rows, sixteen);
+        }
+        return selectScalar(ids, ages, wages, i, count, f, selection, selected);
+    }
+}
+#pragma GCC pop_options
+
+#endif
+
+namespace
+{
+    bool isSupported(EmployeeTable::Kernel kernel)
+    {
+#ifdef EMPLOYEE_TABLE_X86
+        __builtin_cpu_init(); // needed when called during static initialization
+        switch (kernel)
+        {
+        case EmployeeTable::Kernel::scalar: return true;
+        case EmployeeTable::Kernel::avx2:   return __builtin_cpu_supports("avx2");
+        case EmployeeTable::Kernel::avx512: return __builtin_cpu_supports("avx512f");
+        default:                            return false;
+        }
+#else
+        return kernel == EmployeeTable::Kernel::scalar;
+#endif
+    }
+
+    SelectFunction functionFor(EmployeeTable::Kernel kernel)
+    {
+#ifdef EMPLOYEE_TABLE_X86
+        switch (kernel)
+        {
+        case EmployeeTable::Kernel::avx512: return selectAvx512;
+        case EmployeeTable::Kernel::avx2:   return selectAvx2;
+        default:                            return selectGeneric;
+        }
+#else
+        (void)kernel;
+        return selectGeneric;
+#endif
+    }
+
+    EmployeeTable::Kernel bestKernel()
+    {
+        for (auto kernel : { EmployeeTable::Kernel::avx512, EmployeeTable::Kernel::avx2 })
+        {
+            if (isSupported(kernel))
+                return kernel;
+        }
+        return EmployeeTable::Kernel::scalar;
+    }
+
+    // Chosen once, during static initialization
+    EmployeeTable::Kernel g_kernel{ bestKernel() };
+    SelectFunction g_select{ functionFor(g_kernel) };
+
+    enum class Overlap
+    {
+        none,
+        partial,
+        all,
+    };
+
+    template <typename T>
+    Overlap overlap(T min, T max, T filterMin, T filterMax)
+    {
+        if (max < filterMin || min > filterMax)
+            return Overlap::none;
+        if (min >= filterMin && max <= filterMax)
+            return Overlap::all;
+        return Overlap::partial;
+    }
+}
+
+const char* EmployeeTable::kernelName(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Kernel::scalar: return "scalar";
+    case Kernel::avx2:   return "AVX2";
+    case Kernel::avx512: return "AVX-512";
+    default:             return "???";
+    }
+}
+
+EmployeeTable::Kernel EmployeeTable::activeKernel()
+{
+    return g_kernel;
+}
+
+bool EmployeeTable::setKernel(Kernel kernel)
+{
+    if (!isSupported(kernel))
+        return false;
+
+    g_kernel = kernel;
+    g_select = functionFor(kernel);
+    return true;
+}
+
+void EmployeeTable::reserve(std::size_t count)
+{
+    m_ids.reserve(count);
+    m_ages.reserve(count);
+    m_wages.reserve(count);
+    m_zoneMaps.reserve((count + kChunkSize - 1) / kChunkSize);
+}
+
+void EmployeeTable::append(const Employee& employee)
+{
+    assert(employee.age >= 0);
+
+    if (size() % kChunkSize == 0)
+        m_zoneMaps.emplace_back();
+
+    ZoneMap& zone{ m_zoneMaps.back() };
+    zone.minId = std::min(zone.minId, employee.id);
+    zone.maxId = std::max(zone.maxId, employee.id);
+    zone.minAge = std::min(zone.minAge, employee.age);
+    zone.maxAge = std::max(zone.maxAge, employee.age);
+    if (std::isnan(employee.wage))
+        zone.hasNaN = true;
+    else
+    {
+        zone.minWage = std::min(zone.minWage, employee.wage);
+        zone.maxWage = std::max(zone.maxWage, employee.wage);
+    }
+
+    m_ids.push_back(employee.id);
+    m_ages.push_back(employee.age);
+    m_wages.push_back(employee.wage);
+}
+
+template <typename Visit>
+void EmployeeTable::scan(const EmployeeFilter& filter, int threadCount, Visit&& visit) const
+{
+    auto scanChunks{ [&](std::size_t firstChunk, std::size_t lastChunk) {
+        std::vector<std::uint32_t> selection(kChunkSize + 16);
+        for (std::size_t chunk{ firstChunk }; chunk < lastChunk; ++chunk)
+        {
+            const ZoneMap& zone{ m_zoneMaps[chunk] };
+            const Overlap ids{ overlap(zone.minId, zone.maxId, filter.minId, filter.maxId) };
+            const Overlap ages{ overlap(zone.minAge, zone.maxAge, filter.minAge, filter.maxAge) };
+            const Overlap wages{ (zone.minWage > zone.maxWage) ? Overlap::none // only NaNs
+                                                               : overlap(zone.minWage, zone.maxWage, filter.minWage, filter.maxWage) };
+            if (ids == Overlap::none || ages == Overlap::none || wages == Overlap::none)
+                continue; // the zone map proves that no row matches: the chunk is not even read
+
+            const std::size_t first{ chunk * kChunkSize };
+            const std::size_t rows{ std::min(kChunkSize, size() - first) };
+            if (ids == Overlap::all && ages == Overlap::all && wages == Overlap::all && !zone.hasNaN)
+            {
+                visit(chunk, first, rows, nullptr, rows);
+                continue;
+            }
+
+            const std::size_t selected{ g_select(m_ids.data() + first, m_ages.data() + first, m_wages.data() + first, rows, filter, selection.data()) };
+            visit(chunk, first, rows, selection.data(), selected);
+        }
+    } };
+
+    const std::size_t chunks{ chunkCount() };
+    const auto threads{ static_cast<std::size_t>(std::clamp(threadCount, 1, 256)) };
+    if (threads == 1 || chunks < 2)
+    {
+        scanChunks(0, chunks);
+        return;
+    }
+
+    std::vector<std::thread> workers{};
+    for (std::size_t t{ 1 }; t < threads; ++t)
+        workers.emplace_back(scanChunks, t * chunks / threads, (t + 1) * chunks / threads);
+    scanChunks(0, chunks / threads); // the calling thread takes the first range
+    for (auto& worker : workers)
+        worker.join();
+}
+
+std::vector<std::uint32_t> EmployeeTable::select(const EmployeeFilter& filter) const
+{
+    std::vector<std::uint32_t> result{};
+    scan(filter, 1, [&](std::size_t, std::size_t first, std::size_t rows, const std::uint32_t* selection, std::size_t selected) {
+        for (std::size_t k{ 0 }; k < selected; ++k)
+            result.push_back(static_cast<std::uint32_t>(first + (selection ? selection[k] : k)));
+        (void)rows;
+    });
+    return result;
+}
+
+WageStats EmployeeTable::wageStats(const EmployeeFilter& filter, int threadCount) const
+{
+    std::vector<WageStats> partials(chunkCount()); // one per chunk, each written by one thread
+    scan(filter, threadCount, [&](std::size_t chunk, std::size_t first, std::size_t rows, const std::uint32_t* selection, std::size_t selected) {
+        const double* wages{ m_wages.data() + first };
+        double sum{ 0.0 };
+        if (selection)
+        {
+            for (std::size_t k{ 0 }; k < selected; ++k)
+                sum += wages[selection[k]];
+        }
+        else
+        {
+            for (std::size_t i{ 0 }; i < rows; ++i) // every row: a plain loop over one column
+                sum += wages[i];
+        }
+        partials[chunk] = { selected, sum };
+    });
+
+    WageStats total{};
+    for (const auto& partial : partials)
+    {
+        total.count += partial.count;
+        total.sum += partial.sum;
+    }
+    return total;
+}
+
+std::vector<WageStats> EmployeeTable::wageStatsByAge(const EmployeeFilter& filter, int bucketWidth, int threadCount) const
+{
+    assert(bucketWidth > 0);
+
+    int maxAge{ 0 };
+    for (const auto& zone : m_zoneMaps)
+        maxAge = std::max(maxAge, zone.maxAge);
+    const auto width{ static_cast<std::size_t>(bucketWidth) };
+    const std::size_t bucketCount{ static_cast<std::size_t>(maxAge) / width + 1 };
+
+    // bucketCount partial results per chunk
+    std::vector<WageStats> partials(chunkCount() * bucketCount);
+    scan(filter, threadCount, [&](std::size_t chunk, std::size_t first, std::size_t rows, const std::uint32_t* selection, std::size_t selected) {
+        const int* ages{ m_ages.data() + first };
+        const double* wages{ m_wages.data() + first };
+        WageStats* buckets{ partials.data() + chunk * bucketCount };
+        for (std::size_t k{ 0 }; k < selected; ++k)
+        {
+            const std::size_t row{ selection ? selection[k] : k };
+            WageStats& bucket{ buckets[static_cast<std::size_t>(ages[row]) / width] };
+            ++bucket.count;
+            bucket.sum += wages[row];
+        }
+        (void)rows;
+    });
+
+    std::vector<WageStats> result(bucketCount);
+    for (std::size_t chunk{ 0 }; chunk < chunkCount(); ++chunk)
+    {
+        for (std::size_t b{ 0 }; b < bucketCount; ++b)
+        {
+            result[b].count += partials[chunk * bucketCount + b].count;
+            result[b].sum += partials[chunk * bucketCount + b].sum;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,123 @@
+#ifndef EMPLOYEE_TABLE_H
+#define EMPLOYEE_TABLE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// Employee from lessons/068-struct
+struct Employee
+{
+    int id{};
+    int age{};
+    double wage{};
+};
+
+// WHERE id BETWEEN minId AND maxId AND age BETWEEN ... AND wage BETWEEN ... (all bounds inclusive)
+struct EmployeeFilter
+{
+    int minId{ std::numeric_limits<int>::min() };
+    int maxId{ std::numeric_limits<int>::max() };
+    int minAge{ std::numeric_limits<int>::min() };
+    int maxAge{ std::numeric_limits<int>::max() };
+    double minWage{ -std::numeric_limits<double>::infinity() };
+    double maxWage{ std::numeric_limits<double>::infinity() };
+
+    // The row-at-a-time definition, which the columnar queries must agree with (a NaN wage never matches)
+    bool matches(const Employee& e) const
+    {
+        return e.id >= minId && e.id <= maxId && e.age >= minAge && e.age <= maxAge && e.wage >= minWage && e.wage <= maxWage;
+    }
+};
+
+struct WageStats
+{
+    std::size_t count{};
+    double sum{};
+
+    double average() const { return count ? sum / static_cast<double>(count) : 0.0; }
+};
+
+// Employees stored by column ("structure of arrays") instead of by row (std::vector<Employee>).
+// * A query reads only the columns it uses, packed: "age > 40" reads 4 bytes per employee, not 16.
+// * Zone maps: the min and max of every column for each chunk of kChunkSize rows. A chunk whose ranges
+//   miss the filter is skipped without reading it; a chunk entirely inside the filter is aggregated
+//   without testing each row.
+// * The filter produces a selection vector (the indices of the matching rows in a chunk), computed
+//   8 or 16 rows at a time with AVX2 or AVX-512 when the CPU has them. The aggregates then only
+//   visit the selected rows.
+// * Aggregates are computed per chunk and combined in chunk order: the results do not depend on the
+//   number of threads (see lessons/146-statistics-reductions).
+class EmployeeTable
+{
+public:
+    static constexpr std::size_t kChunkSize{ 4096 };
+
+    enum class Kernel
+    {
+        scalar,
+        avx2,
+        avx512,
+    };
+
+    void reserve(std::size_t count);
+
+    // age must be >= 0 (wageStatsByAge uses it as an index)
+    void append(const Employee& employee);
+
+    std::size_t size() const { return m_ids.size(); }
+
+    Employee operator[](std::size_t index) const
+    {
+        assert(index < size());
+        return { m_ids[index], m_ages[index], m_wages[index] };
+    }
+
+    std::span<const int> ids() const { return m_ids; }
+    std::span<const int> ages() const { return m_ages; }
+    std::span<const double> wages() const { return m_wages; }
+
+    // The indices of the matching rows, in increasing order
+    std::vector<std::uint32_t> select(const EmployeeFilter& filter) const;
+
+    WageStats wageStats(const EmployeeFilter& filter, int threadCount = 1) const;
+
+    // GROUP BY age / bucketWidth: element b covers the ages [b * bucketWidth, (b + 1) * bucketWidth)
+    std::vector<WageStats> wageStatsByAge(const EmployeeFilter& filter, int bucketWidth, int threadCount = 1) const;
+
+    static const char* kernelName(Kernel kernel);
+    static Kernel activeKernel();
+
+    // For benchmarking. Returns false (and changes nothing) if the CPU does not support kernel.
+    // Not thread-safe: call it while no query is running.
+    static bool setKernel(Kernel kernel);
+
+private:
+    struct ZoneMap
+    {
+        int minId{ std::numeric_limits<int>::max() };
+        int maxId{ std::numeric_limits<int>::min() };
+        int minAge{ std::numeric_limits<int>::max() };
+        int maxAge{ std::numeric_limits<int>::min() };
+        double minWage{ std::numeric_limits<double>::infinity() };
+        double maxWage{ -std::numeric_limits<double>::infinity() };
+        bool hasNaN{ false };
+    };
+
+    std::vector<int> m_ids{};
+    std::vector<int> m_ages{};
+    std::vector<double> m_wages{};
+    std::vector<ZoneMap> m_zoneMaps{}; // one per chunk
+
+    std::size_t chunkCount() const { return m_zoneMaps.size(); }
+
+    // Calls visit(chunk, firstRow, rowCount, selection, selectedCount) for every chunk that may match,
+    // from threadCount threads. selection is nullptr when every row of the chunk matches.
+    template <typename Visit>
+    void scan(const EmployeeFilter& filter, int threadCount, Visit&& visit) const;
+};
+
+#endif
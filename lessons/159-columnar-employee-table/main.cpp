@@ -0,0 +1,247 @@
+/* Columnar storage
+
+- lessons/068-struct: struct Employee { int id; int age; double wage; }. A std::vector<Employee> stores
+  employees one after the other ("array of structures", row-wise).
+- A query like "average wage of the employees over 40" reads every Employee whole: 16 bytes per row,
+  for the 12 bytes it uses. "How many employees are over 40" uses 4 of the 16.
+- EmployeeTable.h stores one array per field (columnar, "structure of arrays"), the way analytical
+  databases (DuckDB, ClickHouse, Parquet files) do:
+  + a query only reads the columns it uses, and each column is a dense array the CPU streams through,
+  + zone maps (min and max per chunk of rows) skip whole chunks,
+  + filters produce selection vectors with SIMD instructions (lessons/149-simd-vector-math),
+  + aggregates run on several threads and are combined in a fixed order (lessons/146-statistics-reductions).
+*/
+
+#include "EmployeeTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+void printEmployee(const Employee& employee)
+{
+    std::cout << "ID:   " << employee.id << '\n';
+    std::cout << "Age:  " << employee.age << '\n';
+    std::cout << "Wage: " << employee.wage << '\n';
+}
+
+bool examples()
+{
+    EmployeeTable table{};
+    table.append({ 1, 32, 60000.0 });
+    table.append({ 2, 28, 45000.0 });
+    table.append({ 3, 45, 72000.0 });
+    table.append({ 4, 51, 38000.0 });
+    table.append({ 5, 23, 31000.0 });
+
+    printEmployee(table[2]);
+
+    // SELECT id WHERE age >= 30 AND wage >= 50000
+    const auto rows{ table.select({ .minAge = 30, .minWage = 50000.0 }) };
+    std::cout << "age >= 30 and wage >= 50000:";
+    for (auto row : rows)
+        std::cout << ' ' << table[row].id;
+    std::cout << '\n';
+
+    // SELECT AVG(wage) WHERE age > 40
+    const WageStats over40{ table.wageStats({ .minAge = 41 }) };
+    std::cout << "average wage over 40: " << over40.average() << '\n';
+
+    // SELECT age / 10 * 10, COUNT(*), AVG(wage) GROUP BY age / 10
+    const auto byDecade{ table.wageStatsByAge({}, 10) };
+    for (std::size_t b{ 0 }; b < byDecade.size(); ++b)
+        if (byDecade[b].count > 0)
+            std::cout << b * 10 << "s: " << byDecade[b].count << " employee(s), average wage " << byDecade[b].average() << '\n';
+
+    return rows == std::vector<std::uint32_t>{ 0, 2 } && over40.count == 2 && over40.average() == 55000.0
+        && byDecade.size() == 6 && byDecade[2].count == 2 && byDecade[5].count == 1;
+}
+
+
+/* Benchmark
+
+- count employees: ids in increasing order (as if appended over time), ages uniform in [18, 67],
+  wages uniform in [20000, 120000].
+- Three queries, each computed:
+  + row-wise: one loop over a std::vector<Employee>, testing EmployeeFilter::matches(),
+  + columnar, with each selection kernel the CPU supports, on 1 thread and on all hardware threads.
+- Queries:
+  + average wage where age > 40: about 54% of the rows, unpredictable for a branch,
+  + average wage where id is in a 1% range: the zone maps skip 99% of the chunks,
+  + count and average wage by age decade, where wage > 50000.
+- The columnar results must match the row-wise ones: counts exactly, sums to 1e-9 (relative), as
+  they are added in a different order.
+*/
+
+struct Query
+{
+    const char* name{};
+    EmployeeFilter filter{};
+    bool groupByAge{};
+};
+
+// The whole answer, flattened: one WageStats, or one per age bucket
+std::vector<WageStats> rowWise(const std::vector<Employee>& employees, const Query& query)
+{
+    std::vector<WageStats> result(query.groupByAge ? 7 : 1);
+    for (const Employee& e : employees)
+    {
+        if (query.filter.matches(e))
+        {
+            WageStats& stats{ result[query.groupByAge ? static_cast<std::size_t>(e.age / 10) : 0] };
+            ++stats.count;
+            stats.sum += e.wage;
+        }
+    }
+    return result;
+}
+
+std::vector<WageStats> columnar(const EmployeeTable& table, const Query& query, int threadCount)
+{
+    if (query.groupByAge)
+    {
+        auto result{ table.wageStatsByAge(query.filter, 10, threadCount) };
+        result.resize(7); // the highest buckets may be empty
+        return result;
+    }
+    return { table.wageStats(query.filter, threadCount) };
+}
+
+bool sameResult(const std::vector<WageStats>& a, const std::vector<WageStats>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i{ 0 }; i < a.size(); ++i)
+        if (a[i].count != b[i].count || std::abs(a[i].sum - b[i].sum) > 1e-9 * std::abs(b[i].sum))
+            return false;
+    return true;
+}
+
+template <typename F>
+double bestMilliseconds(F&& f, int repeats = 5)
+{
+    double best{ 1e300 };
+    for (int r{ 0 }; r < repeats; ++r)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 159 };
+    std::uniform_int_distribution age{ 18, 67 };
+    std::uniform_real_distribution wage{ 20000.0, 120000.0 };
+
+    std::vector<Employee> employees{};
+    EmployeeTable table{};
+    employees.reserve(count);
+    table.reserve(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        const Employee employee{ static_cast<int>(i + 1), age(rng), wage(rng) };
+        employees.push_back(employee);
+        table.append(employee);
+    }
+
+    const int idRange{ static_cast<int>(count / 100) };
+    const int firstId{ static_cast<int>(count / 2) };
+    const Query queries[]{
+        { "avg wage, age > 40", { .minAge = 41 }, false },
+        { "avg wage, 1% of ids", { .minId = firstId, .maxId = firstId + idRange - 1 }, false },
+        { "by age, wage > 50000", { .minWage = 50000.0 }, true },
+    };
+
+    const int hardwareThreads{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+    std::vector<EmployeeTable::Kernel> kernels{};
+    for (auto kernel : { EmployeeTable::Kernel::scalar, EmployeeTable::Kernel::avx2, EmployeeTable::Kernel::avx512 })
+        if (EmployeeTable::setKernel(kernel))
+            kernels.push_back(kernel);
+
+    std::cout << count << " employees, " << hardwareThreads << " hardware thread(s), times in ms\n"
+              << std::setw(22) << "query" << std::setw(11) << "row-wise";
+    for (auto kernel : kernels)
+        std::cout << std::setw(10) << EmployeeTable::kernelName(kernel) << std::setw(12) << "(threads)";
+    std::cout << '\n';
+
+    bool ok{ true };
+    for (const Query& query : queries)
+    {
+        std::vector<WageStats> expected{};
+        const double rowMs{ bestMilliseconds([&] { expected = rowWise(employees, query); }) };
+        std::cout << std::fixed << std::setprecision(2) << std::setw(22) << query.name << std::setw(11) << rowMs;
+
+        for (auto kernel : kernels)
+        {
+            EmployeeTable::setKernel(kernel);
+            std::vector<WageStats> single{};
+            std::vector<WageStats> parallel{};
+            const double singleMs{ bestMilliseconds([&] { single = columnar(table, query, 1); }) };
+            const double parallelMs{ bestMilliseconds([&] { parallel = columnar(table, query, hardwareThreads); }) };
+            std::cout << std::setw(10) << singleMs << std::setw(12) << parallelMs;
+
+            ok = ok && sameResult(single, expected) && sameResult(parallel, expected);
+        }
+        std::cout << '\n';
+    }
+
+    // select() agrees with the row-wise filter
+    const EmployeeFilter filter{ .minAge = 30, .maxAge = 39, .minWage = 100000.0 };
+    for (auto kernel : kernels)
+    {
+        EmployeeTable::setKernel(kernel);
+        const auto rows{ table.select(filter) };
+        std::size_t k{ 0 };
+        for (std::size_t i{ 0 }; i < employees.size() && ok; ++i)
+        {
+            if (filter.matches(employees[i]))
+                ok = k < rows.size() && rows[k++] == i;
+        }
+        ok = ok && k == rows.size();
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Columns make appends and whole-row reads slower (3 arrays to write or read instead of 1): rows suit
+  transactions (one employee at a time), columns suit analytics (one field of many employees).
+- Zone maps only help when the values are clustered: ids or dates that grow with insertion order.
+  Random ages give every chunk the range [18, 67], and nothing is skipped.
+- A selection vector decouples the filter from the aggregate: the filter runs at SIMD speed with
+  no branches, and the aggregate only visits the rows that passed. A chunk that matches entirely
+  skips the filter: the aggregate reads the column directly.
+- The per-chunk partial results cost memory (one WageStats per chunk, per group) but make the result
+  independent of the thread count, like lessons/146-statistics-reductions.
+- The rows are limited to 2^32 (std::uint32_t selection indices within a table).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/introduction-to-structs-members-and-member-selection/
+- https://en.wikipedia.org/wiki/AoS_and_SoA
+- https://duckdb.org/why_duckdb (vectorized columnar execution)
+- https://www.cidrdb.org/cidr2005/papers/P19.pdf (MonetDB/X100: Hyper-Pipelining Query Execution)
+*/
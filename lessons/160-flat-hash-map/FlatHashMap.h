@@ -0,0 +1,458 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>  // for std::hash, std::equal_to
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // part of every x86-64 CPU: no runtime dispatch needed
+#endif
+
+// Hashes for FlatHashMap: a full 64-bit mix, because the map uses both the low bits (the slot)
+// and 7 other bits (the control byte) of every hash.
+namespace FlatHashing
+{
+    // splitmix64 finalizer (as in lessons/156-static-map)
+    inline std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    inline std::uint64_t combine(std::uint64_t seed, std::uint64_t h)
+    {
+        return mix(seed + 0x9E3779B97F4A7C15ull + h);
+    }
+
+    // 8 bytes per step; the last (partial) word is read overlapping the previous one
+    inline std::uint64_t hashBytes(const char* p, std::size_t n)
+    {
+        auto load{ [](const char* q, std::size_t size) {
+            std::uint64_t word{ 0 };
+            std::memcpy(&word, q, size);
+            return word;
+        } };
+
+        std::uint64_t h{ n * 0x9E3779B97F4A7C15ull };
+        if (n >= 8)
+        {
+            for (std::size_t i{ 0 }; i + 8 < n; i += 8)
+                h = (h ^ load(p + i, 8)) * 0xBF58476D1CE4E5B9ull;
+            h ^= load(p + n - 8, 8);
+        }
+        else if (n >= 4)
+            h ^= load(p, 4) | (load(p + n - 4, 4) << 32);
+        else if (n > 0)
+            h ^= std::uint64_t{ static_cast<unsigned char>(p[0]) } | (std::uint64_t{ static_cast<unsigned char>(p[n / 2]) } << 8)
+                | (std::uint64_t{ static_cast<unsigned char>(p[n - 1]) } << 16);
+        return mix(h);
+    }
+
+    // A struct with first and second members: Pair<T, U> (lessons/070-class-template), std::pair...
+    template <typename T>
+    concept PairLike = requires(const T& t) {
+        t.first;
+        t.second;
+    };
+}
+
+// The default hash. The primary template mixes std::hash, which for integers is the identity.
+template <typename T>
+struct FlatHash
+{
+    std::uint64_t operator()(const T& value) const { return FlatHashing::mix(static_cast<std::uint64_t>(std::hash<T>{}(value))); }
+};
+
+// Strings: transparent (is_transparent), so a map keyed by std::string can be searched with a std::string_view
+// or a string literal, without building a std::string
+template <>
+struct FlatHash<std::string_view>
+{
+    using is_transparent = void;
+    std::uint64_t operator()(std::string_view s) const { return FlatHashing::hashBytes(s.data(), s.size()); }
+};
+
+template <>
+struct FlatHash<std::string> : FlatHash<std::string_view>
+{
+};
+
+template <FlatHashing::PairLike T>
+struct FlatHash<T>
+{
+    std::uint64_t operator()(const T& pair) const
+    {
+        using First = std::remove_cvref_t<decltype(pair.first)>;
+        using Second = std::remove_cvref_t<decltype(pair.second)>;
+        return FlatHashing::combine(FlatHash<First>{}(pair.first), FlatHash<Second>{}(pair.second));
+    }
+};
+
+// FlatHashMap<Key, Value>: a hash map stored in one flat array of slots ("open addressing"), with a
+// parallel array of 1-byte control bytes, in the style of Abseil's Swiss tables.
+// * std::unordered_map allocates one node per element and chains them from the buckets: every lookup
+//   follows at least two pointers, every insert allocates. Here the elements are in the array itself.
+// * Control byte: 0x80 for an empty slot, or 7 bits of the key's hash for a full one. A lookup compares
+//   16 control bytes at once with SSE2 and only compares keys whose 7 bits match (1 in 128 false matches).
+// * Linear probing: a key lives at its home slot (hash & mask) or after it, with no empty slot in between.
+//   Erase shifts the following keys back into the hole ("backward shift deletion"), so there are no
+//   tombstones: lookups never slow down after many erases, and no periodic cleanup is needed.
+// * Heterogeneous lookup: with a transparent Hash and Equal (the default for strings), find() and erase()
+//   take any type the hash and the comparison accept.
+// * Insert and erase move elements: pointers to values are invalidated by both (unlike std::unordered_map).
+template <typename Key, typename Value, typename Hash = FlatHash<Key>, typename Equal = std::equal_to<>>
+class FlatHashMap
+{
+public:
+    static constexpr std::size_t kGroupWidth{ 16 };
+
+private:
+    using Slot = std::pair<Key, Value>;
+
+    static constexpr std::uint8_t kEmpty{ 0x80 };
+    static constexpr std::size_t kMinCapacity{ kGroupWidth };
+
+    template <typename K>
+    static constexpr bool kLookupWith{ std::is_same_v<K, Key>
+                                       || (requires { typename Hash::is_transparent; } && requires { typename Equal::is_transparent; }) };
+
+    // m_control has capacity + kGroupWidth - 1 bytes: the first 15 are repeated at the end, so that
+    // 16 bytes can be loaded from any position without wrapping around
+    std::vector<std::uint8_t> m_control{};
+    Slot* m_slots{ nullptr };
+    std::size_t m_capacity{ 0 }; // 0 or a power of two >= kMinCapacity
+    std::size_t m_size{ 0 };
+    [[no_unique_address]] Hash m_hash{};
+    [[no_unique_address]] Equal m_equal{};
+
+public:
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap& other)
+        : m_hash{ other.m_hash }, m_equal{ other.m_equal }
+    {
+        reserve(other.m_size);
+        other.forEach([this](const Key& key, const Value& value) { try_emplace(key, value); });
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : m_control{ std::move(other.m_control) }
+        , m_slots{ std::exchange(other.m_slots, nullptr) }
+        , m_capacity{ std::exchange(other.m_capacity, 0) }
+        , m_size{ std::exchange(other.m_size, 0) }
+        , m_hash{ std::move(other.m_hash) }
+        , m_equal{ std::move(other.m_equal) }
+    {
+        other.m_control.clear();
+    }
+
+    FlatHashMap& operator=(FlatHashMap other) noexcept // copy (or move) and swap
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~FlatHashMap()
+    {
+        clear();
+        if (m_slots)
+            std::allocator<Slot>{}.deallocate(m_slots, m_capacity);
+    }
+
+    void swap(FlatHashMap& other) noexcept
+    {
+        using std::swap;
+        swap(m_control, other.m_control);
+        swap(m_slots, other.m_slots);
+        swap(m_capacity, other.m_capacity);
+        swap(m_size, other.m_size);
+        swap(m_hash, other.m_hash);
+        swap(m_equal, other.m_equal);
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    std::size_t capacity() const { return m_capacity; }
+
+    // At most 7/8 of the slots are full
+    static constexpr std::size_t maxSizeFor(std::size_t capacity) { return capacity - capacity / 8; }
+
+    // Makes room for count elements without rehashing
+    void reserve(std::size_t count)
+    {
+        std::size_t capacity{ std::max(m_capacity, kMinCapacity) };
+        while (maxSizeFor(capacity) < count)
+            capacity *= 2;
+        if (capacity != m_capacity)
+            rehash(capacity);
+    }
+
+    void clear()
+    {
+        if constexpr (!std::is_trivially_destructible_v<Slot>)
+        {
+            for (std::size_t i{ 0 }; i < m_capacity; ++i)
+                if (m_control[i] != kEmpty)
+                    std::destroy_at(m_slots + i);
+        }
+        std::fill(m_control.begin(), m_control.end(), kEmpty);
+        m_size = 0;
+    }
+
+    // nullptr if the key is not in the map
+    template <typename K>
+        requires kLookupWith<K>
+    Value* find(const K& key)
+    {
+        const std::size_t i{ findIndex(key) };
+        return (i == npos) ? nullptr : &m_slots[i].second;
+    }
+
+    template <typename K>
+        requires kLookupWith<K>
+    const Value* find(const K& key) const
+    {
+        const std::size_t i{ findIndex(key) };
+        return (i == npos) ? nullptr : &m_slots[i].second;
+    }
+
+    // Overloads for the key type itself, so that { 1, 2 } or "text" can be passed directly
+    Value* find(const Key& key) { return find<Key>(key); }
+    const Value* find(const Key& key) const { return find<Key>(key); }
+
+    template <typename K>
+        requires kLookupWith<K>
+    bool contains(const K& key) const
+    {
+        return findIndex(key) != npos;
+    }
+
+    bool contains(const Key& key) const { return contains<Key>(key); }
+
+    Value& at(const Key& key)
+    {
+        Value* value{ find(key) };
+        if (!value)
+            throw std::out_of_range{ "FlatHashMap::at: key not found" };
+        return *value;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        const Value* value{ find(key) };
+        if (!value)
+            throw std::out_of_range{ "FlatHashMap::at: key not found" };
+        return *value;
+    }
+
+    // Inserts { key, Value(args...) } if the key is not in the map; does nothing otherwise.
+    // Returns the value for key, and whether it was inserted.
+    template <typename... Args>
+    std::pair<Value*, bool> try_emplace(const Key& key, Args&&... args)
+    {
+        return emplaceKey(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<Value*, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        return emplaceKey(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Inserts or replaces
+    template <typename V>
+    std::pair<Value*, bool> insert_or_assign(const Key& key, V&& value)
+    {
+        auto result{ try_emplace(key, std::forward<V>(value)) };
+        if (!result.second)
+            *result.first = std::forward<V>(value);
+        return result;
+    }
+
+    Value& operator[](const Key& key) { return *try_emplace(key).first; }
+    Value& operator[](Key&& key) { return *try_emplace(std::move(key)).first; }
+
+    // Returns whether the key was in the map
+    template <typename K>
+        requires kLookupWith<K>
+    bool erase(const K& key)
+    {
+        const std::size_t i{ findIndex(key) };
+        if (i == npos)
+            return false;
+        eraseAt(i);
+        return true;
+    }
+
+    bool erase(const Key& key) { return erase<Key>(key); }
+
+    // Calls f(key, value) for every element, in no particular order
+    template <typename F>
+    void forEach(F&& f)
+    {
+        for (std::size_t i{ 0 }; i < m_capacity; ++i)
+            if (m_control[i] != kEmpty)
+                f(std::as_const(m_slots[i].first), m_slots[i].second);
+    }
+
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (std::size_t i{ 0 }; i < m_capacity; ++i)
+            if (m_control[i] != kEmpty)
+                f(std::as_const(m_slots[i].first), std::as_const(m_slots[i].second));
+    }
+
+private:
+    static constexpr std::size_t npos{ static_cast<std::size_t>(-1) };
+
+    std::size_t mask() const { return m_capacity - 1; }
+
+    // The low bits pick the home slot; 7 high bits go in the control byte
+    std::size_t homeOf(std::uint64_t h) const { return static_cast<std::size_t>(h) & mask(); }
+    static std::uint8_t controlOf(std::uint64_t h) { return static_cast<std::uint8_t>(h >> 57); }
+
+    // Bit i is set if control byte position + i equals byte / is empty
+    struct GroupMasks
+    {
+        std::uint32_t matches{};
+        std::uint32_t empties{};
+    };
+
+    GroupMasks probeGroup(std::size_t position, std::uint8_t byte) const
+    {
+        const std::uint8_t* control{ m_control.data() + position };
+#if defined(__SSE2__)
+        const __m128i group{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(control)) };
+        const __m128i target{ _mm_set1_epi8(static_cast<char>(byte)) };
+        return { static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, target))),
+                 static_cast<std::uint32_t>(_mm_movemask_epi8(group)) }; // the high bit: only set in kEmpty
+#else
+        GroupMasks masks{};
+        for (std::uint32_t i{ 0 }; i < kGroupWidth; ++i)
+        {
+            masks.matches |= std::uint32_t{ control[i] == byte } << i;
+            masks.empties |= std::uint32_t{ control[i] == kEmpty } << i;
+        }
+        return masks;
+#endif
+    }
+
+    void setControl(std::size_t i, std::uint8_t byte)
+    {
+        m_control[i] = byte;
+        if (i < kGroupWidth - 1)
+            m_control[m_capacity + i] = byte;
+    }
+
+    template <typename K>
+    std::size_t findIndex(const K& key) const
+    {
+        if (m_size == 0)
+            return npos;
+
+        const std::uint64_t h{ m_hash(key) };
+        const std::uint8_t byte{ controlOf(h) };
+        for (std::size_t position{ homeOf(h) };; position = (position + kGroupWidth) & mask())
+        {
+            const GroupMasks masks{ probeGroup(position, byte) };
+            for (std::uint32_t matches{ masks.matches }; matches != 0; matches &= matches - 1)
+            {
+                const std::size_t i{ (position + static_cast<std::size_t>(std::countr_zero(matches))) & mask() };
+                if (m_equal(m_slots[i].first, key))
+                    return i;
+            }
+            if (masks.empties != 0) // the key would be before the first empty slot
+                return npos;
+        }
+    }
+
+    // The first empty slot at or after the home of h (there always is one: the map is never full)
+    std::size_t findEmpty(std::uint64_t h) const
+    {
+        for (std::size_t position{ homeOf(h) };; position = (position + kGroupWidth) & mask())
+        {
+            const std::uint32_t empties{ probeGroup(position, kEmpty).empties };
+            if (empties != 0)
+                return (position + static_cast<std::size_t>(std::countr_zero(empties))) & mask();
+        }
+    }
+
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> emplaceKey(K&& key, Args&&... args)
+    {
+        if (const std::size_t i{ findIndex(key) }; i != npos)
+            return { &m_slots[i].second, false };
+
+        if (m_size + 1 > maxSizeFor(m_capacity))
+            rehash(std::max(m_capacity * 2, kMinCapacity));
+
+        const std::uint64_t h{ m_hash(key) };
+        const std::size_t i{ findEmpty(h) };
+        std::construct_at(m_slots + i, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        setControl(i, controlOf(h));
+        ++m_size;
+        return { &m_slots[i].second, true };
+    }
+
+    void eraseAt(std::size_t i)
+    {
+        std::destroy_at(m_slots + i);
+
+        // Walk the rest of the run (up to the next empty slot). A key can fill the hole if its home
+        // is not between the hole and itself: it would still be reachable from its home.
+        std::size_t hole{ i };
+        for (std::size_t j{ (i + 1) & mask() }; m_control[j] != kEmpty; j = (j + 1) & mask())
+        {
+            const std::size_t home{ homeOf(m_hash(m_slots[j].first)) };
+            if (((j - home) & mask()) >= ((j - hole) & mask()))
+            {
+                std::construct_at(m_slots + hole, std::move(m_slots[j]));
+                std::destroy_at(m_slots + j);
+                setControl(hole, m_control[j]);
+                hole = j;
+            }
+        }
+        setControl(hole, kEmpty);
+        --m_size;
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::vector<std::uint8_t> oldControl(capacity + kGroupWidth - 1, kEmpty);
+        oldControl.swap(m_control);
+        Slot* oldSlots{ std::exchange(m_slots, std::allocator<Slot>{}.allocate(capacity)) };
+        const std::size_t oldCapacity{ std::exchange(m_capacity, capacity) };
+
+        for (std::size_t i{ 0 }; i < oldCapacity; ++i)
+        {
+            if (oldControl[i] == kEmpty)
+                continue;
+            const std::uint64_t h{ m_hash(oldSlots[i].first) };
+            const std::size_t j{ findEmpty(h) };
+            std::construct_at(m_slots + j, std::move(oldSlots[i]));
+            std::destroy_at(oldSlots + i);
+            setControl(j, controlOf(h));
+        }
+        if (oldSlots)
+            std::allocator<Slot>{}.deallocate(oldSlots, oldCapacity);
+    }
+};
+
+#endif
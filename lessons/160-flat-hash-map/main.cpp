@@ -0,0 +1,199 @@
+/* A flat hash map
+
+- lessons/070-class-template: Pair<T, U> { T first; U second; }, and lessons/077: a constexpr Pair.
+  A pair makes a natural composite key: (x, y) grid cells, (from, to) graph edges, (userId, itemId)...
+- std::unordered_map<Pair<int, int>, int> needs a hash (there is no std::hash<Pair>), and it stores
+  every element in its own heap node, linked from an array of buckets:
+  + a lookup reads the bucket, then the node (two cache misses in a big map),
+  + an insert allocates, an erase frees.
+- FlatHashMap.h: the elements in one array, found through 16-at-a-time SIMD comparisons of 1-byte
+  control bytes (the design of Abseil's Swiss tables), with FlatHash: a default hash for Pair-like
+  types, integers and strings.
+*/
+
+#include "FlatHashMap.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// From lessons/070-class-template, plus an operator== for lookups
+template <typename T, typename U>
+struct Pair
+{
+    T first{};
+    U second{};
+
+    friend bool operator==(const Pair&, const Pair&) = default;
+};
+
+bool examples()
+{
+    // Edges of a graph: (from, to) -> weight
+    FlatHashMap<Pair<int, int>, double> weights{};
+    weights[{ 1, 2 }] = 0.5;
+    weights[{ 2, 3 }] = 1.5;
+    weights.try_emplace({ 1, 3 }, 4.0);
+    const bool inserted{ weights.try_emplace({ 1, 2 }, 9.9).second }; // already there: not replaced
+
+    std::cout << "1 -> 2: " << weights.at({ 1, 2 }) << ", 2 -> 1 present: " << weights.contains({ 2, 1 }) << '\n';
+    weights.erase({ 2, 3 });
+    weights.forEach([](const Pair<int, int>& edge, double weight) {
+        std::cout << edge.first << " -> " << edge.second << ": " << weight << '\n';
+    });
+
+    // Heterogeneous lookup: std::string keys, searched with a std::string_view or a string literal
+    FlatHashMap<std::string, int> wordCounts{};
+    for (std::string_view word : { "the", "cat", "sat", "on", "the", "mat" })
+        ++wordCounts[std::string{ word }];
+    const std::string_view the{ "the" };
+    const int* count{ wordCounts.find(the) }; // no std::string is built
+    std::cout << "\"the\": " << *count << ", \"dog\": " << (wordCounts.find("dog") ? "found" : "not found") << '\n';
+
+    // Many inserts and erases: no tombstones, so the map stays as fast (and as small) as a fresh one
+    FlatHashMap<int, int> churn{};
+    for (int round{ 0 }; round < 100; ++round)
+    {
+        for (int i{ 0 }; i < 1000; ++i)
+            churn[round * 1000 + i] = i;
+        for (int i{ 0 }; i < 1000; ++i)
+            churn.erase(round * 1000 + i);
+    }
+    churn[7] = 7;
+    std::cout << "after 100,000 inserts and erases: size " << churn.size() << ", capacity " << churn.capacity() << '\n';
+
+    FlatHashMap copy{ weights };
+    return !inserted && weights.size() == 2 && *weights.find({ 1, 3 }) == 4.0 && !weights.contains({ 2, 3 }) && *count == 2
+        && wordCounts.size() == 5 && churn.size() == 1 && churn.capacity() == 2048 && copy.size() == 2 && copy.at({ 1, 2 }) == 0.5;
+}
+
+
+/* Benchmark
+
+- Keys: random Pair<int, int>. Both maps use the same hash (FlatHash), so only the data structure differs.
+- For 1,000 entries up to count (10x steps), nanoseconds per operation:
+  + insert count keys (starting empty: the growth is included),
+  + find each key (hits), then count keys that are not in the map (misses),
+  + erase each key.
+- 100,000,000 entries (pass 100000000) need about 2 GB for FlatHashMap and 5 GB for std::unordered_map.
+*/
+
+using Key = Pair<int, int>;
+
+template <typename Map>
+struct Timings
+{
+    double insert{};
+    double hit{};
+    double miss{};
+    double erase{};
+    std::size_t found{};
+};
+
+template <typename Map>
+Timings<Map> measure(const std::vector<Key>& keys, const std::vector<Key>& absent)
+{
+    using Clock = std::chrono::steady_clock;
+    auto nsPerOp{ [&](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(keys.size());
+    } };
+
+    Timings<Map> t{};
+    Map map{};
+    auto start{ Clock::now() };
+    for (std::size_t i{ 0 }; i < keys.size(); ++i)
+        map.try_emplace(keys[i], static_cast<int>(i));
+    t.insert = nsPerOp(start);
+
+    start = Clock::now();
+    for (const Key& key : keys)
+        t.found += map.contains(key);
+    t.hit = nsPerOp(start);
+
+    start = Clock::now();
+    for (const Key& key : absent)
+        t.found += map.contains(key);
+    t.miss = nsPerOp(start);
+
+    start = Clock::now();
+    for (const Key& key : keys)
+        t.found += map.erase(key);
+    t.erase = nsPerOp(start);
+
+    t.found += map.size(); // must end empty
+    return t;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937_64 rng{ 160 };
+    std::uniform_int_distribution<int> coordinate{};
+
+    std::cout << std::setw(12) << "entries" << std::setw(24) << "insert" << std::setw(24) << "find (hit)" << std::setw(24)
+              << "find (miss)" << std::setw(24) << "erase" << '\n'
+              << std::setw(12) << "" << std::string(4, ' ') << "   unordered      flat" << "   unordered      flat"
+              << "   unordered      flat" << "   unordered      flat" << "   (ns per operation)\n";
+
+    bool ok{ true };
+    for (std::size_t n{ 1000 }; n <= count; n *= 10)
+    {
+        // Distinct keys: odd first coordinates in the map, even ones for the misses
+        std::vector<Key> keys(n);
+        std::vector<Key> absent(n);
+        for (std::size_t i{ 0 }; i < n; ++i)
+        {
+            keys[i] = { coordinate(rng) | 1, static_cast<int>(i) };
+            absent[i] = { coordinate(rng) & ~1, static_cast<int>(i) };
+        }
+
+        const auto unordered{ measure<std::unordered_map<Key, int, FlatHash<Key>>>(keys, absent) };
+        const auto flat{ measure<FlatHashMap<Key, int>>(keys, absent) };
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(12) << n << "    " << std::setw(12) << unordered.insert
+                  << std::setw(10) << flat.insert << std::setw(14) << unordered.hit << std::setw(10) << flat.hit << std::setw(14)
+                  << unordered.miss << std::setw(10) << flat.miss << std::setw(14) << unordered.erase << std::setw(10) << flat.erase << '\n';
+
+        ok = ok && unordered.found == 2 * n && flat.found == 2 * n; // n hits + n erases
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Memory: FlatHashMap uses (sizeof(Pair<Key, Value>) + 1) bytes per slot, with 1/8 to 9/16 of the slots
+  empty. std::unordered_map: one node per element (the pair, a next pointer, the cached hash on
+  libstdc++, plus the allocator's overhead) and one pointer per bucket.
+- Abseil probes groups quadratically (group 1, 2, 3... further) and marks erased slots "deleted"
+  (tombstones), cleaned up by the next rehash. Linear probing allows backward shift deletion instead,
+  at the cost of re-hashing the keys that follow an erased one.
+- The hash must mix well: with linear probing, an identity hash on sequential integers fills runs of
+  adjacent slots, and the control bytes would all be equal.
+- Like std::unordered_map, keys are compared with operator== (std::equal_to<>): Pair needs one.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/class-templates/
+- https://abseil.io/about/design/swisstables
+- https://en.wikipedia.org/wiki/Linear_probing#Deletion
+- https://en.cppreference.com/w/cpp/container/unordered_map/find (heterogeneous lookup, C++20)
+*/
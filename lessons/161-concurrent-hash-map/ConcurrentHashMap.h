@@ -0,0 +1,339 @@
+#ifndef CONCURRENT_HASH_MAP_H
+#define CONCURRENT_HASH_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional> // for std::hash
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ConcurrentHashMap<Key, Value>: a hash map that any number of threads can use at once.
+// * Sharded: the keys are split into shards by hash, each with its own mutex, so writers to different
+//   shards never wait for each other (one std::mutex around a std::unordered_map serializes everything).
+// * Lock-free reads: a reader takes no lock and writes nothing shared. Each shard has a version
+//   counter ("seqlock"): a writer makes it odd while it modifies the shard and even again when done.
+//   A reader notes the version, reads, and checks that the version has not changed; if it has,
+//   the read may have seen a half-written entry, and it retries.
+// * Because readers may read while a writer writes, entries are stored in std::atomic words and
+//   copied in and out with memcpy: Key and Value must be trivially copyable (ints, enums, structs of
+//   them...). A reader can see a mix of two entries (it retries), so any bit pattern must be harmless
+//   to copy and compare: no bool, pointers are fine as long as they are not dereferenced during the read.
+// * A shard grows by allocating a table twice as big. Readers may still be reading the old table:
+//   it is kept until the map is destroyed (at most as much memory again as the current tables).
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    requires std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value> && std::default_initializable<Key>
+          && std::default_initializable<Value>
+class ConcurrentHashMap
+{
+private:
+    static constexpr std::size_t kCacheLineSize{ 64 };
+    static constexpr std::size_t kMinCapacity{ 16 };
+
+    template <typename T>
+    static constexpr std::size_t kWords{ (sizeof(T) + 7) / 8 };
+    static constexpr std::size_t kSlotWords{ kWords<Key> + kWords<Value> };
+
+    using Word = std::atomic<std::uint64_t>;
+
+    struct Table
+    {
+        std::size_t capacity{};
+        std::unique_ptr<Word[]> words{};                     // kSlotWords per slot: the key, then the value
+        std::unique_ptr<std::atomic<std::uint8_t>[]> full{}; // 1 if the slot holds an entry
+
+        explicit Table(std::size_t slotCount)
+            : capacity{ slotCount }
+            , words{ std::make_unique<Word[]>(slotCount * kSlotWords) }
+            , full{ std::make_unique<std::atomic<std::uint8_t>[]>(slotCount) }
+        {
+        }
+
+        Word* keyWords(std::size_t slot) const { return words.get() + slot * kSlotWords; }
+        Word* valueWords(std::size_t slot) const { return words.get() + slot * kSlotWords + kWords<Key>; }
+        bool isFull(std::size_t slot) const { return full[slot].load(std::memory_order_relaxed) != 0; }
+    };
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        std::atomic<std::uint64_t> version{ 0 }; // odd while a writer modifies the shard
+        std::atomic<Table*> table{ nullptr };
+        std::atomic<std::size_t> size{ 0 };
+        std::mutex mutex{};                         // held by writers only
+        std::vector<std::unique_ptr<Table>> tables{}; // the current one last; the others may still have readers
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::size_t m_shardMask;
+    [[no_unique_address]] Hash m_hash{};
+
+public:
+    // Default: 4 shards per hardware thread, so that two writers rarely pick the same shard
+    explicit ConcurrentHashMap(std::size_t shardCount = 4 * std::max<std::size_t>(std::thread::hardware_concurrency(), 1))
+        : m_shards{ std::make_unique<Shard[]>(std::bit_ceil(shardCount)) }, m_shardMask{ std::bit_ceil(shardCount) - 1 }
+    {
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    // Inserts the entry, or replaces the value if the key is present. Returns true if it was inserted.
+    bool insert_or_assign(const Key& key, const Value& value)
+    {
+        const std::uint64_t h{ hashOf(key) };
+        Shard& shard{ shardOf(h) };
+        std::scoped_lock lock{ shard.mutex };
+
+        Table* table{ shard.table.load(std::memory_order_relaxed) };
+        if (table)
+        {
+            if (const std::size_t slot{ findSlot(*table, h, key) }; slot != npos)
+            {
+                WriteSection section{ shard };
+                store(table->valueWords(slot), value);
+                return false;
+            }
+        }
+
+        const std::size_t size{ shard.size.load(std::memory_order_relaxed) };
+        WriteSection section{ shard };
+        if (!table || (size + 1) * 4 > table->capacity * 3) // at most 3/4 full
+            table = grow(shard);
+
+        std::size_t slot{ homeOf(*table, h) };
+        while (table->isFull(slot))
+            slot = (slot + 1) & (table->capacity - 1);
+        store(table->keyWords(slot), key);
+        store(table->valueWords(slot), value);
+        table->full[slot].store(1, std::memory_order_relaxed);
+        shard.size.store(size + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // A copy of the value (a reference could change under the caller's feet), or std::nullopt
+    std::optional<Value> find(const Key& key) const
+    {
+        const std::uint64_t h{ hashOf(key) };
+        const Shard& shard{ shardOf(h) };
+        for (;;)
+        {
+            const std::uint64_t version{ shard.version.load(std::memory_order_acquire) };
+            if (version & 1)
+            {
+                std::this_thread::yield(); // a writer is at work: let it finish
+                continue;
+            }
+
+            std::optional<Value> result{};
+            if (const Table* table{ shard.table.load(std::memory_order_acquire) })
+            {
+                if (const std::size_t slot{ findSlot(*table, h, key) }; slot != npos)
+                    result = load<Value>(table->valueWords(slot));
+            }
+
+            // The loads above must happen before the version is read again
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.version.load(std::memory_order_relaxed) == version)
+                return result;
+        }
+    }
+
+    bool contains(const Key& key) const { return find(key).has_value(); }
+
+    // Returns whether the key was present
+    bool erase(const Key& key)
+    {
+        const std::uint64_t h{ hashOf(key) };
+        Shard& shard{ shardOf(h) };
+        std::scoped_lock lock{ shard.mutex };
+
+        Table* table{ shard.table.load(std::memory_order_relaxed) };
+        const std::size_t slot{ table ? findSlot(*table, h, key) : npos };
+        if (slot == npos)
+            return false;
+
+        WriteSection section{ shard };
+        // Backward shift deletion (lessons/160-flat-hash-map): move the following entries of the run
+        // into the hole when their home allows it, so that no tombstone is needed
+        const std::size_t mask{ table->capacity - 1 };
+        std::size_t hole{ slot };
+        for (std::size_t j{ (slot + 1) & mask }; table->isFull(j); j = (j + 1) & mask)
+        {
+            const std::size_t home{ homeOf(*table, hashOf(load<Key>(table->keyWords(j)))) };
+            if (((j - home) & mask) >= ((j - hole) & mask))
+            {
+                copyWords(table->keyWords(hole), table->keyWords(j), kSlotWords);
+                hole = j;
+            }
+        }
+        table->full[hole].store(0, std::memory_order_relaxed);
+        shard.size.store(shard.size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // The number of entries; only exact while no thread is writing
+    std::size_t size() const
+    {
+        std::size_t total{ 0 };
+        for (std::size_t i{ 0 }; i <= m_shardMask; ++i)
+            total += m_shards[i].size.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    // Calls f(key, value) for every entry. Each shard is copied in one consistent snapshot (without
+    // blocking its writers), then visited from the copy: f can take its time, and can even modify the map.
+    // Different shards are snapshots of different moments.
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        std::vector<std::pair<Key, Value>> entries{};
+        for (std::size_t i{ 0 }; i <= m_shardMask; ++i)
+        {
+            snapshot(m_shards[i], entries);
+            for (const auto& [key, value] : entries)
+                f(key, value);
+        }
+    }
+
+private:
+    static constexpr std::size_t npos{ static_cast<std::size_t>(-1) };
+
+    // Makes the version odd for its lifetime: readers of the shard retry until it is destroyed
+    class WriteSection
+    {
+    private:
+        Shard& m_shard;
+
+    public:
+        explicit WriteSection(Shard& shard)
+            : m_shard{ shard }
+        {
+            m_shard.version.store(m_shard.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release); // the odd version is visible before any data changes
+        }
+
+        ~WriteSection()
+        {
+            m_shard.version.store(m_shard.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        WriteSection(const WriteSection&) = delete;
+        WriteSection& operator=(const WriteSection&) = delete;
+    };
+
+    std::uint64_t hashOf(const Key& key) const
+    {
+        // splitmix64 finalizer: std::hash of an integer is the identity, and both the high bits (the shard)
+        // and the low bits (the slot) must vary
+        std::uint64_t x{ static_cast<std::uint64_t>(m_hash(key)) };
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    Shard& shardOf(std::uint64_t h) const { return m_shards[static_cast<std::size_t>(h >> 40) & m_shardMask]; }
+    static std::size_t homeOf(const Table& table, std::uint64_t h) { return static_cast<std::size_t>(h) & (table.capacity - 1); }
+
+    template <typename T>
+    static void store(Word* words, const T& value)
+    {
+        std::array<std::uint64_t, kWords<T>> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+        for (std::size_t w{ 0 }; w < kWords<T>; ++w)
+            words[w].store(buffer[w], std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static T load(const Word* words)
+    {
+        std::array<std::uint64_t, kWords<T>> buffer{};
+        for (std::size_t w{ 0 }; w < kWords<T>; ++w)
+            buffer[w] = words[w].load(std::memory_order_relaxed);
+        T value{};
+        std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+        return value;
+    }
+
+    static void copyWords(Word* to, const Word* from, std::size_t count)
+    {
+        for (std::size_t w{ 0 }; w < count; ++w)
+            to[w].store(from[w].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    // Linear probing. During an optimistic read the table may be changing: the loop is bounded by the
+    // capacity, and a wrong answer is discarded by the version check.
+    std::size_t findSlot(const Table& table, std::uint64_t h, const Key& key) const
+    {
+        const std::size_t mask{ table.capacity - 1 };
+        std::size_t slot{ homeOf(table, h) };
+        for (std::size_t probes{ 0 }; probes < table.capacity && table.isFull(slot); ++probes, slot = (slot + 1) & mask)
+        {
+            if (load<Key>(table.keyWords(slot)) == key)
+                return slot;
+        }
+        return npos;
+    }
+
+    // Called by a writer, in its write section
+    Table* grow(Shard& shard)
+    {
+        const Table* old{ shard.table.load(std::memory_order_relaxed) };
+        auto table{ std::make_unique<Table>(old ? old->capacity * 2 : kMinCapacity) };
+        if (old)
+        {
+            for (std::size_t i{ 0 }; i < old->capacity; ++i)
+            {
+                if (!old->isFull(i))
+                    continue;
+                std::size_t slot{ homeOf(*table, hashOf(load<Key>(old->keyWords(i)))) };
+                while (table->isFull(slot))
+                    slot = (slot + 1) & (table->capacity - 1);
+                copyWords(table->keyWords(slot), old->keyWords(i), kSlotWords);
+                table->full[slot].store(1, std::memory_order_relaxed);
+            }
+        }
+        shard.table.store(table.get(), std::memory_order_release);
+        shard.tables.push_back(std::move(table)); // the old table stays allocated: readers may still use it
+        return shard.tables.back().get();
+    }
+
+    // Copies the entries of the shard into entries, retrying until no writer interfered
+    static void snapshot(const Shard& shard, std::vector<std::pair<Key, Value>>& entries)
+    {
+        for (;;)
+        {
+            entries.clear();
+            const std::uint64_t version{ shard.version.load(std::memory_order_acquire) };
+            if (version & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if (const Table* table{ shard.table.load(std::memory_order_acquire) })
+            {
+                for (std::size_t i{ 0 }; i < table->capacity; ++i)
+                    if (table->isFull(i))
+                        entries.emplace_back(load<Key>(table->keyWords(i)), load<Value>(table->valueWords(i)));
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.version.load(std::memory_order_relaxed) == version)
+                return;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,256 @@
+/* A concurrent hash map
+
+- None of the containers so far (std::unordered_map, lessons/160-flat-hash-map...) can be modified by one
+  thread while another thread uses it: that is a data race, undefined behavior.
+- The simple fix: one std::mutex around every operation. Correct, but the threads take turns: with
+  many cores, they spend their time waiting for the lock, and the lock's cache line ping-pongs
+  between the cores (lessons/158-sharded-accumulator), even when they only read.
+- A std::shared_mutex lets readers share the lock, but every reader still writes the lock's counter.
+- ConcurrentHashMap.h: shards with their own mutex for writers, and readers that take no lock at all
+  (optimistic reads, validated by a version number).
+*/
+
+#include "ConcurrentHashMap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+template <typename F>
+void runThreads(int threadCount, F&& f)
+{
+    std::vector<std::thread> threads{};
+    for (int t{ 0 }; t < threadCount; ++t)
+        threads.emplace_back(f, t);
+    for (auto& thread : threads)
+        thread.join();
+}
+
+// Written as a whole: a reader must never see x from one write and y from another
+struct Point
+{
+    long long x{};
+    long long y{};
+};
+
+bool examples()
+{
+    ConcurrentHashMap<int, int> squares{};
+    squares.insert_or_assign(3, 9);
+    squares.insert_or_assign(4, 15);
+    const bool inserted{ squares.insert_or_assign(4, 16) }; // replaced: false
+    std::cout << "4 -> " << squares.find(4).value_or(-1) << ", 5 present: " << squares.contains(5) << '\n';
+
+    // 8 threads insert 10,000 keys each, then erase the odd ones
+    ConcurrentHashMap<int, int> map{};
+    runThreads(8, [&](int t) {
+        for (int i{ 0 }; i < 10000; ++i)
+            map.insert_or_assign(t * 10000 + i, i);
+        for (int i{ 1 }; i < 10000; i += 2)
+            map.erase(t * 10000 + i);
+    });
+    long long sum{ 0 };
+    map.forEach([&](int key, int value) { sum += key % 10000 == value ? value : -1000000; });
+    std::cout << "size " << map.size() << ", sum of values " << sum << '\n';
+
+    // Readers check that they never see a half-written Point while a writer keeps replacing them
+    ConcurrentHashMap<int, Point> points{};
+    for (int k{ 0 }; k < 64; ++k)
+        points.insert_or_assign(k, { 0, 0 });
+    std::atomic<bool> done{ false };
+    std::atomic<long long> torn{ 0 };
+    std::atomic<long long> reads{ 0 };
+    runThreads(4, [&](int t) {
+        if (t == 0)
+        {
+            for (long long i{ 1 }; i <= 200000; ++i)
+                points.insert_or_assign(static_cast<int>(i % 64), { i, -i });
+            done = true;
+            return;
+        }
+        long long localReads{ 0 };
+        long long localTorn{ 0 };
+        for (int k{ 0 }; !done || localReads == 0; k = (k + 1) % 64, ++localReads)
+        {
+            const Point p{ points.find(k).value() };
+            localTorn += (p.x != -p.y);
+        }
+        reads += localReads;
+        torn += localTorn;
+    });
+    std::cout << reads << " reads during the writes, " << torn << " inconsistent\n";
+
+    return !inserted && squares.find(4) == 16 && !squares.contains(5) && map.size() == 40000 && sum == 8 * 24995000LL && torn == 0;
+}
+
+
+/* Benchmark
+
+- Millions of operations per second, 1 to 64 threads sharing one map of about 500,000 int -> int
+  entries (keys drawn from [0, 2^20)).
+- Mixes: 95% find / 5% writes, and 50% find / 50% writes; writes are half insert_or_assign,
+  half erase, so the size stays stable.
+- Compared: std::unordered_map with one std::mutex, with one std::shared_mutex (readers share it),
+  and ConcurrentHashMap.
+- With a single core, nothing runs in parallel: the columns show the cost of the locks and the
+  contention (a thread preempted while holding the one mutex blocks all the others).
+*/
+
+constexpr std::uint32_t kKeySpace{ 1u << 20 };
+
+class MutexMap
+{
+private:
+    std::unordered_map<int, int> m_map{};
+    mutable std::mutex m_mutex{};
+
+public:
+    void insert_or_assign(int key, int value)
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_map.insert_or_assign(key, value);
+    }
+
+    bool erase(int key)
+    {
+        std::scoped_lock lock{ m_mutex };
+        return m_map.erase(key) > 0;
+    }
+
+    std::optional<int> find(int key) const
+    {
+        std::scoped_lock lock{ m_mutex };
+        const auto it{ m_map.find(key) };
+        return (it == m_map.end()) ? std::nullopt : std::optional<int>{ it->second };
+    }
+};
+
+class SharedMutexMap
+{
+private:
+    std::unordered_map<int, int> m_map{};
+    mutable std::shared_mutex m_mutex{};
+
+public:
+    void insert_or_assign(int key, int value)
+    {
+        std::unique_lock lock{ m_mutex };
+        m_map.insert_or_assign(key, value);
+    }
+
+    bool erase(int key)
+    {
+        std::unique_lock lock{ m_mutex };
+        return m_map.erase(key) > 0;
+    }
+
+    std::optional<int> find(int key) const
+    {
+        std::shared_lock lock{ m_mutex };
+        const auto it{ m_map.find(key) };
+        return (it == m_map.end()) ? std::nullopt : std::optional<int>{ it->second };
+    }
+};
+
+template <typename Map>
+double operationsPerSecond(int threadCount, std::size_t count, std::uint32_t writePercent)
+{
+    Map map{};
+    for (std::uint32_t key{ 0 }; key < kKeySpace; key += 2)
+        map.insert_or_assign(static_cast<int>(key), 0);
+
+    const std::size_t perThread{ count / static_cast<std::size_t>(threadCount) };
+    std::atomic<std::size_t> hits{ 0 };
+    const auto start{ std::chrono::steady_clock::now() };
+    runThreads(threadCount, [&](int t) {
+        std::uint64_t state{ std::uint64_t{ 0x9E3779B97F4A7C15 } * static_cast<std::uint64_t>(t + 1) };
+        std::size_t localHits{ 0 };
+        for (std::size_t i{ 0 }; i < perThread; ++i)
+        {
+            // xorshift64: cheaper than std::mt19937 per operation
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            const auto key{ static_cast<int>(state & (kKeySpace - 1)) };
+            if ((state >> 32) % 100 < writePercent)
+            {
+                if (state & (std::uint64_t{ 1 } << 63))
+                    map.insert_or_assign(key, static_cast<int>(i));
+                else
+                    map.erase(key);
+            }
+            else
+                localHits += map.find(key).has_value();
+        }
+        hits += localHits;
+    });
+    const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+    return (hits > 0) ? static_cast<double>(perThread * static_cast<std::size_t>(threadCount)) / seconds / 1e6 : 0.0;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << ", millions of operations per second\n"
+              << std::setw(8) << "threads" << std::setw(12) << "mutex" << std::setw(14) << "shared_mutex" << std::setw(13)
+              << "concurrent" << std::setw(12) << "mutex" << std::setw(14) << "shared_mutex" << std::setw(13) << "concurrent\n"
+              << std::setw(8) << "" << std::setw(39) << "95% reads" << std::setw(39) << "50% reads" << '\n';
+
+    bool ok{ true };
+    for (int threads : { 1, 2, 4, 8, 16, 32, 64 })
+    {
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << threads;
+        for (std::uint32_t writePercent : { 5u, 50u })
+        {
+            const double mutexRate{ operationsPerSecond<MutexMap>(threads, count, writePercent) };
+            const double sharedRate{ operationsPerSecond<SharedMutexMap>(threads, count, writePercent) };
+            const double concurrentRate{ operationsPerSecond<ConcurrentHashMap<int, int>>(threads, count, writePercent) };
+            std::cout << std::setw(12) << mutexRate << std::setw(14) << sharedRate << std::setw(13) << concurrentRate;
+            ok = ok && mutexRate > 0 && sharedRate > 0 && concurrentRate > 0;
+        }
+        std::cout << '\n';
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 4000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Readers never block writers, and writers only make readers of their own shard retry. A reader can
+  in theory retry forever if writers keep its shard busy: more shards make that less likely.
+- The version check only protects against mixed reads; the reads themselves must not crash. Hence
+  the atomic words (a plain read racing with a write is undefined behavior, even if discarded), the
+  probe loop bounded by the capacity, and old tables kept alive.
+- Real implementations free the old tables once no reader can hold them, with epoch-based
+  reclamation or hazard pointers. Java's ConcurrentHashMap and folly's ConcurrentHashMap use
+  per-bucket locks and lock-free reads; Intel TBB's concurrent_hash_map uses reader-writer locks.
+- find() returns a copy: a pointer or a reference into the map could be overwritten (or moved by a
+  grow) while the caller uses it.
+*/
+
+
+/* References
+
+- https://en.cppreference.com/w/cpp/thread/shared_mutex
+- https://en.wikipedia.org/wiki/Seqlock
+- https://www.hpl.hp.com/techreports/2012/HPL-2012-68.pdf (Hans Boehm: Can seqlocks get along with programming language memory models?)
+- https://docs.oracle.com/javase/8/docs/api/java/util/concurrent/ConcurrentHashMap.html
+*/
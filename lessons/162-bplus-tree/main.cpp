@@ -0,0 +1,251 @@
+/* An ordered index: B+-tree
+
+- lessons/095-arrays-of-class-types: arrays of Student { int id; std::string_view name; } and
+  House { int number; int stories; int roomsPerStory; }. Finding a student by id means a linear search,
+  or std::sort once and then a binary search (std::lower_bound).
+- A sorted std::vector is fast to search but slow to modify (an insert moves half the elements).
+  std::map (a red-black tree) inserts in O(log n), but every node is a separate allocation: lookups
+  and in-order scans jump around memory.
+- BPlusTree.h: the tree databases and file systems use. Wide nodes (32 keys) searched with SIMD,
+  values only in the leaves, leaves chained for range scans, and bulk loading from sorted input.
+*/
+
+#include "BPlusTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// From lessons/095-arrays-of-class-types
+struct Student
+{
+    int id{};
+    std::string_view name{};
+};
+
+struct House
+{
+    int number{};
+    int stories{};
+    int roomsPerStory{};
+};
+
+bool examples()
+{
+    constexpr Student students[]{ { 7, "Alex" }, { 3, "Joe" }, { 12, "Bob" }, { 5, "Ann" }, { 9, "Eve" } };
+
+    // Indexed by id, inserted in any order
+    BPlusTree<int, std::string_view> byId{};
+    for (const Student& student : students)
+        byId.insert_or_assign(student.id, student.name);
+
+    std::cout << "student 12: " << *byId.find(12) << ", student 4 present: " << byId.contains(4) << '\n';
+    std::cout << "ids in [4, 10):";
+    for (auto [id, name] : byId.range(4, 10))
+        std::cout << ' ' << id << ' ' << name;
+    std::cout << '\n';
+
+    // Bulk loaded from houses sorted by number: 100 houses, numbers 10, 20, ..., 1000
+    std::vector<std::pair<int, House>> houses{};
+    for (int number{ 10 }; number <= 1000; number += 10)
+        houses.push_back({ number, House{ number, 1 + number % 3, 4 + number % 5 } });
+    BPlusTree<int, House> byNumber{};
+    byNumber.bulkLoad(houses.begin(), houses.end());
+
+    int rooms{ 0 };
+    byNumber.forEachInRange(100, 200, [&](int, const House& house) { rooms += house.stories * house.roomsPerStory; });
+    std::cout << byNumber.size() << " houses, " << byNumber.height() << " levels; rooms in houses [100, 200): " << rooms << '\n';
+
+    bool rejected{ false };
+    try
+    {
+        std::vector<std::pair<int, House>> unsorted{ { 2, {} }, { 1, {} } };
+        byNumber.bulkLoad(unsorted.begin(), unsorted.end());
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cout << e.what() << '\n';
+        rejected = true;
+    }
+
+    byId.erase(7);
+    return *byId.find(12) == "Bob" && !byId.contains(4) && !byId.contains(7) && byId.size() == 4 && rooms == 80 && rejected
+        && byNumber.empty();
+}
+
+
+/* Benchmark
+
+- count random distinct int keys with int values:
+  + build: std::map inserts (random order), BPlusTree inserts (random order), BPlusTree::bulkLoad and
+    a std::vector sorted with std::sort (both from the keys, sorted),
+  + 1,000,000 lookups of random keys present in the map,
+  + 100,000 range scans of 100 consecutive entries, from random keys (sum of the values).
+- Nanoseconds per insert, per lookup and per scan.
+*/
+
+template <typename F>
+double nanoseconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 162 };
+
+    // Distinct keys: a random sample of the ints in [0, 4 * count), shuffled
+    std::vector<int> keys(4 * count);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(count);
+
+    std::vector<std::pair<int, int>> sortedEntries(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+        sortedEntries[i] = { keys[i], keys[i] / 2 };
+    std::sort(sortedEntries.begin(), sortedEntries.end());
+
+    constexpr std::size_t kLookups{ 1000000 };
+    constexpr std::size_t kScans{ 100000 };
+    constexpr int kScanLength{ 100 };
+    std::vector<int> lookups(kLookups);
+    for (auto& key : lookups)
+        key = keys[rng() % count];
+
+    const double n{ static_cast<double>(count) };
+    std::cout << count << " entries, ns per operation\n"
+              << std::setw(16) << "" << std::setw(12) << "build" << std::setw(12) << "lookup" << std::setw(16) << "scan of 100\n";
+
+    // std::map
+    std::map<int, int> map{};
+    const double mapBuild{ nanoseconds([&] {
+        for (int key : keys)
+            map.emplace(key, key / 2);
+    }) };
+    long long mapSum{ 0 };
+    const double mapLookup{ nanoseconds([&] {
+        for (int key : lookups)
+            mapSum += map.find(key)->second;
+    }) };
+    long long mapScanSum{ 0 };
+    const double mapScan{ nanoseconds([&] {
+        for (std::size_t s{ 0 }; s < kScans; ++s)
+        {
+            auto it{ map.lower_bound(lookups[s]) };
+            for (int i{ 0 }; i < kScanLength && it != map.end(); ++i, ++it)
+                mapScanSum += it->second;
+        }
+    }) };
+    std::cout << std::fixed << std::setprecision(1) << std::setw(16) << "std::map" << std::setw(12) << mapBuild / n << std::setw(12)
+              << mapLookup / kLookups << std::setw(15) << mapScan / kScans << '\n';
+
+    // Sorted std::vector + std::lower_bound
+    std::vector<std::pair<int, int>> vector{};
+    const double vectorBuild{ nanoseconds([&] {
+        vector.reserve(count);
+        for (int key : keys)
+            vector.emplace_back(key, key / 2);
+        std::sort(vector.begin(), vector.end());
+    }) };
+    auto vectorFind{ [&](int key) {
+        return std::lower_bound(vector.begin(), vector.end(), key, [](const auto& entry, int k) { return entry.first < k; });
+    } };
+    long long vectorSum{ 0 };
+    const double vectorLookup{ nanoseconds([&] {
+        for (int key : lookups)
+            vectorSum += vectorFind(key)->second;
+    }) };
+    long long vectorScanSum{ 0 };
+    const double vectorScan{ nanoseconds([&] {
+        for (std::size_t s{ 0 }; s < kScans; ++s)
+        {
+            auto it{ vectorFind(lookups[s]) };
+            for (int i{ 0 }; i < kScanLength && it != vector.end(); ++i, ++it)
+                vectorScanSum += it->second;
+        }
+    }) };
+    std::cout << std::setw(16) << "sorted vector" << std::setw(12) << vectorBuild / n << std::setw(12) << vectorLookup / kLookups
+              << std::setw(15) << vectorScan / kScans << '\n';
+
+    // BPlusTree, inserted in random order, then bulk loaded
+    BPlusTree<int, int> inserted{};
+    const double insertBuild{ nanoseconds([&] {
+        for (int key : keys)
+            inserted.insert_or_assign(key, key / 2);
+    }) };
+    BPlusTree<int, int> loaded{};
+    const double loadBuild{ nanoseconds([&] { loaded.bulkLoad(sortedEntries.begin(), sortedEntries.end()); }) };
+
+    bool ok{ mapSum == vectorSum && mapScanSum == vectorScanSum && inserted.size() == count && loaded.size() == count };
+    for (const auto* tree : { &inserted, &loaded })
+    {
+        long long treeSum{ 0 };
+        const double treeLookup{ nanoseconds([&] {
+            for (int key : lookups)
+                treeSum += *tree->find(key);
+        }) };
+        long long treeScanSum{ 0 };
+        const double treeScan{ nanoseconds([&] {
+            for (std::size_t s{ 0 }; s < kScans; ++s)
+            {
+                int i{ 0 };
+                for (auto it{ tree->lowerBound(lookups[s]) }; i < kScanLength && it != tree->end(); ++i, ++it)
+                    treeScanSum += it.value();
+            }
+        }) };
+        std::cout << std::setw(16) << (tree == &inserted ? "B+ inserted" : "B+ bulk loaded") << std::setw(12)
+                  << (tree == &inserted ? insertBuild : loadBuild) / n << std::setw(12) << treeLookup / kLookups << std::setw(15)
+                  << treeScan / kScans << "   (height " << tree->height() << ")\n";
+        ok = ok && treeSum == mapSum && treeScanSum == mapScanSum;
+    }
+
+    // Every tree iterates in order, like the map
+    auto expected{ map.begin() };
+    for (auto [key, value] : loaded)
+    {
+        ok = ok && expected != map.end() && key == expected->first && value == expected->second;
+        ++expected;
+    }
+    return ok && expected == map.end();
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 5000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Node size: bigger nodes mean fewer levels but more keys compared per node. A few cache lines per
+  node is the sweet spot in memory; on disk, nodes are a page (4 KiB or more), as in databases.
+- Random inserts leave nodes between half and completely full (~70% on average); bulk loading fills
+  them, so the tree is smaller and scans read fewer leaves.
+- The sorted vector wins when the data does not change: no pointers at all. A binary search still
+  has log2(n) dependent, unpredictable steps; a B+-tree node resolves 5 bits per cache miss.
+- Pointers to values stay valid as long as no insert splits their leaf (and no erase shifts them).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/stdarray-of-class-types-and-brace-elision/
+- https://en.wikipedia.org/wiki/B%2B_tree
+- https://en.algorithmica.org/hpc/data-structures/s-tree/ (SIMD search trees)
+*/
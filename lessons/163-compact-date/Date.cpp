@@ -0,0 +1,155 @@
+#include "Date.h"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <emmintrin.h> // part of every x86-64 CPU: no runtime dispatch needed
+#endif
+
+void Date::print() const
+{
+    const YearMonthDay ymd{ civil() };
+    std::cout << "Date(" << ymd.year << ", " << ymd.month << ", " << ymd.day << ")\n";
+}
+
+void Date::writeIso(char* out) const
+{
+    const YearMonthDay ymd{ civil() };
+    assert(ymd.year >= 0 && ymd.year <= 9999);
+    const auto digit{ [](int value) { return static_cast<char>('0' + value); } };
+    out[0] = digit(ymd.year / 1000);
+    out[1] = digit(ymd.year / 100 % 10);
+    out[2] = digit(ymd.year / 10 % 10);
+    out[3] = digit(ymd.year % 10);
+    out[4] = '-';
+    out[5] = digit(ymd.month / 10);
+    out[6] = digit(ymd.month % 10);
+    out[7] = '-';
+    out[8] = digit(ymd.day / 10);
+    out[9] = digit(ymd.day % 10);
+}
+
+std::string Date::toString() const
+{
+    const YearMonthDay ymd{ civil() };
+    if (ymd.year >= 0 && ymd.year <= 9999)
+    {
+        std::string text(10, ' ');
+        writeIso(text.data());
+        return text;
+    }
+
+    const auto twoDigits{ [](int value) { return std::string{ static_cast<char>('0' + value / 10), static_cast<char>('0' + value % 10) }; } };
+    return std::to_string(ymd.year) + '-' + twoDigits(ymd.month) + '-' + twoDigits(ymd.day);
+}
+
+std::optional<Date> Date::parseIso(std::string_view text)
+{
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-')
+        return std::nullopt;
+
+    int values[3]{};
+    constexpr std::size_t kStart[3]{ 0, 5, 8 };
+    constexpr std::size_t kLength[3]{ 4, 2, 2 };
+    for (std::size_t field{ 0 }; field < 3; ++field)
+    {
+        for (std::size_t i{ kStart[field] }; i < kStart[field] + kLength[field]; ++i)
+        {
+            const auto digit{ static_cast<unsigned>(text[i] - '0') };
+            if (digit > 9)
+                return std::nullopt;
+            values[field] = values[field] * 10 + static_cast<int>(digit);
+        }
+    }
+    return fromCivil(values[0], values[1], values[2]);
+}
+
+const char* weekdayName(Date::Weekday weekday)
+{
+    switch (weekday)
+    {
+    case Date::Weekday::monday:    return "Monday";
+    case Date::Weekday::tuesday:   return "Tuesday";
+    case Date::Weekday::wednesday: return "Wednesday";
+    case Date::Weekday::thursday:  return "Thursday";
+    case Date::Weekday::friday:    return "Friday";
+    case Date::Weekday::saturday:  return "Saturday";
+    case Date::Weekday::sunday:    return "Sunday";
+    default:                       return "???";
+    }
+}
+
+namespace
+{
+    constexpr std::size_t kDateLength{ 10 };
+    constexpr std::size_t kStride{ kDateLength + 1 }; // the date and its separator
+
+    bool isSeparator(char ch)
+    {
+        return ch == '\n' || ch == ',' || ch == ';' || ch == ' ' || ch == '\t';
+    }
+
+#if defined(__SSE2__)
+    // The first 10 of the 16 bytes at p are "YYYY-MM-DD". Returns false if they are not.
+    bool parseIso16(const char* p, Date& date)
+    {
+        const __m128i text{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) };
+        const __m128i digits{ _mm_sub_epi8(text, _mm_set1_epi8('0')) };
+
+        // Digits: 0 <= byte - '0' <= 9 (unsigned: min(x, 9) == x) at positions 0-3, 5-6 and 8-9; '-' at 4 and 7
+        const auto isDigit{ static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits))) };
+        const auto isDash{ static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(text, _mm_set1_epi8('-')))) };
+        constexpr unsigned kDigitPositions{ 0b11'0110'1111 };
+        constexpr unsigned kDashPositions{ 0b00'1001'0000 };
+        if ((isDigit & kDigitPositions) != kDigitPositions || (isDash & kDashPositions) != kDashPositions)
+            return false;
+
+        // Widen the bytes to 16 bits, then multiply by the place values and add pairs (pmaddwd):
+        // [Y0 Y1 Y2 Y3 - M0 M1 -] . [1000 100 10 1 0 10 1 0] -> [Y0*1000 + Y1*100, Y2*10 + Y3, M0*10, M1]
+        // [D0 D1 ...]             . [10 1 0...]              -> [D0*10 + D1, 0, 0, 0]
+        const __m128i zero{ _mm_setzero_si128() };
+        const __m128i low{ _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), _mm_setr_epi16(1000, 100, 10, 1, 0, 10, 1, 0)) };
+        const __m128i high{ _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), _mm_setr_epi16(10, 1, 0, 0, 0, 0, 0, 0)) };
+        // Add the neighbouring 32-bit lanes: lane 0 = year, lane 2 = month
+        const __m128i sums{ _mm_add_epi32(low, _mm_srli_si128(low, 4)) };
+        const int year{ _mm_cvtsi128_si32(sums) };
+        const int month{ _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)) };
+        const int day{ _mm_cvtsi128_si32(high) };
+
+        if (month < 1 || month > 12 || day < 1 || day > Date::daysInMonth(year, month))
+            return false;
+        date = Date::fromDaysSinceEpoch(Date::daysFromCivil(year, month, day));
+        return true;
+    }
+#endif
+}
+
+std::size_t parseIsoDates(std::string_view text, std::vector<Date>& dates)
+{
+    // The last separator is optional; a partial record at the end counts as one more (invalid) date
+    const std::size_t total{ (text.size() + kDateLength) / kStride };
+    const std::size_t start{ dates.size() };
+    dates.reserve(start + total);
+
+    std::size_t i{ 0 };
+#if defined(__SSE2__)
+    // Every date followed by at least 6 more bytes can be read with one 16-byte load
+    for (; i < total && i * kStride + 16 <= text.size(); ++i)
+    {
+        Date date{};
+        if (!isSeparator(text[i * kStride + kDateLength]) || !parseIso16(text.data() + i * kStride, date))
+            return i;
+        dates.push_back(date);
+    }
+#endif
+    for (; i < total; ++i)
+    {
+        const auto date{ Date::parseIso(text.substr(i * kStride, kDateLength)) };
+        const std::size_t end{ i * kStride + kDateLength };
+        if (!date || (end < text.size() && !isSeparator(text[end])))
+            return i;
+        dates.push_back(*date);
+    }
+    return dates.size() - start;
+}
@@ -0,0 +1,198 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Date from lessons/079-classes-and-header-files, stored as a single 32-bit count of days since
+// 1970-01-01 (the Unix epoch) instead of three ints.
+// * 4 bytes instead of 12, and comparing, sorting, hashing, adding or subtracting days are plain
+//   integer operations.
+// * Year, month and day are computed when asked for, with the algorithms of Neri and Schneider
+//   ("Euclidean affine functions and their application to calendar algorithms", 2022): a few
+//   multiplications, shifts and one comparison turned into arithmetic, no branch and no loop.
+// * Proleptic Gregorian calendar (the Gregorian rules extended before 1582), years kMinYear to kMaxYear.
+class Date
+{
+public:
+    static constexpr int kMinYear{ -32767 };
+    static constexpr int kMaxYear{ 32767 };
+
+    enum class Weekday
+    {
+        monday,
+        tuesday,
+        wednesday,
+        thursday,
+        friday,
+        saturday,
+        sunday,
+    };
+
+    struct YearMonthDay
+    {
+        int year{};
+        int month{}; // 1 to 12
+        int day{};   // 1 to 31
+
+        friend bool operator==(const YearMonthDay&, const YearMonthDay&) = default;
+    };
+
+private:
+    std::int32_t m_days{ 0 };
+
+    // The calendar repeats every 400 years (146097 days). The algorithms work on unsigned numbers:
+    // shifting by 82 cycles makes every supported date positive.
+    static constexpr std::uint32_t kShiftCycles{ 82 };
+    static constexpr std::uint32_t kShiftDays{ 719468 + 146097 * kShiftCycles }; // 719468: 0000-03-01 to 1970-01-01
+    static constexpr std::uint32_t kShiftYears{ 400 * kShiftCycles };
+
+public:
+    constexpr Date() = default; // 1970-01-01
+
+    // The date must be valid (see isValid)
+    constexpr Date(int year, int month, int day)
+        : m_days{ daysFromCivil(year, month, day) }
+    {
+        assert(isValid(year, month, day));
+    }
+
+    static constexpr Date fromDaysSinceEpoch(std::int32_t days)
+    {
+        Date date{};
+        date.m_days = days;
+        return date;
+    }
+
+    static constexpr bool isLeapYear(int year)
+    {
+        // Divisible by 4, and not by 100 unless by 400. A multiple of 100 is a multiple of 400 exactly
+        // when it is a multiple of 16, which is cheaper to test.
+        return (year % 100 != 0) ? (year % 4 == 0) : (year % 16 == 0);
+    }
+
+    static constexpr int daysInMonth(int year, int month)
+    {
+        // 30 or 31 alternate, with a shift after July; February is 28 + leap
+        return (month == 2) ? 28 + isLeapYear(year) : 30 + ((month ^ (month >> 3)) & 1);
+    }
+
+    static constexpr bool isValid(int year, int month, int day)
+    {
+        return year >= kMinYear && year <= kMaxYear && month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month);
+    }
+
+    // std::nullopt if the date does not exist (2023-02-29)
+    static constexpr std::optional<Date> fromCivil(int year, int month, int day)
+    {
+        if (!isValid(year, month, day))
+            return std::nullopt;
+        return Date{ year, month, day };
+    }
+
+    static constexpr std::int32_t daysFromCivil(int year, int month, int day)
+    {
+        const std::uint32_t isJanOrFeb{ month <= 2 };                             // counted in the previous year:
+        const std::uint32_t y{ static_cast<std::uint32_t>(year) + kShiftYears - isJanOrFeb }; // years start in March, so that
+        const std::uint32_t m{ static_cast<std::uint32_t>(month) + 12 * isJanOrFeb };         // February 29 is the last day
+        const std::uint32_t d{ static_cast<std::uint32_t>(day) - 1 };
+        const std::uint32_t century{ y / 100 };
+        const std::uint32_t yearDays{ 1461 * y / 4 - century + century / 4 };
+        const std::uint32_t monthDays{ (979 * m - 2919) / 32 }; // days from March 1 to the 1st of month m
+        return static_cast<std::int32_t>(yearDays + monthDays + d - kShiftDays);
+    }
+
+    static constexpr YearMonthDay civilFromDays(std::int32_t days)
+    {
+        const std::uint32_t n{ static_cast<std::uint32_t>(days) + kShiftDays };
+        // Centuries, then years within the century, then day of the year (all starting in March)
+        const std::uint32_t n1{ 4 * n + 3 };
+        const std::uint32_t century{ n1 / 146097 };
+        const std::uint32_t n2{ n1 % 146097 | 3 };
+        const std::uint64_t p2{ std::uint64_t{ 2939745 } * n2 };
+        const auto yearOfCentury{ static_cast<std::uint32_t>(p2 >> 32) };
+        const auto dayOfYear{ static_cast<std::uint32_t>(p2 & 0xFFFFFFFF) / 2939745 / 4 };
+        const std::uint32_t n3{ 2141 * dayOfYear + 197913 };
+        const std::uint32_t m{ n3 >> 16 }; // 3 to 14
+        const std::uint32_t d{ (n3 & 0xFFFF) / 2141 };
+        const std::uint32_t isJanOrFeb{ dayOfYear >= 306 };
+        return { static_cast<int>(100 * century + yearOfCentury - kShiftYears + isJanOrFeb),
+                 static_cast<int>(m - 12 * isJanOrFeb), static_cast<int>(d + 1) };
+    }
+
+    constexpr std::int32_t daysSinceEpoch() const { return m_days; }
+    constexpr YearMonthDay civil() const { return civilFromDays(m_days); }
+
+    constexpr int getYear() const { return civil().year; }
+    constexpr int getMonth() const { return civil().month; }
+    constexpr int getDay() const { return civil().day; }
+
+    constexpr Weekday weekday() const
+    {
+        // 1970-01-01 was a Thursday (3); the offset, a multiple of 7 plus 3, keeps every supported date positive
+        return static_cast<Weekday>((static_cast<std::uint32_t>(m_days) + 7 * 2000000 + 3) % 7);
+    }
+
+    // Same day of the month, or the last day of the month if it is shorter: 2024-01-31 + 1 month = 2024-02-29
+    constexpr Date addMonths(int months) const
+    {
+        const YearMonthDay ymd{ civil() };
+        const int monthIndex{ ymd.year * 12 + (ymd.month - 1) + months };
+        const int year{ (monthIndex >= 0) ? monthIndex / 12 : (monthIndex - 11) / 12 };
+        const int month{ monthIndex - year * 12 + 1 };
+        const int lastDay{ daysInMonth(year, month) };
+        return Date{ year, month, (ymd.day < lastDay) ? ymd.day : lastDay };
+    }
+
+    constexpr Date addYears(int years) const { return addMonths(12 * years); }
+
+    constexpr Date& operator+=(int days)
+    {
+        m_days += days;
+        return *this;
+    }
+
+    constexpr Date& operator-=(int days)
+    {
+        m_days -= days;
+        return *this;
+    }
+
+    friend constexpr Date operator+(Date date, int days) { return date += days; }
+    friend constexpr Date operator-(Date date, int days) { return date -= days; }
+
+    // The number of days from b to a
+    friend constexpr int operator-(Date a, Date b) { return a.m_days - b.m_days; }
+
+    friend constexpr auto operator<=>(Date, Date) = default;
+
+    void print() const;
+
+    // "YYYY-MM-DD" (years 0 to 9999; others get a sign and/or more digits)
+    std::string toString() const;
+
+    // Writes the 10 characters of "YYYY-MM-DD" to out. The year must be in [0, 9999].
+    void writeIso(char* out) const;
+
+    // "YYYY-MM-DD", exactly: 10 characters, a valid date, years 0000 to 9999
+    static std::optional<Date> parseIso(std::string_view text);
+};
+
+static_assert(sizeof(Date) == 4);
+
+const char* weekdayName(Date::Weekday weekday);
+
+// Bulk parsing of a column of dates: text is made of "YYYY-MM-DD" dates, each followed by one separator
+// character ('\n', ',', ';', ' ' or '\t'), the last one optionally. The dates are appended to dates.
+// Returns the number of dates parsed: parsing stops at the first invalid one. A date followed by another
+// character, and leftover bytes at the end that are not a whole date, are invalid dates too.
+// Uses SSE2 (one date per 16-byte register) where available.
+std::size_t parseIsoDates(std::string_view text, std::vector<Date>& dates);
+
+#endif
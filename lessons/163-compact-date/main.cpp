@@ -0,0 +1,235 @@
+/* A compact date
+
+- lessons/079-classes-and-header-files: class Date { int m_year; int m_month; int m_day; } with print().
+  12 bytes per date, and no arithmetic: "30 days later" or "days between two dates" needs
+  the month lengths and the leap years, one month at a time.
+- The C library has std::tm and std::mktime, which normalize a date (day 45 of January = February 14)
+  and convert it to seconds. mktime handles time zones and daylight saving time: slow, and dependent
+  on the machine's local time zone.
+- Date.h: a 4-byte count of days since 1970-01-01. Arithmetic is integer arithmetic, conversions
+  to and from year/month/day are branch-free formulas, and a column of "YYYY-MM-DD" strings is
+  parsed with SSE2, one date per instruction sequence.
+*/
+
+#include "Date.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checks the formulas against counting one day at a time, for every day of the supported range
+bool checkAllDays()
+{
+    int year{ Date::kMinYear };
+    int month{ 1 };
+    int day{ 1 };
+    for (std::int32_t days{ Date::daysFromCivil(year, month, day) }; year <= Date::kMaxYear; ++days)
+    {
+        if (Date::daysFromCivil(year, month, day) != days || Date::civilFromDays(days) != Date::YearMonthDay{ year, month, day })
+            return false;
+
+        if (++day > Date::daysInMonth(year, month))
+        {
+            day = 1;
+            if (++month > 12)
+            {
+                month = 1;
+                ++year;
+            }
+        }
+    }
+    return true;
+}
+
+bool examples()
+{
+    const Date date{ 2024, 2, 29 };
+    date.print();
+    std::cout << date.toString() << " is a " << weekdayName(date.weekday()) << ", day " << date.daysSinceEpoch() << " since 1970-01-01\n";
+
+    const Date later{ date + 30 };
+    const Date nextMonth{ Date{ 2024, 1, 31 }.addMonths(1) };
+    std::cout << "+30 days: " << later.toString() << ", 2024-01-31 + 1 month: " << nextMonth.toString()
+              << ", 2024-02-29 + 1 year: " << date.addYears(1).toString() << '\n';
+    std::cout << "days from 2000-01-01 to 2024-02-29: " << date - Date{ 2000, 1, 1 } << '\n';
+
+    const auto parsed{ Date::parseIso("1969-07-20") };
+    const auto invalid{ Date::parseIso("2023-02-29") };
+    std::cout << "1969-07-20: day " << parsed->daysSinceEpoch() << ", 2023-02-29 valid: " << invalid.has_value() << '\n';
+
+    std::vector<Date> dates{};
+    const std::size_t parsedCount{ parseIsoDates("2024-05-17\n2000-02-29\n1999-12-31\n1582-10-15\n2024-13-01\n", dates) };
+    std::cout << "parsed " << parsedCount << " of 5 dates (the 5th has month 13)\n";
+    // A bad separator and a partial last date stop the parsing too
+    std::vector<Date> rejected{};
+    const std::size_t badSeparator{ parseIsoDates("2024-01-01X2024-01-02", rejected) };
+    const std::size_t partial{ parseIsoDates("2024-01-01,2024-01-02,2024-0", rejected) };
+    const std::size_t noLastSeparator{ parseIsoDates("2024-01-01 2024-01-02", rejected) };
+
+    constexpr Date kEpoch{};
+    static_assert(Date{ 1970, 1, 1 } == kEpoch && Date{ 2000, 3, 1 } - Date{ 2000, 2, 28 } == 2);
+
+    const bool allDays{ checkAllDays() };
+    std::cout << "every day from year " << Date::kMinYear << " to " << Date::kMaxYear << " round-trips: " << allDays << '\n';
+
+    return date.weekday() == Date::Weekday::thursday && later == Date{ 2024, 3, 30 } && nextMonth == Date{ 2024, 2, 29 }
+        && date.addYears(1) == Date{ 2025, 2, 28 } && date - Date{ 2000, 1, 1 } == 8825 && parsed->daysSinceEpoch() == -165
+        && !invalid && parsedCount == 4 && dates[3] == Date{ 1582, 10, 15 } && badSeparator == 0 && partial == 2
+        && noLastSeparator == 2 && allDays;
+}
+
+
+/* Benchmark
+
+- count random dates between 1900 and 2100, written one per line as "YYYY-MM-DD".
+- Parsing, nanoseconds per date:
+  + std::sscanf("%d-%d-%d") into a std::tm, then std::mktime,
+  + Date::parseIso on each line (scalar),
+  + parseIsoDates on the whole text (SSE2).
+- Arithmetic, nanoseconds per date: 30 days later, its weekday, and the number of days since 2000-01-01:
+  + std::tm: tm_mday += 30, std::mktime to normalize (and get tm_wday), std::difftime,
+  + Date: +, weekday(), -.
+*/
+
+template <typename F>
+double nanosecondsPer(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+// Noon, so that a time zone offset of up to 12 hours cannot change the day
+std::tm makeTm(int year, int month, int day)
+{
+    std::tm tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = 12;
+    tm.tm_isdst = -1;
+    return tm;
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 163 };
+    std::uniform_int_distribution<std::int32_t> days{ Date{ 1900, 1, 1 }.daysSinceEpoch(), Date{ 2100, 12, 31 }.daysSinceEpoch() };
+    std::vector<Date> expected(count);
+    std::string text(count * 11, '\n');
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        expected[i] = Date::fromDaysSinceEpoch(days(rng));
+        expected[i].writeIso(text.data() + i * 11);
+    }
+
+    // Parsing
+    std::vector<std::time_t> times(count);
+    const double mktimeParse{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+        {
+            // A copy of the line: sscanf may call strlen on its input, which would scan the rest of the text
+            char line[11]{};
+            std::copy_n(text.data() + i * 11, 10, line);
+            int year{};
+            int month{};
+            int day{};
+            std::sscanf(line, "%d-%d-%d", &year, &month, &day);
+            std::tm tm{ makeTm(year, month, day) };
+            times[i] = std::mktime(&tm);
+        }
+    }) };
+
+    std::vector<Date> scalar(count);
+    const double scalarParse{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+            scalar[i] = Date::parseIso(std::string_view{ text }.substr(i * 11, 10)).value_or(Date{});
+    }) };
+
+    std::vector<Date> bulk{};
+    std::size_t bulkCount{};
+    const double bulkParse{ nanosecondsPer(count, [&] { bulkCount = parseIsoDates(text, bulk); }) };
+
+    const Date reference{ 2000, 1, 1 };
+    std::tm referenceTm{ makeTm(2000, 1, 1) };
+    const std::time_t referenceTime{ std::mktime(&referenceTm) };
+    bool ok{ scalar == expected && bulk == expected && bulkCount == count };
+    for (std::size_t i{ 0 }; i < count && ok; ++i)
+        ok = static_cast<long long>(std::difftime(times[i], referenceTime) / 86400 + (times[i] < referenceTime ? -0.5 : 0.5))
+            == expected[i] - reference;
+
+    // Arithmetic
+    long long tmChecksum{ 0 };
+    const double mktimeArithmetic{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+        {
+            std::tm tm{};
+            const std::time_t time{ times[i] };
+            localtime_r(&time, &tm);
+            tm.tm_mday += 30;
+            const std::time_t later{ std::mktime(&tm) };
+            const double seconds{ std::difftime(later, referenceTime) };
+            tmChecksum += tm.tm_wday + static_cast<long long>(seconds / 86400 + (seconds < 0 ? -0.5 : 0.5));
+        }
+    }) };
+
+    long long dateChecksum{ 0 };
+    const double dateArithmetic{ nanosecondsPer(count, [&] {
+        for (const Date date : expected)
+        {
+            const Date later{ date + 30 };
+            dateChecksum += (static_cast<int>(later.weekday()) + 1) % 7 + (later - reference); // tm_wday: Sunday = 0
+        }
+    }) };
+
+    std::cout << count << " dates, ns per date\n"
+              << std::fixed << std::setprecision(1) << std::setw(14) << "" << std::setw(14) << "parse" << std::setw(14) << "arithmetic\n"
+              << std::setw(14) << "std::mktime" << std::setw(14) << mktimeParse << std::setw(13) << mktimeArithmetic << '\n'
+              << std::setw(14) << "Date scalar" << std::setw(14) << scalarParse << std::setw(13) << dateArithmetic << '\n'
+              << std::setw(14) << "Date SSE2" << std::setw(14) << bulkParse << std::setw(13) << "" << '\n';
+
+    return ok && tmChecksum == dateChecksum;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 2000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- std::chrono (C++20) has the same calendar: std::chrono::sys_days (days since 1970-01-01, an int32
+  in practice) and std::chrono::year_month_day, with Howard Hinnant's algorithms; libstdc++ uses
+  Neri and Schneider's since GCC 13. A plain count of days is the right storage for dates; year, month and
+  day are for input and output.
+- localtime_r is POSIX (localtime_s on Windows): std::localtime returns a pointer to shared state.
+- mktime depends on the TZ environment variable: the same program can compute different dates on
+  different machines. Date has no time zone: it is a calendar date, not an instant.
+- glibc's sscanf calls strlen on its input: parsing a big buffer with sscanf, one field at a time,
+  is quadratic. Hence the copy of each line in the benchmark.
+- Parsing stops at the first invalid date; a real loader would report it (lessons/145-fast-input-reader).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/classes-and-header-files/
+- https://arxiv.org/abs/2102.06959 (Neri and Schneider: Euclidean affine functions and their application to calendar algorithms)
+- https://howardhinnant.github.io/date_algorithms.html
+- https://en.cppreference.com/w/cpp/chrono/year_month_day
+*/
@@ -0,0 +1,552 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional> // for std::invoke
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SignedArrayView.h"
+
+// Lazy pipelines over arrays: "from(values) | filter(isEven) | transform(square) | sum()".
+// * Push-based: the source runs one loop and pushes each element into the first stage, which pushes
+//   its result into the next one, and so on. Every stage is a small struct whose operator() the
+//   compiler inlines: the whole pipeline compiles into a single loop over the array, with no
+//   intermediate container and no iterator with stacked state.
+// * Nothing runs until a terminal operation (sum, count, fold, toVector, forEach) is applied.
+// * Positional adaptors (reverse, stride, chunk) and zip need random access, so they apply to
+//   the source, before any stage: a reversed source is simply a loop with a negative step.
+// * A stage can stop the loop early (takeWhile, take): its operator() returns false.
+namespace Pipe
+{
+    // A contiguous array traversed from first, count elements, moving step elements at a time.
+    // value: T& (the elements are not copied)
+    template <typename T>
+    class SpanSource
+    {
+    private:
+        T* m_first{};
+        std::ptrdiff_t m_count{};
+        std::ptrdiff_t m_step{ 1 };
+
+    public:
+        using Value = T&;
+
+        SpanSource(T* first, std::ptrdiff_t count, std::ptrdiff_t step = 1)
+            : m_first{ first }, m_count{ count }, m_step{ step }
+        {
+        }
+
+        T* first() const { return m_first; }
+        std::ptrdiff_t count() const { return m_count; }
+        std::ptrdiff_t step() const { return m_step; }
+
+        template <typename Sink>
+        void run(Sink& sink) const
+        {
+            // One induction variable: an offset, not a pointer, so that a reversed loop never forms
+            // a pointer before the start of the array
+            const std::ptrdiff_t end{ m_count * m_step };
+            for (std::ptrdiff_t offset{ 0 }; offset != end; offset += m_step)
+            {
+                if (!sink(m_first[offset]))
+                    return;
+            }
+        }
+    };
+
+    // Pairs of elements at the same position in two arrays; stops at the end of the shorter one.
+    // value: std::pair<A&, B&>
+    template <typename A, typename B>
+    class ZipSource
+    {
+    private:
+        SpanSource<A> m_a;
+        SpanSource<B> m_b;
+
+    public:
+        using Value = std::pair<A&, B&>;
+
+        ZipSource(SpanSource<A> a, SpanSource<B> b)
+            : m_a{ a }, m_b{ b }
+        {
+        }
+
+        template <typename Sink>
+        void run(Sink& sink) const
+        {
+            const std::ptrdiff_t count{ std::min(m_a.count(), m_b.count()) };
+            for (std::ptrdiff_t i{ 0 }; i < count; ++i)
+            {
+                if (!sink(Value{ m_a.first()[i * m_a.step()], m_b.first()[i * m_b.step()] }))
+                    return;
+            }
+        }
+    };
+
+    // Consecutive groups of size elements (the last one may be shorter), as views into the array.
+    // value: std::span<T>
+    template <typename T>
+    class ChunkSource
+    {
+    private:
+        T* m_first{};
+        std::ptrdiff_t m_count{};
+        std::ptrdiff_t m_size{};
+
+    public:
+        using Value = std::span<T>;
+
+        ChunkSource(T* first, std::ptrdiff_t count, std::ptrdiff_t size)
+            : m_first{ first }, m_count{ count }, m_size{ size }
+        {
+        }
+
+        template <typename Sink>
+        void run(Sink& sink) const
+        {
+            for (std::ptrdiff_t i{ 0 }; i < m_count; i += m_size)
+            {
+                if (!sink(Value{ m_first + i, static_cast<std::size_t>(std::min(m_size, m_count - i)) }))
+                    return;
+            }
+        }
+    };
+
+    // Sources
+
+    template <std::ranges::contiguous_range R>
+    auto from(R& range)
+    {
+        using T = std::remove_reference_t<std::ranges::range_reference_t<R&>>;
+        return SpanSource<T>{ std::ranges::data(range), static_cast<std::ptrdiff_t>(std::ranges::size(range)) };
+    }
+
+    // lessons/088-arrays-and-loops: a SignedArrayView over a contiguous container
+    template <std::ranges::contiguous_range C>
+    auto from(SignedArrayView<C>& view)
+    {
+        using T = std::remove_reference_t<decltype(view[0])>;
+        return SpanSource<T>{ (view.ssize() > 0) ? &view[0] : nullptr, view.ssize() };
+    }
+
+    template <std::ranges::contiguous_range A, std::ranges::contiguous_range B>
+    auto zip(A& a, B& b)
+    {
+        return ZipSource{ from(a), from(b) };
+    }
+
+    // Positional adaptors, applied to a source
+
+    struct Reverse
+    {
+    };
+
+    inline constexpr Reverse reverse{};
+
+    struct Stride
+    {
+        std::ptrdiff_t step{};
+    };
+
+    // Every step-th element, starting with the first
+    inline Stride stride(std::ptrdiff_t step)
+    {
+        assert(step > 0);
+        return { step };
+    }
+
+    struct Chunk
+    {
+        std::ptrdiff_t size{};
+    };
+
+    inline Chunk chunk(std::ptrdiff_t size)
+    {
+        assert(size > 0);
+        return { size };
+    }
+
+    template <typename T>
+    SpanSource<T> operator|(SpanSource<T> source, Reverse)
+    {
+        if (source.count() == 0)
+            return source;
+        return { source.first() + (source.count() - 1) * source.step(), source.count(), -source.step() };
+    }
+
+    template <typename T>
+    SpanSource<T> operator|(SpanSource<T> source, Stride stride)
+    {
+        return { source.first(), (source.count() + stride.step - 1) / stride.step, source.step() * stride.step };
+    }
+
+    // Only on a plain source: the chunks are contiguous views
+    template <typename T>
+    ChunkSource<T> operator|(SpanSource<T> source, Chunk chunk)
+    {
+        assert(source.step() == 1);
+        return { source.first(), source.count(), chunk.size };
+    }
+
+    // Stages. Each one has
+    // * Output<In>: the type it pushes when it receives In,
+    // * wrap(next): the sink that processes one value and pushes to next. A sink returns false to stop.
+
+    template <typename Predicate>
+    struct Filter
+    {
+        Predicate predicate;
+
+        template <typename In>
+        using Output = In;
+
+        template <typename Next>
+        struct Sink
+        {
+            Predicate predicate;
+            Next next;
+
+            template <typename V>
+            bool operator()(V&& value)
+            {
+                return !std::invoke(predicate, std::as_const(value)) || next(std::forward<V>(value));
+            }
+        };
+
+        template <typename Next>
+        Sink<Next> wrap(Next next) const
+        {
+            return { predicate, std::move(next) };
+        }
+    };
+
+    template <typename Function>
+    struct Transform
+    {
+        Function function;
+
+        template <typename In>
+        using Output = std::invoke_result_t<const Function&, In>;
+
+        template <typename Next>
+        struct Sink
+        {
+            Function function;
+            Next next;
+
+            template <typename V>
+            bool operator()(V&& value)
+            {
+                return next(std::invoke(function, std::forward<V>(value)));
+            }
+        };
+
+        template <typename Next>
+        Sink<Next> wrap(Next next) const
+        {
+            return { function, std::move(next) };
+        }
+    };
+
+    // Pushes std::pair{ index, value }, the index counting from 0 the values that reach this stage
+    struct Enumerate
+    {
+        template <typename In>
+        using Output = std::pair<std::size_t, In>;
+
+        template <typename Next>
+        struct Sink
+        {
+            Next next;
+            std::size_t index{ 0 };
+
+            template <typename V>
+            bool operator()(V&& value)
+            {
+                return next(std::pair<std::size_t, V>{ index++, std::forward<V>(value) });
+            }
+        };
+
+        template <typename Next>
+        Sink<Next> wrap(Next next) const
+        {
+            return { std::move(next) };
+        }
+    };
+
+    inline constexpr Enumerate enumerate{};
+
+    // Stops the whole pipeline at the first value for which predicate is false
+    template <typename Predicate>
+    struct TakeWhile
+    {
+        Predicate predicate;
+
+        template <typename In>
+        using Output = In;
+
+        template <typename Next>
+        struct Sink
+        {
+            Predicate predicate;
+            Next next;
+
+            template <typename V>
+            bool operator()(V&& value)
+            {
+                return std::invoke(predicate, std::as_const(value)) && next(std::forward<V>(value));
+            }
+        };
+
+        template <typename Next>
+        Sink<Next> wrap(Next next) const
+        {
+            return { predicate, std::move(next) };
+        }
+    };
+
+    // Stops the whole pipeline after count values
+    struct Take
+    {
+        std::size_t count{};
+
+        template <typename In>
+        using Output = In;
+
+        template <typename Next>
+        struct Sink
+        {
+            std::size_t remaining{};
+            Next next;
+
+            template <typename V>
+            bool operator()(V&& value)
+            {
+                return remaining-- > 0 && next(std::forward<V>(value)) && remaining > 0;
+            }
+        };
+
+        template <typename Next>
+        Sink<Next> wrap(Next next) const
+        {
+            return { count, std::move(next) };
+        }
+    };
+
+    template <typename Predicate>
+    Filter<Predicate> filter(Predicate predicate)
+    {
+        return { std::move(predicate) };
+    }
+
+    template <typename Function>
+    Transform<Function> transform(Function function)
+    {
+        return { std::move(function) };
+    }
+
+    template <typename Predicate>
+    TakeWhile<Predicate> takeWhile(Predicate predicate)
+    {
+        return { std::move(predicate) };
+    }
+
+    inline Take take(std::size_t count)
+    {
+        return { count };
+    }
+
+    template <typename T>
+    concept Stage = requires { typename T::template Sink<bool (*)(int)>; };
+
+    template <typename T>
+    concept Source = requires { typename T::Value; };
+
+    // The type pushed out of the last stage
+    template <typename In, typename... Stages>
+    struct OutputOf
+    {
+        using type = In;
+    };
+
+    template <typename In, typename First, typename... Rest>
+    struct OutputOf<In, First, Rest...>
+    {
+        using type = typename OutputOf<typename First::template Output<In>, Rest...>::type;
+    };
+
+    template <Source S, typename... Stages>
+    class Pipeline
+    {
+    private:
+        S m_source;
+        std::tuple<Stages...> m_stages;
+
+        template <std::size_t I, typename Sink>
+        auto wrapFrom(Sink sink) const
+        {
+            if constexpr (I == 0)
+                return sink;
+            else
+                return wrapFrom<I - 1>(std::get<I - 1>(m_stages).wrap(std::move(sink)));
+        }
+
+    public:
+        using Value = typename OutputOf<typename S::Value, Stages...>::type;
+
+        Pipeline(S source, std::tuple<Stages...> stages)
+            : m_source{ std::move(source) }, m_stages{ std::move(stages) }
+        {
+        }
+
+        template <Stage Next>
+        Pipeline<S, Stages..., Next> then(Next stage) const
+        {
+            return { m_source, std::tuple_cat(m_stages, std::tuple<Next>{ std::move(stage) }) };
+        }
+
+        // Runs the pipeline: sink is called with every value that comes out of the last stage
+        template <typename Sink>
+        void run(Sink sink) const
+        {
+            auto chain{ wrapFrom<sizeof...(Stages)>(std::move(sink)) };
+            m_source.run(chain);
+        }
+    };
+
+    template <Source S, Stage Next>
+    Pipeline<S, Next> operator|(S source, Next stage)
+    {
+        return { std::move(source), std::tuple<Next>{ std::move(stage) } };
+    }
+
+    template <typename S, typename... Stages, Stage Next>
+    Pipeline<S, Stages..., Next> operator|(const Pipeline<S, Stages...>& pipeline, Next stage)
+    {
+        return pipeline.then(std::move(stage));
+    }
+
+    // Terminal operations
+
+    template <typename T, typename Operation>
+    struct Fold
+    {
+        T initial;
+        Operation operation;
+    };
+
+    // operation(operation(initial, v0), v1)...
+    template <typename T, typename Operation>
+    Fold<T, Operation> fold(T initial, Operation operation)
+    {
+        return { std::move(initial), std::move(operation) };
+    }
+
+    struct Sum
+    {
+    };
+
+    // The sum of the values, of their type (value-initialized for an empty pipeline)
+    inline Sum sum()
+    {
+        return {};
+    }
+
+    struct Count
+    {
+    };
+
+    inline Count count()
+    {
+        return {};
+    }
+
+    struct ToVector
+    {
+    };
+
+    inline ToVector toVector()
+    {
+        return {};
+    }
+
+    template <typename Function>
+    struct ForEach
+    {
+        Function function;
+    };
+
+    template <typename Function>
+    ForEach<Function> forEach(Function function)
+    {
+        return { std::move(function) };
+    }
+
+    // A source alone is a pipeline with no stage
+    template <Source S>
+    Pipeline<S> asPipeline(S source)
+    {
+        return { std::move(source), {} };
+    }
+
+    template <typename S, typename... Stages>
+    const Pipeline<S, Stages...>& asPipeline(const Pipeline<S, Stages...>& pipeline)
+    {
+        return pipeline;
+    }
+
+    template <typename P, typename T, typename Operation>
+    T operator|(const P& pipeline, Fold<T, Operation> fold)
+    {
+        T result{ std::move(fold.initial) };
+        asPipeline(pipeline).run([&](auto&& value) {
+            result = std::invoke(fold.operation, std::move(result), std::forward<decltype(value)>(value));
+            return true;
+        });
+        return result;
+    }
+
+    template <typename P>
+    auto operator|(const P& pipeline, Sum)
+    {
+        using T = std::remove_cvref_t<typename std::remove_cvref_t<decltype(asPipeline(pipeline))>::Value>;
+        return pipeline | fold(T{}, [](T total, const auto& value) { return total + value; });
+    }
+
+    template <typename P>
+    std::size_t operator|(const P& pipeline, Count)
+    {
+        return pipeline | fold(std::size_t{ 0 }, [](std::size_t n, const auto&) { return n + 1; });
+    }
+
+    template <typename P>
+    auto operator|(const P& pipeline, ToVector)
+    {
+        std::vector<std::remove_cvref_t<typename std::remove_cvref_t<decltype(asPipeline(pipeline))>::Value>> result{};
+        asPipeline(pipeline).run([&](auto&& value) {
+            result.push_back(std::forward<decltype(value)>(value));
+            return true;
+        });
+        return result;
+    }
+
+    template <typename P, typename Function>
+    void operator|(const P& pipeline, ForEach<Function> forEach)
+    {
+        asPipeline(pipeline).run([&](auto&& value) {
+            std::invoke(forEach.function, std::forward<decltype(value)>(value));
+            return true;
+        });
+    }
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SIGNED_ARRAY_VIEW_H
+#define SIGNED_ARRAY_VIEW_H
+
+#include <cstddef> // for std::size_t and std::ptrdiff_t
+
+// SignedArrayView provides a view into a container that supports indexing
+// allowing us to work with these types using signed indices
+template <typename T>
+class SignedArrayView // requires C++17
+{
+private:
+    T& m_array;
+
+public:
+    using Index = std::ptrdiff_t;
+
+    SignedArrayView(T& array)
+        : m_array{ array } {}
+
+    // Overload operator[] to take a signed index
+    constexpr auto& operator[](Index index) { return m_array[static_cast<typename T::size_type>(index)]; }
+    constexpr const auto& operator[](Index index) const { return m_array[static_cast<typename T::size_type>(index)]; }
+    constexpr auto ssize() const { return static_cast<Index>(m_array.size()); }
+};
+
+#endif
+
+
+/* Notes about typename
+
+- Any name that depends on a type containing a template parameter is called a dependent name. 
+  Dependent names must be prefixed with the keyword typename in order to be used as a type.
+- In the above example, T is a type with a template parameter, so nested type T::size_type is a dependent name, 
+  and must be prefixed with typename to be used as a type.
+*/
\ No newline at end of file
@@ -0,0 +1,299 @@
+/* Lazy pipelines
+
+- lessons/088-arrays-and-loops: printReverse to printReverse5 and SignedArrayView, five ways to
+  write one reverse loop with a signed index. lessons/089-for-each: print3, the same loop with
+  std::views::reverse.
+- Every traversal (backwards, every other element, pairs from two arrays, only some elements, until
+  some condition) is one more hand-written loop. Writing it with algorithms, one std::transform or
+  std::copy_if per step, is clearer but stores every intermediate result in a new vector.
+- Pipeline.h: "Pipe::from(values) | Pipe::reverse | Pipe::filter(isEven) | Pipe::transform(square) | Pipe::sum()".
+  The steps are described first and run together at the end, as one loop over the array: no
+  intermediate container, and close to the hand-written loop (the benchmark prints the ratio).
+*/
+
+#include "Pipeline.h"
+#include "SignedArrayView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+bool examples()
+{
+    const std::vector fibonacci{ 0, 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89 };
+
+    // printReverse from lessons/088-arrays-and-loops, on a SignedArrayView
+    std::vector<int> arr{ 4, 6, 7, 3, 8, 2, 1, 9 };
+    SignedArrayView sarr{ arr };
+    Pipe::from(sarr) | Pipe::reverse | Pipe::forEach([](int value) { std::cout << value << ' '; });
+    std::cout << '\n';
+
+    // Every other Fibonacci number, backwards, while above 1, squared
+    const std::vector squares{ Pipe::from(fibonacci) | Pipe::reverse | Pipe::stride(2) | Pipe::takeWhile([](int x) { return x > 1; })
+                               | Pipe::transform([](int x) { return x * x; }) | Pipe::toVector() };
+    for (int square : squares)
+        std::cout << square << ' ';
+    std::cout << '\n';
+
+    // Positions of the even numbers
+    Pipe::from(fibonacci) | Pipe::enumerate | Pipe::filter([](const auto& entry) { return entry.second % 2 == 0; })
+        | Pipe::forEach([](const auto& entry) { std::cout << '[' << entry.first << "]=" << entry.second << ' '; });
+    std::cout << '\n';
+
+    // Sums of groups of 5, and a dot product
+    const std::vector chunkSums{ Pipe::from(fibonacci) | Pipe::chunk(5)
+                                 | Pipe::transform([](std::span<const int> chunk) { return std::accumulate(chunk.begin(), chunk.end(), 0); })
+                                 | Pipe::toVector() };
+    const std::vector<double> prices{ 2.5, 4.0, 1.25 };
+    const std::vector<int> quantities{ 4, 1, 8 };
+    const double total{ Pipe::zip(prices, quantities) | Pipe::transform([](const auto& line) { return line.first * line.second; })
+                        | Pipe::sum() };
+    std::cout << "sums of 5: " << chunkSums[0] << ' ' << chunkSums[1] << ' ' << chunkSums[2] << ", total price " << total << '\n';
+
+    // Changing the elements through the pipeline: they are references, not copies
+    Pipe::from(arr) | Pipe::filter([](int x) { return x > 5; }) | Pipe::forEach([](int& x) { x = 0; });
+    const std::size_t zeros{ Pipe::from(arr) | Pipe::filter([](int x) { return x == 0; }) | Pipe::count() };
+
+    return squares == std::vector{ 7921, 1156, 169, 25, 4 } && chunkSums == std::vector{ 7, 81, 144 } && total == 24.0 && zeros == 4
+        && arr == std::vector{ 4, 0, 0, 3, 0, 2, 1, 0 };
+}
+
+
+/* Benchmark
+
+- Two arrays of count random ints in [0, 1000); the last element of the first one is -1.
+- Five pipelines, each written three ways: a hand-written loop, eager algorithms (std::copy_if,
+  std::transform... into temporary vectors, then std::accumulate), and Pipe.
+  + filter:  the sum of the squares of the even values,
+  + reverse: backwards, every third value, those below 500, times 3 plus 1, summed,
+  + zip:     the dot product of the two arrays,
+  + chunk:   the sum of the maxima of groups of 16 values,
+  + enumerate: the sum of index * value, up to the first negative value (take while).
+- Nanoseconds per input element, best of kRepeats runs.
+*/
+
+constexpr int kRepeats{ 5 };
+
+template <typename F>
+double nanosecondsPer(std::size_t count, F&& f)
+{
+    double best{ 0 };
+    for (int repeat{ 0 }; repeat < kRepeats; ++repeat)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        f();
+        const double time{ std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() };
+        best = (repeat == 0) ? time : std::min(best, time);
+    }
+    return best / static_cast<double>(count);
+}
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 164 };
+    std::uniform_int_distribution value{ 0, 999 };
+    std::vector<int> a(count);
+    std::vector<int> b(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        a[i] = value(rng);
+        b[i] = value(rng);
+    }
+    a.back() = -1;
+    const auto n{ static_cast<std::ptrdiff_t>(count) };
+    constexpr std::ptrdiff_t kChunk{ 16 };
+
+    const auto isEven{ [](int x) { return x % 2 == 0; } };
+    const auto square{ [](int x) { return static_cast<long long>(x) * x; } };
+    const auto isSmall{ [](int x) { return x < 500; } };
+    const auto affine{ [](int x) { return 3LL * x + 1; } };
+    const auto chunkMax{ [](std::span<const int> chunk) { return static_cast<long long>(*std::max_element(chunk.begin(), chunk.end())); } };
+
+    struct Result
+    {
+        std::string_view name{};
+        long long sums[3]{};
+        double times[3]{};
+    };
+    std::vector<Result> results{};
+
+    // filter | transform | sum
+    {
+        Result& r{ results.emplace_back(Result{ "filter" }) };
+        r.times[0] = nanosecondsPer(count, [&] {
+            long long sum{ 0 };
+            for (int x : a)
+            {
+                if (x % 2 == 0)
+                    sum += static_cast<long long>(x) * x;
+            }
+            r.sums[0] = sum;
+        });
+        r.times[1] = nanosecondsPer(count, [&] {
+            std::vector<int> evens{};
+            std::copy_if(a.begin(), a.end(), std::back_inserter(evens), isEven);
+            std::vector<long long> squares(evens.size());
+            std::transform(evens.begin(), evens.end(), squares.begin(), square);
+            r.sums[1] = std::accumulate(squares.begin(), squares.end(), 0LL);
+        });
+        r.times[2] = nanosecondsPer(count, [&] { r.sums[2] = Pipe::from(a) | Pipe::filter(isEven) | Pipe::transform(square) | Pipe::sum(); });
+    }
+
+    // reverse | stride | filter | transform | sum
+    {
+        Result& r{ results.emplace_back(Result{ "reverse" }) };
+        r.times[0] = nanosecondsPer(count, [&] {
+            long long sum{ 0 };
+            for (std::ptrdiff_t i{ n - 1 }; i >= 0; i -= 3)
+            {
+                const int x{ a[static_cast<std::size_t>(i)] };
+                if (x < 500)
+                    sum += 3LL * x + 1;
+            }
+            r.sums[0] = sum;
+        });
+        r.times[1] = nanosecondsPer(count, [&] {
+            std::vector<int> reversed(count);
+            std::reverse_copy(a.begin(), a.end(), reversed.begin());
+            std::vector<int> strided{};
+            std::copy_if(reversed.begin(), reversed.end(), std::back_inserter(strided),
+                         [i = std::size_t{ 0 }](int) mutable { return i++ % 3 == 0; });
+            std::vector<int> small{};
+            std::copy_if(strided.begin(), strided.end(), std::back_inserter(small), isSmall);
+            std::vector<long long> values(small.size());
+            std::transform(small.begin(), small.end(), values.begin(), affine);
+            r.sums[1] = std::accumulate(values.begin(), values.end(), 0LL);
+        });
+        r.times[2] = nanosecondsPer(count, [&] {
+            r.sums[2] = Pipe::from(a) | Pipe::reverse | Pipe::stride(3) | Pipe::filter(isSmall) | Pipe::transform(affine) | Pipe::sum();
+        });
+    }
+
+    // zip | transform | sum
+    {
+        Result& r{ results.emplace_back(Result{ "zip" }) };
+        r.times[0] = nanosecondsPer(count, [&] {
+            long long sum{ 0 };
+            for (std::size_t i{ 0 }; i < count; ++i)
+                sum += static_cast<long long>(a[i]) * b[i];
+            r.sums[0] = sum;
+        });
+        r.times[1] = nanosecondsPer(count, [&] {
+            std::vector<long long> products(count);
+            std::transform(a.begin(), a.end(), b.begin(), products.begin(), [](int x, int y) { return static_cast<long long>(x) * y; });
+            r.sums[1] = std::accumulate(products.begin(), products.end(), 0LL);
+        });
+        r.times[2] = nanosecondsPer(count, [&] {
+            r.sums[2] = Pipe::zip(a, b) | Pipe::transform([](const auto& p) { return static_cast<long long>(p.first) * p.second; })
+                      | Pipe::sum();
+        });
+    }
+
+    // chunk | transform | sum
+    {
+        Result& r{ results.emplace_back(Result{ "chunk" }) };
+        r.times[0] = nanosecondsPer(count, [&] {
+            long long sum{ 0 };
+            for (std::ptrdiff_t i{ 0 }; i < n; i += kChunk)
+            {
+                const std::ptrdiff_t end{ std::min(i + kChunk, n) };
+                int max{ a[static_cast<std::size_t>(i)] };
+                for (std::ptrdiff_t j{ i + 1 }; j < end; ++j)
+                    max = std::max(max, a[static_cast<std::size_t>(j)]);
+                sum += max;
+            }
+            r.sums[0] = sum;
+        });
+        r.times[1] = nanosecondsPer(count, [&] {
+            std::vector<std::span<const int>> chunks{};
+            for (std::size_t i{ 0 }; i < count; i += kChunk)
+                chunks.push_back(std::span{ a }.subspan(i, std::min(count - i, std::size_t{ kChunk })));
+            std::vector<long long> maxima(chunks.size());
+            std::transform(chunks.begin(), chunks.end(), maxima.begin(), chunkMax);
+            r.sums[1] = std::accumulate(maxima.begin(), maxima.end(), 0LL);
+        });
+        r.times[2] = nanosecondsPer(count, [&] { r.sums[2] = Pipe::from(a) | Pipe::chunk(kChunk) | Pipe::transform(chunkMax) | Pipe::sum(); });
+    }
+
+    // enumerate | takeWhile | transform | sum
+    {
+        Result& r{ results.emplace_back(Result{ "enumerate" }) };
+        r.times[0] = nanosecondsPer(count, [&] {
+            long long sum{ 0 };
+            for (std::size_t i{ 0 }; i < count && a[i] >= 0; ++i)
+                sum += static_cast<long long>(i) * a[i];
+            r.sums[0] = sum;
+        });
+        r.times[1] = nanosecondsPer(count, [&] {
+            const auto end{ std::find_if(a.begin(), a.end(), [](int x) { return x < 0; }) };
+            std::vector<long long> indices(static_cast<std::size_t>(end - a.begin()));
+            std::iota(indices.begin(), indices.end(), 0LL);
+            std::vector<long long> products(indices.size());
+            std::transform(a.begin(), end, indices.begin(), products.begin(), [](int x, long long i) { return i * x; });
+            r.sums[1] = std::accumulate(products.begin(), products.end(), 0LL);
+        });
+        r.times[2] = nanosecondsPer(count, [&] {
+            r.sums[2] = Pipe::from(a) | Pipe::enumerate | Pipe::takeWhile([](const auto& entry) { return entry.second >= 0; })
+                      | Pipe::transform([](const auto& entry) { return static_cast<long long>(entry.first) * entry.second; })
+                      | Pipe::sum();
+        });
+    }
+
+    std::cout << count << " elements, ns per element (best of " << kRepeats << ")\n"
+              << std::fixed << std::setprecision(2) << std::setw(12) << "" << std::setw(12) << "hand loop" << std::setw(12) << "eager"
+              << std::setw(12) << "Pipe" << std::setw(16) << "Pipe / loop\n";
+    bool ok{ true };
+    for (const Result& r : results)
+    {
+        std::cout << std::setw(12) << r.name << std::setw(12) << r.times[0] << std::setw(12) << r.times[1] << std::setw(12) << r.times[2]
+                  << std::setw(15) << r.times[2] / r.times[0] << '\n';
+        ok = ok && r.sums[0] == r.sums[1] && r.sums[0] == r.sums[2];
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Push versus pull: C++20 views (std::views::filter, transform, reverse) are pulled by iterators.
+  Each iterator wraps the one below it, and filter's operator++ hides a loop inside the outer loop;
+  the compiler often fails to merge them. Here the source owns the only loop and pushes values down
+  a chain of inlined calls, the way Java streams and Clojure transducers work.
+- The price of push: a pipeline is not a range. It has no begin() and end(), cannot be used in a
+  range-for or passed to std algorithms, and two pipelines cannot be advanced side by side (zip works
+  on arrays, not on pipelines).
+- reverse, stride and chunk only change where the loop starts, its step and its count, so they must be
+  applied to the source: after a filter, "the 3rd element" is no longer at a known address.
+- std::views::stride, chunk, zip and enumerate are C++23 (GCC 13).
+- The eager versions allocate and write every intermediate vector: several passes over memory
+  instead of one, which is what the benchmark measures on arrays bigger than the caches.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/range-based-for-loops-for-each/
+- https://en.cppreference.com/w/cpp/ranges
+- https://clojure.org/reference/transducers
+- https://www.fluentcpp.com/2019/02/12/the-terrible-problem-of-incrementing-a-smart-iterator/
+*/
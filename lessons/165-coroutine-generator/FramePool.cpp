@@ -0,0 +1,92 @@
+#include "FramePool.h"
+
+#include <new>
+
+namespace
+{
+    constexpr std::size_t kClassCount{ FramePool::kMaxSize / FramePool::kGranularity };
+
+    // A free frame holds the link to the next one
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    struct ThreadLists
+    {
+        FreeFrame* heads[kClassCount]{};
+        std::size_t counts[kClassCount]{};
+        FramePool::Stats stats{};
+
+        ThreadLists() = default;
+        ThreadLists(const ThreadLists&) = delete;
+        ThreadLists& operator=(const ThreadLists&) = delete;
+
+        // Returns the cached frames to the system when the thread exits
+        ~ThreadLists()
+        {
+            for (std::size_t c{ 0 }; c < kClassCount; ++c)
+            {
+                while (FreeFrame* frame{ heads[c] })
+                {
+                    heads[c] = frame->next;
+                    ::operator delete(frame, (c + 1) * FramePool::kGranularity);
+                }
+            }
+        }
+    };
+
+    thread_local ThreadLists g_lists{};
+
+    // Size class c holds frames of (c + 1) * kGranularity bytes
+    std::size_t sizeClass(std::size_t size)
+    {
+        return (size - 1) / FramePool::kGranularity;
+    }
+}
+
+namespace FramePool
+{
+    void* allocate(std::size_t size)
+    {
+        if (size == 0 || size > kMaxSize)
+        {
+            ++g_lists.stats.fromSystem;
+            return ::operator new(size);
+        }
+
+        const std::size_t c{ sizeClass(size) };
+        if (FreeFrame* frame{ g_lists.heads[c] })
+        {
+            g_lists.heads[c] = frame->next;
+            --g_lists.counts[c];
+            ++g_lists.stats.reused;
+            return frame;
+        }
+        ++g_lists.stats.fromSystem;
+        return ::operator new((c + 1) * kGranularity);
+    }
+
+    void deallocate(void* frame, std::size_t size) noexcept
+    {
+        if (size == 0 || size > kMaxSize)
+        {
+            ::operator delete(frame, size);
+            return;
+        }
+
+        const std::size_t c{ sizeClass(size) };
+        if (g_lists.counts[c] == kMaxCached)
+        {
+            ::operator delete(frame, (c + 1) * kGranularity);
+            return;
+        }
+        g_lists.heads[c] = ::new (frame) FreeFrame{ g_lists.heads[c] };
+        ++g_lists.counts[c];
+    }
+
+    Stats stats()
+    {
+        return g_lists.stats;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// Memory for coroutine frames.
+// * A coroutine keeps its local variables in a frame that the compiler allocates with operator new
+//   when the coroutine is called, unless it can prove the frame does not outlive the caller and put
+//   it in the caller's stack frame instead (allocation elision, "HALO"). Clang does that when
+//   everything is inlined; GCC never does.
+// * FramePool recycles frames: a freed frame goes to a per-thread free list of its size class
+//   (multiples of 64 bytes, up to kMaxSize) and the next frame of that class reuses it. No lock: each
+//   thread has its own lists. A frame freed by another thread joins that thread's lists.
+// * Each list keeps at most kMaxCached frames; bigger frames go straight to operator new.
+namespace FramePool
+{
+    inline constexpr std::size_t kGranularity{ 64 };
+    inline constexpr std::size_t kMaxSize{ 1024 };
+    inline constexpr std::size_t kMaxCached{ 256 };
+
+    void* allocate(std::size_t size);
+    void deallocate(void* frame, std::size_t size) noexcept;
+
+    // For the calling thread
+    struct Stats
+    {
+        std::uint64_t fromSystem{}; // operator new calls
+        std::uint64_t reused{};     // allocations served from a free list
+    };
+
+    Stats stats();
+}
+
+// Frame allocation policies for Generator
+struct PooledFrames
+{
+    static void* allocate(std::size_t size) { return FramePool::allocate(size); }
+    static void deallocate(void* frame, std::size_t size) noexcept { FramePool::deallocate(frame, size); }
+};
+
+struct HeapFrames
+{
+    static void* allocate(std::size_t size) { return ::operator new(size); }
+    static void deallocate(void* frame, std::size_t size) noexcept { ::operator delete(frame, size); }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "FramePool.h"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory> // for std::addressof
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+// A lazy sequence written as a function: "co_yield value;" hands one value to the loop that reads
+// the sequence, and the function resumes where it stopped when the loop asks for the next one.
+// * Nothing is computed in advance and nothing is stored: lines of a file, random draws or an
+//   infinite sequence, one value at a time. Stopping the loop early destroys the coroutine.
+// * Yielded values are not copied: the iterator points to the value inside the coroutine, valid
+//   until the next increment.
+// * An input range: range-for, std::ranges algorithms and views work, for a single pass.
+// * Frames come from FrameAllocator: PooledFrames (FramePool.h) by default, HeapFrames for plain operator new.
+// * An exception thrown by the coroutine is rethrown to the reader, by begin() or ++.
+// C++23 has std::generator, with the same design (and an allocator parameter).
+template <typename T, typename FrameAllocator = PooledFrames>
+class Generator
+{
+public:
+    using Value = std::remove_cvref_t<T>;
+
+    struct promise_type
+    {
+        const Value* value{};
+        std::exception_ptr exception{};
+
+        Generator get_return_object() { return Generator{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+
+        // Lazy: the body starts on the first begin()
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        // A temporary ("co_yield x * 2") lives until the end of the co_yield expression, which
+        // includes the suspension: pointing to it is safe
+        std::suspend_always yield_value(const Value& yielded) noexcept
+        {
+            value = std::addressof(yielded);
+            return {};
+        }
+
+        void return_void() noexcept {}
+        void unhandled_exception() { exception = std::current_exception(); }
+
+        // No co_await inside a generator: it only yields
+        void await_transform() = delete;
+
+        static void* operator new(std::size_t size) { return FrameAllocator::allocate(size); }
+        static void operator delete(void* frame, std::size_t size) noexcept { FrameAllocator::deallocate(frame, size); }
+    };
+
+    class Iterator
+    {
+    private:
+        std::coroutine_handle<promise_type> m_coroutine{};
+
+    public:
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(std::coroutine_handle<promise_type> coroutine)
+            : m_coroutine{ coroutine }
+        {
+        }
+
+        const Value& operator*() const { return *m_coroutine.promise().value; }
+        const Value* operator->() const { return m_coroutine.promise().value; }
+
+        Iterator& operator++()
+        {
+            resume(m_coroutine);
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const Iterator& it, std::default_sentinel_t) { return it.m_coroutine.done(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> m_coroutine{};
+
+    explicit Generator(std::coroutine_handle<promise_type> coroutine)
+        : m_coroutine{ coroutine }
+    {
+    }
+
+    static void resume(std::coroutine_handle<promise_type> coroutine)
+    {
+        coroutine.resume();
+        if (coroutine.promise().exception)
+            std::rethrow_exception(std::exchange(coroutine.promise().exception, nullptr));
+    }
+
+public:
+    Generator() = default;
+
+    Generator(Generator&& other) noexcept
+        : m_coroutine{ std::exchange(other.m_coroutine, nullptr) }
+    {
+    }
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_coroutine)
+                m_coroutine.destroy();
+            m_coroutine = std::exchange(other.m_coroutine, nullptr);
+        }
+        return *this;
+    }
+
+    // Destroying a suspended coroutine destroys its local variables, as if it had returned
+    ~Generator()
+    {
+        if (m_coroutine)
+            m_coroutine.destroy();
+    }
+
+    // Starts the coroutine: call once
+    Iterator begin()
+    {
+        resume(m_coroutine);
+        return Iterator{ m_coroutine };
+    }
+
+    std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+// A Generator owns its coroutine and is move-only, like std::generator: a view
+template <typename T, typename FrameAllocator>
+inline constexpr bool std::ranges::enable_view<Generator<T, FrameAllocator>>{ true };
+
+#endif
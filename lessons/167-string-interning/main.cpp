@@ -0,0 +1,281 @@
+/* String interning
+
+- lessons/122-std-shared_ptr-and-std-weak_ptr: Person stores its name in a std::string m_name.
+  lessons/095-arrays-of-class-types: Student stores a std::string_view, which dangles if the
+  string it points to goes away. lessons/117-shallow-vs-deep-copy: MyString copies every literal.
+- With millions of records and a few thousand distinct names, every record pays for its own copy
+  (32 bytes of std::string, plus a heap block for names longer than 15 characters), and comparing
+  or hashing two names reads their characters.
+- StringPool.h: each distinct string is stored once, in an arena, and records keep an 8-byte
+  handle. Equal names have equal handles, so == compares two pointers and the hash is stored.
+*/
+
+#include "StringPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Person from lessons/122-std-shared_ptr-and-std-weak_ptr, with an interned name
+class Person
+{
+private:
+    InternedString m_name{};
+    int m_age{};
+
+public:
+    Person(std::string_view name, int age)
+        : m_name{ intern(name) }, m_age{ age }
+    {
+    }
+
+    InternedString getName() const { return m_name; }
+    int getAge() const { return m_age; }
+};
+
+// Student from lessons/095-arrays-of-class-types: the name cannot dangle
+struct Student
+{
+    int id{};
+    InternedString name{};
+};
+
+bool examples()
+{
+    const Person alex{ "Alex", 23 };
+    const Person alex2{ std::string{ "Al" } + "ex", 41 };
+    std::cout << alex.getName() << " and " << alex2.getName() << ": same handle " << (alex.getName() == alex2.getName())
+              << ", same characters in memory " << (alex.getName().c_str() == alex2.getName().c_str()) << '\n';
+
+    // The std::string the name was read into is gone; the handle still works
+    std::vector<Student> students{};
+    for (int id{ 1 }; id <= 3; ++id)
+    {
+        const std::string input{ "Student number " + std::to_string(id % 2) };
+        students.push_back({ id, intern(input) });
+    }
+    std::cout << students[0].name << ", " << students[1].name << ", " << students[2].name << '\n';
+
+    // Handles as keys: hashing reads the stored hash, equality compares pointers
+    std::unordered_map<InternedString, int> counts{};
+    for (const Student& student : students)
+        ++counts[student.name];
+
+    // Threads interning the same names get the same handles
+    StringPool pool{};
+    std::vector<std::vector<InternedString>> perThread(4);
+    std::vector<std::thread> threads{};
+    for (auto& handles : perThread)
+    {
+        threads.emplace_back([&pool, &handles] {
+            for (int i{ 0 }; i < 1000; ++i)
+                handles.push_back(pool.intern("name " + std::to_string(i % 100)));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    const bool sameEverywhere{ std::all_of(perThread.begin(), perThread.end(), [&](const auto& handles) { return handles == perThread[0]; }) };
+    const StringPool::Stats stats{ pool.stats() };
+    std::cout << "4 threads x 1000 interns: " << stats.strings << " strings, same handles in every thread " << sameEverywhere << '\n';
+
+    return alex.getName() == alex2.getName() && alex.getName().view() == "Alex" && students[0].name == students[2].name
+        && students[0].name != students[1].name && counts.at(intern("Student number 1")) == 2 && InternedString{} == intern("")
+        && sameEverywhere && stats.strings == 100 && pool.contains("name 42") && !pool.contains("name 100");
+}
+
+
+/* Benchmark
+
+- 5000 distinct names ("First Last", from lists of first and last names) and count records, each
+  with one of the names at random (skewed, as real names are: the first names in the list are
+  much more frequent), stored as std::string or as InternedString.
+- Memory per record: the std::string objects and their heap blocks (bytes requested, without the
+  allocator's own overhead), against the handles plus the pool.
+- Interning, ns per name: 1 and 4 threads, with and without the per-thread cache.
+- Nanoseconds per record:
+  + equality: each record compared with another record,
+  + hashing: std::hash<std::string> against the stored hash,
+  + counting the records per name in a std::unordered_map keyed by the name.
+*/
+
+template <typename F>
+double nanosecondsPer(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+bool benchmark(std::size_t count)
+{
+    constexpr std::string_view kFirstNames[]{ "Alexander", "Benjamin", "Charlotte", "Dominique", "Elizabeth", "Frederick", "Gabrielle",
+                                              "Harrison", "Isabella", "Jonathan", "Katherine", "Leonardo", "Margaret", "Nathaniel",
+                                              "Olivia", "Penelope", "Quentin", "Rosalind", "Sebastian", "Theodore", "Ursula", "Victoria",
+                                              "Wilhelmina", "Xavier", "Yolanda", "Zachary", "Anastasia", "Bartholomew", "Cornelius",
+                                              "Desmond", "Evangeline", "Florence", "Gwendolyn", "Humphrey", "Ignatius", "Josephine",
+                                              "Kimberly", "Lancelot", "Maximilian", "Nicolette" };
+    constexpr std::string_view kLastNames[]{ "Abernathy", "Blackwood", "Castellano", "Davenport", "Eastwood", "Fairweather",
+                                             "Goldsmith", "Harrington", "Ingleby", "Jefferson", "Kensington", "Lancaster", "Montgomery",
+                                             "Northcott", "Oglethorpe", "Pemberton", "Quartermain", "Rutherford", "Sinclair",
+                                             "Thornbury", "Underwood", "Vanderbilt", "Wellington", "Yardley", "Zimmerman" };
+
+    std::vector<std::string> names{};
+    for (std::string_view first : kFirstNames)
+    {
+        for (std::string_view last : kLastNames)
+            names.push_back(std::string{ first } + ' ' + std::string{ last });
+    }
+    for (int suffix{ 2 }; suffix <= 5; ++suffix) // 5000 names
+    {
+        for (std::size_t i{ 0 }; i < 1000; ++i)
+            names.push_back(names[i] + ' ' + std::to_string(suffix));
+    }
+
+    std::mt19937 rng{ 167 };
+    std::vector<std::string> strings(count);
+    for (auto& string : strings)
+        string = names[static_cast<std::size_t>(static_cast<double>(names.size()) * std::pow(std::generate_canonical<double, 32>(rng), 3))];
+    std::vector<std::size_t> others(count); // record i is compared with record others[i]
+    for (auto& other : others)
+        other = rng() % count;
+
+    std::cout << names.size() << " distinct names, " << count << " records\n" << std::fixed << std::setprecision(2);
+
+    // Memory
+    std::size_t stringBytes{ count * sizeof(std::string) };
+    for (const std::string& string : strings)
+        stringBytes += (string.capacity() > 15) ? string.capacity() + 1 : 0; // libstdc++: up to 15 characters inside the object
+    std::vector<InternedString> handles(count);
+    StringPool pool{};
+    for (std::size_t i{ 0 }; i < count; ++i)
+        handles[i] = pool.intern(strings[i]);
+    const StringPool::Stats stats{ pool.stats() };
+    const std::size_t handleBytes{ count * sizeof(InternedString) + stats.bytes };
+    std::cout << "bytes per record: std::string " << static_cast<double>(stringBytes) / static_cast<double>(count) << ", InternedString "
+              << static_cast<double>(handleBytes) / static_cast<double>(count) << " (pool: " << stats.strings << " strings, "
+              << stats.bytes / 1024 << " KiB)\n";
+
+    // Interning
+    bool ok{ true };
+    std::cout << std::setw(24) << "intern, ns per name" << std::setw(12) << "1 thread" << std::setw(12) << "4 threads\n";
+    for (const bool useCache : { false, true })
+    {
+        std::cout << std::setw(24) << (useCache ? "per-thread cache" : "no cache");
+        for (const std::size_t threadCount : { std::size_t{ 1 }, std::size_t{ 4 } })
+        {
+            StringPool timed{ 64, useCache };
+            std::vector<InternedString> results(count);
+            const double time{ nanosecondsPer(count, [&] {
+                std::vector<std::thread> threads{};
+                for (std::size_t t{ 0 }; t < threadCount; ++t)
+                {
+                    threads.emplace_back([&, t] {
+                        for (std::size_t i{ t * count / threadCount }; i < (t + 1) * count / threadCount; ++i)
+                            results[i] = timed.intern(strings[i]);
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+            }) };
+            std::cout << std::setw(12) << time;
+            for (std::size_t i{ 0 }; i < count && ok; ++i)
+                ok = results[i].view() == strings[i] && (i == 0 || (results[i] == results[0]) == (strings[i] == strings[0]));
+        }
+        std::cout << '\n';
+    }
+
+    // Equality, hashing, counting
+    std::size_t stringEqual{ 0 };
+    const double stringEquality{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+            stringEqual += strings[i] == strings[others[i]];
+    }) };
+    std::size_t handleEqual{ 0 };
+    const double handleEquality{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+            handleEqual += handles[i] == handles[others[i]];
+    }) };
+
+    std::size_t stringHashSum{ 0 };
+    const double stringHashing{ nanosecondsPer(count, [&] {
+        for (const std::string& string : strings)
+            stringHashSum += std::hash<std::string>{}(string);
+    }) };
+    std::uint64_t handleHashSum{ 0 };
+    const double handleHashing{ nanosecondsPer(count, [&] {
+        for (InternedString handle : handles)
+            handleHashSum += handle.hash();
+    }) };
+
+    std::unordered_map<std::string, int> stringCounts{};
+    const double stringCounting{ nanosecondsPer(count, [&] {
+        for (const std::string& string : strings)
+            ++stringCounts[string];
+    }) };
+    std::unordered_map<InternedString, int> handleCounts{};
+    const double handleCounting{ nanosecondsPer(count, [&] {
+        for (InternedString handle : handles)
+            ++handleCounts[handle];
+    }) };
+
+    std::cout << std::setw(24) << "ns per record" << std::setw(12) << "std::string" << std::setw(16) << "InternedString\n";
+    std::cout << std::setw(24) << "equality" << std::setw(12) << stringEquality << std::setw(15) << handleEquality << '\n'
+              << std::setw(24) << "hash" << std::setw(12) << stringHashing << std::setw(15) << handleHashing << '\n'
+              << std::setw(24) << "count by name" << std::setw(12) << stringCounting << std::setw(15) << handleCounting << '\n';
+
+    ok = ok && stringEqual == handleEqual && stringCounts.size() == handleCounts.size() && stats.strings == stringCounts.size() && stringHashSum != 0 && handleHashSum != 0;
+    for (const auto& [handle, n] : handleCounts)
+        ok = ok && stringCounts.at(std::string{ handle.view() }) == n;
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 5000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Interning costs one hash and one lookup per string, once, when the data comes in; every later
+  comparison, hash and copy is a pointer operation. It pays off when strings repeat and are
+  compared or used as keys much more often than they are created.
+- The pool never frees a string: fine for names, tags, identifiers and field names, not for
+  arbitrary user input that never repeats (that memory only grows). Per-pool lifetime (one pool
+  per parsed document, freed with it) bounds it.
+- The per-thread cache is for many cores, when threads intern the same hot names while others
+  insert: the cache lines of a shard's table are then written to (growth, new entries) and move
+  between the cores' caches at every write, while a thread's cache stays in its own core.
+  Without that contention, a hit costs what a table lookup costs: one hash, one slot read, one
+  comparison of the characters (which cannot be skipped: two strings can have the same hash). The
+  benchmark here shows equal times, with or without the cache: on a single CPU, the 4 threads take
+  turns and never contend for a cache line. It is on by default because it costs little when it
+  does not help (64 KiB per thread); StringPool{ shardCount, false } turns it off.
+- Handles compare by identity, not by content order: sort them by view() for alphabetical output.
+- The same idea elsewhere: Java's String.intern(), Python's sys.intern() and identifiers, Lisp
+  symbols, compilers' identifier tables, and the string dictionaries of column stores.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/introduction-to-stdstring_view/
+- https://en.wikipedia.org/wiki/String_interning
+- https://en.cppreference.com/w/cpp/atomic/memory_order (release and acquire)
+*/
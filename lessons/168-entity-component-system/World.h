@@ -0,0 +1,465 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // for std::invoke
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// An entity: a handle, not an object. The generation tells a live entity from a destroyed one whose
+// index has been reused: a stale handle is detected instead of reaching the new entity.
+struct Entity
+{
+    std::uint32_t index{};
+    std::uint32_t generation{};
+
+    friend bool operator==(Entity, Entity) = default;
+};
+
+namespace Ecs
+{
+    inline constexpr std::size_t kMaxComponentTypes{ 64 }; // one bit each in an archetype's mask
+    inline constexpr std::size_t kChunkBytes{ 16 * 1024 };
+    inline constexpr std::size_t kChunkAlignment{ 64 };
+
+    using ComponentId = std::size_t;
+    using Mask = std::uint64_t;
+
+    inline ComponentId nextComponentId()
+    {
+        static std::atomic<ComponentId> s_count{ 0 };
+        const ComponentId id{ s_count.fetch_add(1, std::memory_order_relaxed) };
+        // Checked in release builds too: a bigger id would shift past the 64 bits of a Mask
+        if (id >= kMaxComponentTypes)
+            throw std::length_error{ "Ecs: too many component types, increase kMaxComponentTypes" };
+        return id;
+    }
+
+    // 0, 1, 2... in order of first use, for any type
+    template <typename T>
+    ComponentId componentId()
+    {
+        static const ComponentId s_id{ nextComponentId() };
+        return s_id;
+    }
+
+    template <typename T>
+    Mask maskOf()
+    {
+        return Mask{ 1 } << componentId<T>();
+    }
+
+    // What an archetype needs to know about a component type it stores without knowing the type
+    struct ComponentInfo
+    {
+        ComponentId id{};
+        std::size_t size{};
+        std::size_t alignment{};
+        void (*moveConstruct)(void* destination, void* source){};
+        void (*destroy)(void* component){};
+    };
+
+    template <typename T>
+    const ComponentInfo& componentInfo()
+    {
+        static_assert(alignof(T) <= kChunkAlignment, "Ecs: component more aligned than a chunk");
+        static_assert(sizeof(T) + alignof(T) + sizeof(Entity) + alignof(Entity) <= kChunkBytes, "Ecs: component too big for a chunk");
+        static const ComponentInfo s_info{ componentId<T>(), sizeof(T), alignof(T),
+                                           [](void* destination, void* source) { ::new (destination) T(std::move(*static_cast<T*>(source))); },
+                                           [](void* component) { static_cast<T*>(component)->~T(); } };
+        return s_info;
+    }
+
+    struct alignas(kChunkAlignment) ChunkStorage
+    {
+        std::byte bytes[kChunkBytes];
+    };
+
+    // All the entities with exactly the same set of component types.
+    // * Rows are stored in chunks of kChunkBytes. A chunk holds one array per component type, one
+    //   after the other ("structure of arrays"), then the array of entities: a query reads only the
+    //   arrays of the components it asks for.
+    // * Every chunk is full except the last: removing a row moves the last row into the hole.
+    class Archetype
+    {
+    public:
+        struct Column
+        {
+            const ComponentInfo* info{};
+            std::size_t offset{}; // of the array in the chunk
+        };
+
+    private:
+        Mask m_mask{};
+        std::vector<Column> m_columns{};              // by increasing component id
+        std::int8_t m_columnOf[kMaxComponentTypes]{}; // component id -> column, or -1
+        std::size_t m_capacity{};                     // rows per chunk
+        std::size_t m_entityOffset{};
+        std::vector<std::unique_ptr<ChunkStorage>> m_chunks{};
+        std::size_t m_size{ 0 };
+
+    public:
+        explicit Archetype(std::vector<const ComponentInfo*> infos)
+        {
+            std::sort(infos.begin(), infos.end(), [](const ComponentInfo* a, const ComponentInfo* b) { return a->id < b->id; });
+            std::fill(std::begin(m_columnOf), std::end(m_columnOf), std::int8_t{ -1 });
+
+            std::size_t rowBytes{ sizeof(Entity) };
+            for (const ComponentInfo* info : infos)
+                rowBytes += info->size;
+            // Alignment padding between the arrays takes at most alignment - 1 bytes each
+            std::size_t padding{ alignof(Entity) };
+            for (const ComponentInfo* info : infos)
+                padding += info->alignment;
+            // Each component fits on its own (componentInfo), but a row of several may not
+            if (padding + rowBytes > kChunkBytes)
+                throw std::length_error{ "Ecs: components too big for a chunk, increase kChunkBytes" };
+            m_capacity = (kChunkBytes - padding) / rowBytes;
+
+            std::size_t offset{ 0 };
+            for (const ComponentInfo* info : infos)
+            {
+                offset = (offset + info->alignment - 1) / info->alignment * info->alignment;
+                m_columnOf[info->id] = static_cast<std::int8_t>(m_columns.size());
+                m_columns.push_back({ info, offset });
+                m_mask |= Mask{ 1 } << info->id;
+                offset += m_capacity * info->size;
+            }
+            m_entityOffset = (offset + alignof(Entity) - 1) / alignof(Entity) * alignof(Entity);
+        }
+
+        Archetype(const Archetype&) = delete;
+        Archetype& operator=(const Archetype&) = delete;
+
+        ~Archetype()
+        {
+            for (std::size_t row{ 0 }; row < m_size; ++row)
+            {
+                for (const Column& column : m_columns)
+                    column.info->destroy(component(row, column));
+            }
+        }
+
+        Mask mask() const { return m_mask; }
+        std::size_t size() const { return m_size; }
+        std::size_t capacity() const { return m_capacity; }
+        std::size_t chunkCount() const { return m_chunks.size(); }
+        const std::vector<Column>& columns() const { return m_columns; }
+
+        // The number of rows in chunk c
+        std::size_t chunkSize(std::size_t c) const { return std::min(m_capacity, m_size - c * m_capacity); }
+
+        bool has(ComponentId id) const { return m_columnOf[id] >= 0; }
+        const Column& column(ComponentId id) const { return m_columns[static_cast<std::size_t>(m_columnOf[id])]; }
+
+        std::byte* chunk(std::size_t c) const { return m_chunks[c]->bytes; }
+
+        template <typename T>
+        T* array(std::size_t c) const
+        {
+            return std::launder(reinterpret_cast<T*>(chunk(c) + column(componentId<T>()).offset));
+        }
+
+        Entity* entities(std::size_t c) const { return std::launder(reinterpret_cast<Entity*>(chunk(c) + m_entityOffset)); }
+
+        void* component(std::size_t row, const Column& column) const
+        {
+            return chunk(row / m_capacity) + column.offset + (row % m_capacity) * column.info->size;
+        }
+
+        Entity& entity(std::size_t row) const { return entities(row / m_capacity)[row % m_capacity]; }
+
+        // A new last row: its components must then be constructed (in every column)
+        std::size_t pushRow(Entity entity)
+        {
+            if (m_size == m_chunks.size() * m_capacity)
+                m_chunks.push_back(std::make_unique_for_overwrite<ChunkStorage>()); // not zeroed
+            const std::size_t row{ m_size++ };
+            ::new (&this->entity(row)) Entity{ entity };
+            return row;
+        }
+
+        // Destroys the components of row, and moves the last row into it. Returns the entity that
+        // moved, or nothing if row was the last one.
+        std::optional<Entity> removeRow(std::size_t row)
+        {
+            const std::size_t last{ m_size - 1 };
+            for (const Column& column : m_columns)
+            {
+                column.info->destroy(component(row, column));
+                if (row != last)
+                {
+                    column.info->moveConstruct(component(row, column), component(last, column));
+                    column.info->destroy(component(last, column));
+                }
+            }
+            std::optional<Entity> moved{};
+            if (row != last)
+            {
+                entity(row) = entity(last);
+                moved = entity(row);
+            }
+            --m_size;
+            // Keep one empty chunk: an entity added and removed again does not allocate every time
+            if (m_chunks.size() * m_capacity >= m_size + 2 * m_capacity)
+                m_chunks.pop_back();
+            return moved;
+        }
+    };
+}
+
+// The entities and their components.
+// * Components are plain structs (or classes) of any type: Position, Velocity, Box, Label...
+//   An entity has any set of them, at most one of each type, and gains or loses them at run time.
+// * Storage by archetype (Ecs::Archetype): entities with the same component types are stored
+//   together, each component type in its own contiguous array. A query for <Box> reads the Box
+//   arrays of every archetype that has a Box, and nothing else.
+// * Adding or removing a component moves the entity to another archetype: pointers to components
+//   (get<T>) are invalidated by any create, destroy, add or remove.
+class World
+{
+private:
+    struct Record
+    {
+        Ecs::Archetype* archetype{};
+        std::size_t row{};
+        std::uint32_t generation{};
+    };
+
+    std::unordered_map<Ecs::Mask, std::unique_ptr<Ecs::Archetype>> m_archetypes{};
+    std::vector<Ecs::Archetype*> m_archetypeList{}; // for queries: a vector is faster to walk
+    std::vector<Record> m_records{};
+    std::vector<std::uint32_t> m_freeIndices{};
+
+    Ecs::Archetype& archetypeFor(Ecs::Mask mask, const std::vector<const Ecs::ComponentInfo*>& infos)
+    {
+        auto& archetype{ m_archetypes[mask] };
+        if (!archetype)
+        {
+            archetype = std::make_unique<Ecs::Archetype>(infos);
+            m_archetypeList.push_back(archetype.get());
+        }
+        return *archetype;
+    }
+
+    Record& record(Entity entity)
+    {
+        assert(alive(entity));
+        return m_records[entity.index];
+    }
+
+    void removeFromArchetype(const Record& record)
+    {
+        if (const auto moved{ record.archetype->removeRow(record.row) })
+            m_records[moved->index].row = record.row;
+    }
+
+    // Moves entity to the archetype with mask, keeping the components both archetypes have.
+    // Returns its new row, where the components of the new archetype that the old one lacks must be constructed.
+    std::size_t moveEntity(Entity entity, Ecs::Mask mask, const std::vector<const Ecs::ComponentInfo*>& infos)
+    {
+        Record& from{ record(entity) };
+        Ecs::Archetype& target{ archetypeFor(mask, infos) };
+        const std::size_t row{ target.pushRow(entity) };
+        for (const auto& column : target.columns())
+        {
+            if (from.archetype->has(column.info->id))
+                column.info->moveConstruct(target.component(row, column), from.archetype->component(from.row, from.archetype->column(column.info->id)));
+        }
+        const Record old{ from };
+        from.archetype = &target;
+        from.row = row;
+        removeFromArchetype(old); // destroys the moved-from components
+        return row;
+    }
+
+    template <typename... Components, typename F>
+    void forEachMatchingChunk(F&& f) const
+    {
+        const Ecs::Mask required{ (Ecs::maskOf<Components>() | ... | Ecs::Mask{ 0 }) };
+        for (Ecs::Archetype* archetype : m_archetypeList)
+        {
+            if ((archetype->mask() & required) != required)
+                continue;
+            for (std::size_t c{ 0 }; c < archetype->chunkCount() && c * archetype->capacity() < archetype->size(); ++c)
+                f(*archetype, c);
+        }
+    }
+
+public:
+    World() = default;
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    template <typename... Components>
+    Entity create(Components&&... components)
+    {
+        static_assert(sizeof...(Components) > 0 && "World::create: at least one component");
+        // The archetype first: if it throws (too many component types, too big), no index is used up
+        const Ecs::Mask mask{ (Ecs::maskOf<std::remove_cvref_t<Components>>() | ...) };
+        assert(std::popcount(mask) == sizeof...(Components) && "World::create: one component of each type");
+        Ecs::Archetype& archetype{ archetypeFor(mask, { &Ecs::componentInfo<std::remove_cvref_t<Components>>()... }) };
+
+        std::uint32_t index{};
+        if (m_freeIndices.empty())
+        {
+            index = static_cast<std::uint32_t>(m_records.size());
+            m_records.emplace_back();
+        }
+        else
+        {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        }
+        const Entity entity{ index, m_records[index].generation };
+        const std::size_t row{ archetype.pushRow(entity) };
+        (::new (archetype.component(row, archetype.column(Ecs::componentId<std::remove_cvref_t<Components>>())))
+             std::remove_cvref_t<Components>(std::forward<Components>(components)),
+         ...);
+        m_records[index].archetype = &archetype;
+        m_records[index].row = row;
+        return entity;
+    }
+
+    void destroy(Entity entity)
+    {
+        Record& destroyed{ record(entity) };
+        removeFromArchetype(destroyed);
+        destroyed.archetype = nullptr;
+        ++destroyed.generation;
+        m_freeIndices.push_back(entity.index);
+    }
+
+    bool alive(Entity entity) const
+    {
+        return entity.index < m_records.size() && m_records[entity.index].generation == entity.generation
+            && m_records[entity.index].archetype != nullptr;
+    }
+
+    template <typename T>
+    bool has(Entity entity) const
+    {
+        return alive(entity) && m_records[entity.index].archetype->has(Ecs::componentId<T>());
+    }
+
+    // nullptr if the entity has no T
+    template <typename T>
+    T* get(Entity entity)
+    {
+        if (!has<T>(entity))
+            return nullptr;
+        const Record& found{ m_records[entity.index] };
+        return static_cast<T*>(found.archetype->component(found.row, found.archetype->column(Ecs::componentId<T>())));
+    }
+
+    // Adds a T, or replaces the entity's T
+    template <typename T>
+    void add(Entity entity, T component)
+    {
+        if (T* existing{ get<T>(entity) })
+        {
+            *existing = std::move(component);
+            return;
+        }
+        const Ecs::Archetype& from{ *record(entity).archetype };
+        std::vector<const Ecs::ComponentInfo*> infos{ &Ecs::componentInfo<T>() };
+        for (const auto& column : from.columns())
+            infos.push_back(column.info);
+        const std::size_t row{ moveEntity(entity, from.mask() | Ecs::maskOf<T>(), infos) };
+        const Ecs::Archetype& target{ *m_records[entity.index].archetype };
+        ::new (target.component(row, target.column(Ecs::componentId<T>()))) T(std::move(component));
+    }
+
+    // Removes the entity's T, if it has one; an entity keeps at least one component
+    template <typename T>
+    void remove(Entity entity)
+    {
+        if (!has<T>(entity))
+            return;
+        const Ecs::Archetype& from{ *record(entity).archetype };
+        assert(from.columns().size() > 1 && "World::remove: the last component (destroy the entity instead)");
+        std::vector<const Ecs::ComponentInfo*> infos{};
+        for (const auto& column : from.columns())
+        {
+            if (column.info->id != Ecs::componentId<T>())
+                infos.push_back(column.info);
+        }
+        moveEntity(entity, from.mask() & ~Ecs::maskOf<T>(), infos);
+    }
+
+    // The number of live entities
+    std::size_t size() const { return m_records.size() - m_freeIndices.size(); }
+    std::size_t archetypeCount() const { return m_archetypeList.size(); }
+
+    // Query: f(components&...) for every entity that has all of Components (and maybe others),
+    // or f(entity, components&...). Must not create, destroy, add or remove.
+    template <typename... Components, typename F>
+    void each(F&& f)
+    {
+        forEachMatchingChunk<Components...>([&](const Ecs::Archetype& archetype, std::size_t c) {
+            const std::size_t rows{ archetype.chunkSize(c) };
+            const std::tuple<Components*...> arrays{ archetype.array<Components>(c)... };
+            const Entity* entities{ archetype.entities(c) };
+            for (std::size_t i{ 0 }; i < rows; ++i)
+            {
+                if constexpr (std::invocable<F&, Entity, Components&...>)
+                    f(entities[i], std::get<Components*>(arrays)[i]...);
+                else
+                    f(std::get<Components*>(arrays)[i]...);
+            }
+        });
+    }
+
+    // f(rows, Components*...) once per chunk: the loop over the arrays is the caller's, and the
+    // compiler can vectorize it
+    template <typename... Components, typename F>
+    void eachChunk(F&& f)
+    {
+        forEachMatchingChunk<Components...>(
+            [&](const Ecs::Archetype& archetype, std::size_t c) { f(archetype.chunkSize(c), archetype.array<Components>(c)...); });
+    }
+
+    // each<Components...>(f) on threadCount threads, each taking a range of chunks. f is called
+    // concurrently for different entities: it must only touch the components it is given.
+    template <typename... Components, typename F>
+    void parallelEach(F&& f, std::size_t threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1))
+    {
+        std::vector<std::pair<const Ecs::Archetype*, std::size_t>> chunks{};
+        forEachMatchingChunk<Components...>([&](const Ecs::Archetype& archetype, std::size_t c) { chunks.emplace_back(&archetype, c); });
+
+        const auto run{ [&](std::size_t first, std::size_t last) {
+            for (std::size_t k{ first }; k < last; ++k)
+            {
+                const auto [archetype, c] = chunks[k];
+                const std::size_t rows{ archetype->chunkSize(c) };
+                const std::tuple<Components*...> arrays{ archetype->template array<Components>(c)... };
+                for (std::size_t i{ 0 }; i < rows; ++i)
+                    f(std::get<Components*>(arrays)[i]...);
+            }
+        } };
+
+        threadCount = std::clamp<std::size_t>(threadCount, 1, std::max<std::size_t>(chunks.size(), 1));
+        std::vector<std::thread> workers{};
+        for (std::size_t t{ 1 }; t < threadCount; ++t)
+            workers.emplace_back(run, t * chunks.size() / threadCount, (t + 1) * chunks.size() / threadCount);
+        run(0, chunks.size() / threadCount); // the calling thread takes the first range
+        for (auto& worker : workers)
+            worker.join();
+    }
+};
+
+#endif
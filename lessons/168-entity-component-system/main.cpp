@@ -0,0 +1,256 @@
+/* Entity component system
+
+- lessons/128-multiple-inheritance: Button inherits from the mixins Box, Label and Tooltip. A
+  button is one object with all three parts, and the widgets are a std::vector<Button>.
+- Moving every widget only changes the Box, but the loop walks over whole Buttons: the Box is 16 of
+  the 88 bytes of each one, so most of every cache line read is Label and Tooltip, never used.
+  And a widget cannot gain or lose a part at run time: a Button without a Tooltip is another class.
+- World.h: an entity is only an id; its components (a Box, a Label, a Tooltip) are stored by
+  type, each in its own array, grouped by the set of component types the entities have
+  ("archetype"). Moving every widget reads only the Box arrays. Components are added and
+  removed at run time, and queries can run on several threads.
+*/
+
+#include "World.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// From lessons/128-multiple-inheritance, with getters and Box::translate
+struct Point2D
+{
+    int x{};
+    int y{};
+};
+
+class Box // mixin Box class
+{
+public:
+    void setTopLeft(Point2D point) { m_topLeft = point; }
+    void setBottomRight(Point2D point) { m_bottomRight = point; }
+    Point2D getTopLeft() const { return m_topLeft; }
+    Point2D getBottomRight() const { return m_bottomRight; }
+
+    void translate(Point2D offset)
+    {
+        m_topLeft = { m_topLeft.x + offset.x, m_topLeft.y + offset.y };
+        m_bottomRight = { m_bottomRight.x + offset.x, m_bottomRight.y + offset.y };
+    }
+
+private:
+    Point2D m_topLeft{};
+    Point2D m_bottomRight{};
+};
+
+class Label // mixin Label class
+{
+public:
+    void setText(const std::string_view str) { m_text = str; }
+    void setFontSize(int fontSize) { m_fontSize = fontSize; }
+    const std::string& getText() const { return m_text; }
+    int getFontSize() const { return m_fontSize; }
+
+private:
+    std::string m_text{};
+    int m_fontSize{};
+};
+
+class Tooltip // mixin Tooltip class
+{
+public:
+    void setText(const std::string_view str) { m_text = str; }
+    const std::string& getText() const { return m_text; }
+
+private:
+    std::string m_text{};
+};
+
+class Button : public Box, public Label, public Tooltip {}; // Button using three mixins
+
+Box makeBox(int x, int y)
+{
+    Box box{};
+    box.setTopLeft({ x, y });
+    box.setBottomRight({ x + 9, y + 9 });
+    return box;
+}
+
+Label makeLabel(std::string_view text, int fontSize)
+{
+    Label label{};
+    label.setText(text);
+    label.setFontSize(fontSize);
+    return label;
+}
+
+Tooltip makeTooltip(std::string_view text)
+{
+    Tooltip tooltip{};
+    tooltip.setText(text);
+    return tooltip;
+}
+
+bool examples()
+{
+    World world{};
+
+    // func2 from lessons/128-multiple-inheritance: a button is an entity with three components
+    const Entity submit{ world.create(makeBox(1, 1), makeLabel("Submit", 6), makeTooltip("Submit the form to the server")) };
+    const Entity cancel{ world.create(makeBox(20, 1), makeLabel("Cancel", 6)) }; // no tooltip: no new class needed
+    const Entity title{ world.create(makeLabel("Settings", 12)) };                // a label with no box
+
+    // Systems are loops over the components they need
+    world.each<Box>([](Box& box) { box.translate({ 5, 0 }); });
+    world.each<Label>([](Label& label) { label.setFontSize(label.getFontSize() + 1); });
+
+    int withTooltip{ 0 };
+    world.each<Label, Tooltip>([&](Entity entity, const Label& label, const Tooltip& tooltip) {
+        std::cout << "entity " << entity.index << ": \"" << label.getText() << "\" (" << tooltip.getText() << ")\n";
+        ++withTooltip;
+    });
+
+    // Components come and go at run time: the entity moves to another archetype
+    world.add(cancel, makeTooltip("Discard the changes"));
+    world.remove<Box>(submit);
+    int boxes{ 0 };
+    world.each<Box>([&](const Box&) { ++boxes; });
+    std::cout << world.size() << " entities in " << world.archetypeCount() << " archetypes, " << boxes << " with a Box\n";
+
+    // A destroyed entity's handle is detected, even after its index is reused
+    world.destroy(title);
+    const Entity reused{ world.create(makeLabel("About", 8)) };
+    std::cout << "old title alive: " << world.alive(title) << ", new entity index " << reused.index << " (title had " << title.index << ")\n";
+
+    const Box* cancelBox{ world.get<Box>(cancel) };
+    return withTooltip == 1 && boxes == 1 && world.get<Box>(submit) == nullptr && world.get<Label>(submit)->getFontSize() == 7
+        && cancelBox->getTopLeft().x == 25 && world.get<Tooltip>(cancel)->getText() == "Discard the changes" && !world.alive(title)
+        && world.alive(reused) && reused.index == title.index && world.get<Label>(title) == nullptr && world.size() == 3;
+}
+
+
+/* Benchmark
+
+- count buttons, each a Box, a Label and a Tooltip:
+  + std::vector<Button> (the mixins),
+  + a World with count entities having the three components.
+- Creating them, then moving every Box by (1, 1) (nanoseconds per button):
+  + a loop over the vector of Buttons,
+  + World::each<Box>, World::eachChunk<Box> (a plain loop over each Box array),
+  + World::parallelEach<Box> on every hardware thread.
+*/
+
+template <typename F>
+double nanosecondsPer(std::size_t count, F&& f)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(count);
+}
+
+bool benchmark(std::size_t count)
+{
+    static constexpr Point2D kOffset{ 1, 1 };
+    const auto position{ [](std::size_t i) { return static_cast<int>(i % 1000); } };
+
+    std::cout << count << " buttons, ns per button (sizeof(Button) " << sizeof(Button) << ", sizeof(Box) " << sizeof(Box) << ")\n"
+              << std::fixed << std::setprecision(2) << std::setw(28) << "" << std::setw(10) << "create" << std::setw(12) << "move boxes\n";
+
+    long long expected{ 0 };
+    {
+        std::vector<Button> buttons{};
+        const double create{ nanosecondsPer(count, [&] {
+            buttons.resize(count);
+            for (std::size_t i{ 0 }; i < count; ++i)
+            {
+                buttons[i].setTopLeft({ position(i), position(i) });
+                buttons[i].setBottomRight({ position(i) + 9, position(i) + 9 });
+                buttons[i].Label::setFontSize(6);
+            }
+        }) };
+        const double update{ nanosecondsPer(count, [&] {
+            for (Button& button : buttons)
+                button.translate(kOffset);
+        }) };
+        for (const Button& button : buttons)
+            expected += button.getTopLeft().x + button.getBottomRight().y;
+        std::cout << std::setw(28) << "std::vector<Button>" << std::setw(10) << create << std::setw(11) << update << '\n';
+    }
+
+    World world{};
+    const double create{ nanosecondsPer(count, [&] {
+        for (std::size_t i{ 0 }; i < count; ++i)
+            world.create(makeBox(position(i), position(i)), makeLabel("", 6), Tooltip{});
+    }) };
+
+    long long total{ 0 };
+    const auto checksum{ [&] {
+        long long sum{ 0 };
+        world.each<Box>([&](const Box& box) { sum += box.getTopLeft().x + box.getBottomRight().y; });
+        return sum;
+    } };
+
+    const double each{ nanosecondsPer(count, [&] { world.each<Box>([](Box& box) { box.translate(kOffset); }); }) };
+    total += checksum() - expected;
+    const double eachChunk{ nanosecondsPer(count, [&] {
+        world.eachChunk<Box>([](std::size_t rows, Box* boxes) {
+            for (std::size_t i{ 0 }; i < rows; ++i)
+                boxes[i].translate(kOffset);
+        });
+    }) };
+    total += checksum() - expected;
+    const std::size_t threads{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+    const double parallel{ nanosecondsPer(count, [&] { world.parallelEach<Box>([](Box& box) { box.translate(kOffset); }, threads); }) };
+    total += checksum() - expected;
+
+    std::cout << std::setw(28) << "World::each<Box>" << std::setw(10) << create << std::setw(11) << each << '\n'
+              << std::setw(28) << "World::eachChunk<Box>" << std::setw(10) << "" << std::setw(11) << eachChunk << '\n'
+              << std::setw(28) << "World::parallelEach<Box>" << std::setw(10) << "" << std::setw(11) << parallel << " (" << threads
+              << (threads == 1 ? " thread)\n" : " threads)\n");
+
+    // Each update adds 2 to every box's top-left x + bottom-right y: after the 1st, 2nd and 3rd
+    // update the World's boxes are 0, 1 and 2 updates ahead of the Buttons
+    const long long perUpdate{ 2 * static_cast<long long>(count) };
+    return world.size() == count && total == perUpdate * (0 + 1 + 2);
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t argument{ (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 0 };
+    const std::size_t count{ (argument > 0) ? argument : 10000000 };
+
+    const bool ok{ examples() && benchmark(count) };
+    std::cout << (ok ? "all checks passed" : "CHECK FAILED") << '\n';
+    return ok ? 0 : 1;
+}
+
+
+/* Notes
+
+- Structure of arrays (SoA) versus array of structures (AoS): the same trade-off as
+  lessons/159-columnar-employee-table. A loop that needs one field of millions of objects
+  wants the fields apart; code that uses every field of one object wants them together.
+- Archetypes make queries fast and adding or removing components slow (every component of the
+  entity is moved to the other archetype's arrays). Components that come and go every frame are
+  better as a flag inside a component, or in a separate sparse set (EnTT's design).
+- Systems that touch different components can also run at the same time: a Box system and a Label
+  system never touch the same memory. Real ECS schedulers build that graph from the components
+  each system reads and writes.
+- Pointers and references to components are only valid until the next structural change (create,
+  destroy, add, remove): keep Entity handles, and get<T>() again.
+*/
+
+
+/* References
+
+- https://www.learncpp.com/cpp-tutorial/multiple-inheritance/
+- https://github.com/SanderMertens/ecs-faq
+- https://docs.unity3d.com/Packages/com.unity.entities@1.0/manual/concepts-archetypes.html
+- https://github.com/skypjack/entt
+*/
@@ -89,6 +89,31 @@ path_src=drafts
 # path_src=lessons/128-virtual-functions
 # path_src=lessons/135-rethrow-exception
 # path_src=lessons/139-streams
+# path_src=lessons/144-shortest-float-formatting-and-parsing
+# path_src=lessons/145-fast-input-reader
+# path_src=lessons/146-statistics-reductions
+# path_src=lessons/147-bulk-ulp-comparison
+# path_src=lessons/148-constexpr-lookup-tables
+# path_src=lessons/149-simd-vector-math
+# path_src=lessons/150-function-ref-and-inplace-function
+# path_src=lessons/151-poly-collection
+# path_src=lessons/152-fast-downcasting
+# path_src=lessons/153-expected
+# path_src=lessons/154-trivially-relocatable
+# path_src=lessons/155-enum-reflection
+# path_src=lessons/156-static-map
+# path_src=lessons/157-scalable-id-generator
+# path_src=lessons/158-sharded-accumulator
+# path_src=lessons/159-columnar-employee-table
+# path_src=lessons/160-flat-hash-map
+# path_src=lessons/161-concurrent-hash-map
+# path_src=lessons/162-bplus-tree
+# path_src=lessons/163-compact-date
+# path_src=lessons/164-lazy-pipelines
+# path_src=lessons/165-coroutine-generator
+# path_src=lessons/166-compact-optional
+# path_src=lessons/167-string-interning
+# path_src=lessons/168-entity-component-system
 
 args_compile=$(cat << EOF
 -fdiagnostics-color=always \
@@ -101,7 +126,7 @@ args_compile=$(cat << EOF
 -Wextra \
 -Wconversion \
 -Wsign-conversion \
--std=c++17 \
+-std=c++20 \
 -I./lessons/11-header-files/others \
 -I./3rd-parties/plog/include
 EOF
@@ -109,6 +134,7 @@ EOF
 # -std=c++17 \
 # -Weffc++ \
 # -Werror \
+# -DNDEBUG removes every assert(): drop it to run the lessons with their debug checks
 
 args_run=$(cat << EOF
 Hello